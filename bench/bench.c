@@ -0,0 +1,162 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* minimum duration of a sample, in seconds */
+#define BENCH_SAMPLE_TIME 0.005
+/* number of samples run and discarded before measuring */
+#define BENCH_WARMUP 3
+
+static volatile unsigned int bench_sink;
+
+static int bench_json;
+static unsigned int bench_num_samples = 21;
+static unsigned int bench_count;
+
+/* whether the JSON object of the last benchmark is still open for
+   bench_values */
+static int bench_open;
+
+double bench_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void bench_begin(int json, unsigned int num_samples)
+{
+  bench_json = json;
+  if (num_samples) bench_num_samples = num_samples;
+  bench_count = 0;
+  bench_open = 0;
+
+  if (bench_json) printf("{\n  \"benchmarks\": [");
+}
+
+static void bench_close(void)
+{
+  if (bench_open) printf("}");
+  bench_open = 0;
+}
+
+void bench_end(void)
+{
+  bench_close();
+  if (bench_json) printf("\n  ]\n}\n");
+}
+
+static int compare_double(const void *x, const void *y)
+{
+  double a = *(const double *) x;
+  double b = *(const double *) y;
+  return (a > b) - (a < b);
+}
+
+/* nearest-rank percentile of sorted samples */
+static double percentile(double *samples, unsigned int num, unsigned int p)
+{
+  unsigned int rank = (p * num + 99) / 100;
+  return samples[rank ? rank - 1 : 0];
+}
+
+/* The default number of samples is too small for any percentile above
+   the median to differ from the maximum, so the maximum is reported. */
+
+static void print_json_string(const char *s)
+{
+  putchar('"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') putchar('\\');
+    putchar(*s);
+  }
+  putchar('"');
+}
+
+void bench_run(const char *name, bench_fn_t fn, void *data)
+{
+  /* find a number of operations taking at least the sample time */
+  unsigned long num = 1;
+  for (;;) {
+    double t0 = bench_time();
+    bench_sink += fn(data, num);
+    double elapsed = bench_time() - t0;
+    if (elapsed >= BENCH_SAMPLE_TIME) break;
+
+    /* aim a little past the target */
+    if (elapsed < BENCH_SAMPLE_TIME / 100) num *= 100;
+    else num = num * 1.2 * BENCH_SAMPLE_TIME / elapsed + 1;
+  }
+
+  for (unsigned int i = 0; i < BENCH_WARMUP; i++) {
+    bench_sink += fn(data, num);
+  }
+
+  /* time per operation of every sample, in nanoseconds */
+  double *samples = malloc(bench_num_samples * sizeof(double));
+  for (unsigned int i = 0; i < bench_num_samples; i++) {
+    double t0 = bench_time();
+    bench_sink += fn(data, num);
+    samples[i] = (bench_time() - t0) * 1e9 / num;
+  }
+  qsort(samples, bench_num_samples, sizeof(double), compare_double);
+
+  double median = percentile(samples, bench_num_samples, 50);
+  double max = samples[bench_num_samples - 1];
+
+  if (bench_json) {
+    bench_close();
+    printf("%s\n    {\"name\": ", bench_count ? "," : "");
+    print_json_string(name);
+    printf(", \"ops\": %lu, \"samples\": %u, \"median_ns\": %.3f, "
+           "\"max_ns\": %.3f, \"ops_per_sec\": %.0f",
+           num, bench_num_samples, median, max, 1e9 / median);
+    bench_open = 1;
+  }
+  else {
+    printf("%-32s %14.0f ops/s %12.1f ns %12.1f ns max\n",
+           name, 1e9 / median, median, max);
+  }
+  fflush(stdout);
+
+  bench_count++;
+  free(samples);
+}
+
+void bench_value(const char *key, uint64_t value)
+{
+  if (bench_json) {
+    if (!bench_open) return;
+    printf(", ");
+    print_json_string(key);
+    printf(": %llu", (unsigned long long) value);
+  }
+  else {
+    printf("  %s: %llu\n", key, (unsigned long long) value);
+  }
+  fflush(stdout);
+}
+
+void bench_values(const char *key, const uint64_t *values, unsigned int num)
+{
+  if (bench_json) {
+    if (!bench_open) return;
+    printf(", ");
+    print_json_string(key);
+    printf(": [");
+    for (unsigned int i = 0; i < num; i++) {
+      printf("%s%llu", i ? ", " : "", (unsigned long long) values[i]);
+    }
+    printf("]");
+  }
+  else {
+    printf("  %s:", key);
+    for (unsigned int i = 0; i < num; i++) {
+      printf(" %llu", (unsigned long long) values[i]);
+    }
+    printf("\n");
+  }
+  fflush(stdout);
+}
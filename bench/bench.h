@@ -0,0 +1,41 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+/* A benchmark body performs num operations and returns some value
+   depending on their results, so that they cannot be optimised away. */
+typedef unsigned int (*bench_fn_t)(void *data, unsigned long num);
+
+/* Start and finish the output of a run. Results are printed as a
+   table, or as a JSON object if json is set. Every benchmark takes
+   num_samples samples, or a default number if it is 0. */
+void bench_begin(int json, unsigned int num_samples);
+void bench_end(void);
+
+/* Calibrate the number of operations of a sample of fn, run a few
+   warmup samples, then time the samples and print the median and the
+   maximum of the time per operation. A sample is a batch of operations
+   lasting a few milliseconds, and its time per operation is the mean
+   over the batch, so these are statistics of batch means, not of
+   single operations. */
+void bench_run(const char *name, bench_fn_t fn, void *data);
+
+/* Attach a value, or an array of num values, to the result of the
+   last benchmark, as a field named key of its JSON object, or as a line
+   below it in the table. */
+void bench_value(const char *key, uint64_t value);
+void bench_values(const char *key, const uint64_t *values, unsigned int num);
+
+/* monotonic time in seconds */
+double bench_time(void);
+
+void bench_perm(void);
+void bench_perm_batch(void);
+void bench_group(void);
+void bench_move(void);
+void bench_scramble(void);
+void bench_solve(void);
+void bench_bfs(void);
+
+#endif /* BENCH_H */
@@ -0,0 +1,153 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+#include "lib/bfs.h"
+#include "lib/cube.h"
+#include "lib/notation.h"
+#include "lib/pocket.h"
+#include "lib/puzzle.h"
+#include "lib/pyraminx.h"
+#include "lib/skewb.h"
+
+struct bfs_data_t
+{
+  bfs_t bfs;
+  uint8_t *conf;
+};
+
+static unsigned int bench_bfs_run(void *data_, unsigned long num)
+{
+  struct bfs_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    bfs_run(&data->bfs, data->conf, 0);
+    r += data->bfs.max_depth;
+  }
+  return r;
+}
+
+/* Report the number of configurations at every distance found by the
+   last run, and the antipodes, listed when there are few of them. */
+#define BENCH_BFS_MAX_ANTIPODES 100
+
+static void bench_bfs_report(struct bfs_data_t *data)
+{
+  bfs_t *bfs = &data->bfs;
+  bench_values("num_by_depth", bfs->num_by_depth, bfs->max_depth + 1);
+  bench_value("num_antipodes", bfs->num_antipodes);
+  if (bfs->num_antipodes <= BENCH_BFS_MAX_ANTIPODES) {
+    bench_values("antipodes", bfs->antipodes, bfs->num_antipodes);
+  }
+}
+
+static uint64_t pyraminx_bfs_index(void *data, uint8_t *conf)
+{
+  return pyraminx_index(data, conf);
+}
+
+static void pyraminx_bfs_conf(void *data, uint8_t *conf, uint64_t i)
+{
+  pyraminx_conf(data, conf, i);
+}
+
+static uint64_t skewb_bfs_index(void *data, uint8_t *conf)
+{
+  return skewb_index(data, conf);
+}
+
+static void skewb_bfs_conf(void *data, uint8_t *conf, uint64_t i)
+{
+  skewb_conf(data, conf, i);
+}
+
+static uint64_t pocket_bfs_index(void *data, uint8_t *conf)
+{
+  return pocket_index(data, conf);
+}
+
+static void pocket_bfs_conf(void *data, uint8_t *conf, uint64_t i)
+{
+  pocket_conf(data, conf, i);
+}
+
+void bench_bfs(void)
+{
+  struct bfs_data_t data;
+  puzzle_action_t action;
+  puzzle_t puzzle;
+  move_seq_t moves;
+
+  /* pyraminx without tips, turning the tip and the layer below it */
+  {
+    pyraminx_action_init(&action);
+    pyraminx_puzzle_init(&puzzle, &action);
+    move_seq_init(&moves);
+    for (unsigned int v = 0; v < 4; v++) {
+      move_seq_push(&moves, v, 1, 1);
+      move_seq_push(&moves, v, 1, -1);
+    }
+
+    bfs_init(&data.bfs, &puzzle, &moves, PYRAMINX_NUM_STATES,
+             pyraminx_bfs_index, pyraminx_bfs_conf, &action);
+    data.conf = pyraminx_new(&action);
+    bench_run("bfs_pyraminx", bench_bfs_run, &data);
+    bench_bfs_report(&data);
+
+    free(data.conf);
+    bfs_cleanup(&data.bfs);
+    move_seq_cleanup(&moves);
+    puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+    puzzle_action_cleanup(&action);
+  }
+
+  {
+    skewb_action_init(&action);
+    skewb_puzzle_init(&puzzle, &action);
+    move_seq_init(&moves);
+    for (unsigned int v = 0; v < 4; v++) {
+      move_seq_push(&moves, v, 0, 1);
+      move_seq_push(&moves, v, 0, -1);
+    }
+
+    bfs_init(&data.bfs, &puzzle, &moves, SKEWB_NUM_STATES,
+             skewb_bfs_index, skewb_bfs_conf, &action);
+    data.conf = skewb_new(&action);
+    bench_run("bfs_skewb", bench_bfs_run, &data);
+    bench_bfs_report(&data);
+
+    free(data.conf);
+    bfs_cleanup(&data.bfs);
+    move_seq_cleanup(&moves);
+    puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+    puzzle_action_cleanup(&action);
+  }
+
+  /* 2x2x2 cube in the half turn metric, up to rotations */
+  {
+    puzzle_action_t *cube_action = malloc(sizeof(puzzle_action_t));
+    cube_action_init(cube_action);
+    cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+    cube_shape_init(shape, 2);
+    cube_puzzle_init(&puzzle, cube_action, shape);
+
+    pocket_t pocket;
+    pocket_init(&pocket, cube_action, shape, 1);
+    move_seq_init(&moves);
+    for (unsigned int m = 0; m < pocket.num_moves; m++) {
+      move_seq_push(&moves, pocket.faces[m], 0, pocket.counts[m]);
+    }
+
+    bfs_init(&data.bfs, &puzzle, &moves, POCKET_NUM_STATES,
+             pocket_bfs_index, pocket_bfs_conf, &pocket);
+    data.conf = cube_new(cube_action, shape);
+    bench_run("bfs_pocket/htm", bench_bfs_run, &data);
+    bench_bfs_report(&data);
+
+    free(data.conf);
+    bfs_cleanup(&data.bfs);
+    move_seq_cleanup(&moves);
+    pocket_cleanup(&pocket);
+    puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+  }
+}
@@ -0,0 +1,114 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lib/abs_poly.h"
+#include "lib/cube.h"
+#include "lib/group.h"
+#include "lib/megaminx.h"
+#include "lib/puzzle.h"
+
+struct group_data_t
+{
+  group_t *group;
+  puzzle_action_t *action;
+  unsigned int num;
+};
+
+static unsigned int bench_group_mul(void *data_, unsigned long num)
+{
+  struct group_data_t *data = data_;
+  unsigned int x = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    x = group_mul(data->group, x, i % data->num);
+  }
+  return x;
+}
+
+static unsigned int bench_group_table_mul(void *data_, unsigned long num)
+{
+  struct group_data_t *data = data_;
+  group_table_t *table = data->group->table;
+  unsigned int x = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    x = group_table_mul(table, x, i % data->num);
+  }
+  return x;
+}
+
+/* act on every piece in turn, chaining symmetries through the results */
+static unsigned int bench_puzzle_action_act(void *data_, unsigned long num)
+{
+  struct group_data_t *data = data_;
+  unsigned int num_pieces = data->action->decomp.num_pieces;
+  unsigned int ret = 0;
+  unsigned int x = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    ret = puzzle_action_act(data->action, x, (i + ret) % data->num);
+    if (++x == num_pieces) x = 0;
+  }
+  return ret;
+}
+
+static void bench_group_run(const char *prefix, struct group_data_t *data)
+{
+  char name[64];
+
+  snprintf(name, sizeof(name), "group_mul/%s", prefix);
+  bench_run(name, bench_group_mul, data);
+  if (data->group->table) {
+    snprintf(name, sizeof(name), "group_table_mul/%s", prefix);
+    bench_run(name, bench_group_table_mul, data);
+  }
+  if (data->action) {
+    snprintf(name, sizeof(name), "puzzle_action_act/%s", prefix);
+    bench_run(name, bench_puzzle_action_act, data);
+  }
+}
+
+void bench_group(void)
+{
+  struct group_data_t data;
+
+  {
+    puzzle_action_t action;
+    cube_action_init(&action);
+    data.group = action.group;
+    data.action = &action;
+    data.num = action.group->num;
+    bench_group_run("cube", &data);
+    puzzle_action_cleanup(&action);
+  }
+
+  {
+    abs_poly_t dodec;
+    abs_dodec(&dodec);
+    poly_data_t poly_data;
+    poly_data_init(&poly_data, &dodec);
+    puzzle_action_t action;
+    megaminx_action_init(&action, &dodec, &poly_data);
+    poly_data_cleanup(&poly_data);
+    abs_poly_cleanup(&dodec);
+
+    data.group = action.group;
+    data.action = &action;
+    data.num = action.group->num;
+    bench_group_run("megaminx", &data);
+    puzzle_action_cleanup(&action);
+  }
+
+  /* symmetric groups, memoised or not */
+  static const unsigned int sizes[] = { 5, 8 };
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    char prefix[16];
+    group_t group;
+    group_perm(&group, sizes[i]);
+    data.group = &group;
+    data.action = 0;
+    data.num = group.num;
+    snprintf(prefix, sizeof(prefix), "perm%u", sizes[i]);
+    bench_group_run(prefix, &data);
+    group_cleanup(&group);
+  }
+}
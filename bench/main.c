@@ -0,0 +1,83 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct suite_t
+{
+  const char *name;
+  void (*run)(void);
+};
+
+static const struct suite_t suites[] = {
+  { "perm", bench_perm },
+  { "perm_batch", bench_perm_batch },
+  { "group", bench_group },
+  { "move", bench_move },
+  { "scramble", bench_scramble },
+  { "solve", bench_solve },
+  { "bfs", bench_bfs },
+};
+
+static const unsigned int num_suites = sizeof(suites) / sizeof(suites[0]);
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [--json] [--samples N] [SUITE]...\nsuites:", name);
+  for (unsigned int i = 0; i < num_suites; i++) {
+    fprintf(stderr, " %s", suites[i].name);
+  }
+  fprintf(stderr, "\n");
+}
+
+static int suite_known(const char *name)
+{
+  for (unsigned int i = 0; i < num_suites; i++) {
+    if (!strcmp(name, suites[i].name)) return 1;
+  }
+  return 0;
+}
+
+/* Usage: bench [--json] [--samples N] [SUITE]...
+
+   Run the given suites, or all of them. Unknown arguments are a usage
+   error. */
+int main(int argc, char **argv)
+{
+  int json = 0;
+  unsigned int num_samples = 0;
+  int num_selected = 0;
+  const char **selected = malloc(argc * sizeof(const char *));
+
+  for (int j = 1; j < argc; j++) {
+    if (!strcmp(argv[j], "--json")) {
+      json = 1;
+    }
+    else if (!strcmp(argv[j], "--samples") && j + 1 < argc) {
+      num_samples = strtoul(argv[++j], 0, 10);
+    }
+    else if (suite_known(argv[j])) {
+      selected[num_selected++] = argv[j];
+    }
+    else {
+      fprintf(stderr, "%s: unknown suite or option '%s'\n", argv[0], argv[j]);
+      usage(argv[0]);
+      free(selected);
+      return 1;
+    }
+  }
+
+  bench_begin(json, num_samples);
+  for (unsigned int i = 0; i < num_suites; i++) {
+    int run = num_selected == 0;
+    for (int j = 0; j < num_selected; j++) {
+      if (!strcmp(selected[j], suites[i].name)) run = 1;
+    }
+    if (run) suites[i].run();
+  }
+  bench_end();
+
+  free(selected);
+  return 0;
+}
@@ -0,0 +1,399 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/abs_poly.h"
+#include "lib/conf.h"
+#include "lib/conf_pack.h"
+#include "lib/conf_sym.h"
+#include "lib/cube.h"
+#include "lib/megaminx.h"
+#include "lib/move_table.h"
+#include "lib/notation.h"
+#include "lib/puzzle.h"
+#include "lib/pyraminx.h"
+#include "lib/square1.h"
+
+struct move_data_t
+{
+  rng_t rng;
+  puzzle_t puzzle;
+  uint8_t *conf;
+  unsigned int num_faces;
+  unsigned int num_layers;
+
+  move_table_t table;
+  uint8_t *pos;
+
+  conf_space_t space;
+  uint8_t *rel;
+
+  conf_packing_t packing;
+  uint8_t *packed;
+
+  conf_syms_t syms;
+
+  cube_coords_t coords;
+
+  move_seq_t seq;
+};
+
+static unsigned int bench_puzzle_move(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  puzzle_t *puzzle = &data->puzzle;
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t r = rng_next(&data->rng);
+    unsigned int f = (r & 0xffff) % data->num_faces;
+    unsigned int l = ((r >> 16) & 0xffff) % data->num_layers;
+    int c = (r >> 32) & 1 ? 1 : -1;
+    turn_t *turn = puzzle->move(puzzle->move_data, data->conf, f, l, c);
+    if (turn) turn_del(turn);
+  }
+  return data->conf[0];
+}
+
+static unsigned int bench_puzzle_apply(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  puzzle_t *puzzle = &data->puzzle;
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t r = rng_next(&data->rng);
+    unsigned int f = (r & 0xffff) % data->num_faces;
+    unsigned int l = ((r >> 16) & 0xffff) % data->num_layers;
+    int c = (r >> 32) & 1 ? 1 : -1;
+    puzzle->apply(puzzle->move_data, data->conf, f, l, c, 0);
+  }
+  return data->conf[0];
+}
+
+static unsigned int bench_cube_coords_apply(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t r = rng_next(&data->rng);
+    unsigned int f = (r & 0xffff) % data->num_faces;
+    unsigned int l = ((r >> 16) & 0xffff) % data->num_layers;
+    int c = (r >> 32) & 1 ? 1 : -1;
+    cube_coords_apply(&data->coords, data->conf, f, l, c, 0);
+  }
+  return data->conf[0];
+}
+
+static unsigned int bench_table_move(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t r = rng_next(&data->rng);
+    unsigned int f = (r & 0xffff) % data->num_faces;
+    unsigned int l = ((r >> 16) & 0xffff) % data->num_layers;
+    int c = (r >> 32) & 1 ? 1 : -1;
+    move_table_apply(&data->table, data->pos, f, l, c);
+  }
+  return data->pos[0];
+}
+
+static unsigned int bench_conf_apply(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    conf_apply(&data->space, data->conf, data->conf, data->rel);
+  }
+  return data->conf[0];
+}
+
+static unsigned int bench_conf_pack(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    conf_pack(&data->packing, data->packed, data->conf);
+  }
+  return data->packed[0];
+}
+
+static unsigned int bench_conf_unpack(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    conf_unpack(&data->packing, data->conf, data->packed);
+  }
+  return data->conf[0];
+}
+
+static unsigned int bench_conf_hash(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  uint64_t h = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    h += conf_hash(data->packed, data->packing.size);
+    data->packed[0] = h;
+  }
+  return h;
+}
+
+static unsigned int bench_conf_canonical(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    ret += conf_canonical(&data->syms, data->rel, data->conf);
+  }
+  return ret;
+}
+
+static unsigned int bench_seq_apply(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    move_seq_apply(&data->puzzle, data->conf, &data->seq);
+  }
+  return data->conf[0];
+}
+
+static void move_data_init_pos(struct move_data_t *data, decomp_t *decomp)
+{
+  data->pos = malloc(data->table.num_slots);
+  move_table_pos_from_conf(&data->table, decomp, data->pos, data->conf);
+}
+
+static void move_data_cleanup_pos(struct move_data_t *data)
+{
+  free(data->pos);
+  move_table_cleanup(&data->table);
+}
+
+static unsigned int bench_cube_startup(void *data, unsigned long num)
+{
+  unsigned int n = *(unsigned int *) data;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    puzzle_action_t action;
+    cube_action_init(&action);
+    cube_shape_t shape;
+    cube_shape_init(&shape, n);
+    uint8_t *conf = cube_new(&action, &shape);
+    ret += conf[shape.decomp.num_pieces - 1];
+    free(conf);
+    cube_shape_cleanup(&shape);
+    puzzle_action_cleanup(&action);
+  }
+  return ret;
+}
+
+static unsigned int bench_cube_move_table_init(void *data_, unsigned long num)
+{
+  struct move_data_t *data = data_;
+  cube_puzzle_data_t *pdata = data->puzzle.move_data;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    move_table_t table;
+    cube_move_table_init(&table, pdata->action, pdata->shape);
+    ret += table.offset[1];
+    move_table_cleanup(&table);
+  }
+  return ret;
+}
+
+static void bench_cube_move(unsigned int n)
+{
+  struct move_data_t data;
+  char name[64];
+
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, n);
+  cube_puzzle_init(&data.puzzle, action, shape);
+
+  rng_init(&data.rng, n);
+  data.conf = cube_new(action, shape);
+  data.num_faces = 6;
+  data.num_layers = (n + 1) / 2;
+
+  snprintf(name, sizeof(name), "cube_move/%u", n);
+  bench_run(name, bench_puzzle_move, &data);
+  snprintf(name, sizeof(name), "cube_apply/%u", n);
+  bench_run(name, bench_puzzle_apply, &data);
+  cube_coords_init(&data.coords, action, shape, data.conf);
+  snprintf(name, sizeof(name), "cube_coords_apply/%u", n);
+  bench_run(name, bench_cube_coords_apply, &data);
+  cube_coords_cleanup(&data.coords);
+  snprintf(name, sizeof(name), "cube_startup/%u", n);
+  bench_run(name, bench_cube_startup, &n);
+
+  snprintf(name, sizeof(name), "cube_move_table_init/%u", n);
+  bench_run(name, bench_cube_move_table_init, &data);
+  cube_move_table_init(&data.table, action, shape);
+  move_data_init_pos(&data, &shape->decomp);
+  snprintf(name, sizeof(name), "cube_table_move/%u", n);
+  bench_run(name, bench_table_move, &data);
+  move_data_cleanup_pos(&data);
+
+  /* a sequence of 100 moves, folded into a relative configuration */
+  cube_conf_space_init(&data.space, action, shape);
+  uint8_t *solved = cube_new(action, shape);
+  memcpy(data.conf, solved, shape->decomp.num_pieces);
+  bench_puzzle_apply(&data, 100);
+  data.rel = malloc(shape->decomp.num_pieces);
+  conf_relative(&data.space, data.rel, solved, data.conf);
+  snprintf(name, sizeof(name), "cube_conf_apply/%u", n);
+  bench_run(name, bench_conf_apply, &data);
+  free(data.rel);
+  free(solved);
+  conf_space_cleanup(&data.space);
+
+  cube_conf_packing_init(&data.packing, action, shape);
+  data.packed = malloc(data.packing.size);
+  conf_pack(&data.packing, data.packed, data.conf);
+  snprintf(name, sizeof(name), "cube_conf_pack/%u", n);
+  bench_run(name, bench_conf_pack, &data);
+  snprintf(name, sizeof(name), "cube_conf_unpack/%u", n);
+  bench_run(name, bench_conf_unpack, &data);
+  snprintf(name, sizeof(name), "cube_conf_hash/%u", n);
+  bench_run(name, bench_conf_hash, &data);
+  free(data.packed);
+  conf_packing_cleanup(&data.packing);
+
+  /* rotations, reflections when possible, and inverse */
+  {
+    abs_poly_t poly;
+    abs_cube(&poly);
+    poly_data_t poly_data;
+    poly_data_init(&poly_data, &poly);
+    symmetries_t poly_syms;
+    symmetries_init(&poly_syms, &poly, &poly_data);
+
+    cube_conf_space_init(&data.space, action, shape);
+    if (!conf_syms_init(&data.syms, &data.space, &poly_syms, 2, 1)) {
+      conf_syms_init(&data.syms, &data.space, 0, 0, 1);
+    }
+    data.rel = malloc(shape->decomp.num_pieces);
+    snprintf(name, sizeof(name), "cube_conf_canonical/%u", n);
+    bench_run(name, bench_conf_canonical, &data);
+    free(data.rel);
+    conf_syms_cleanup(&data.syms);
+    conf_space_cleanup(&data.space);
+
+    symmetries_cleanup(&poly_syms);
+    poly_data_cleanup(&poly_data);
+    abs_poly_cleanup(&poly);
+  }
+
+  notation_t notation;
+  notation_cube_init(&notation, action, n);
+  move_seq_init(&data.seq);
+  notation_parse(&notation, &data.seq, "R U R' U' Rw2 F2 Uw' x y'", 0);
+  snprintf(name, sizeof(name), "cube_seq_apply/%u", n);
+  bench_run(name, bench_seq_apply, &data);
+  move_seq_cleanup(&data.seq);
+
+  free(data.conf);
+  data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+}
+
+static void bench_pyraminx_move(void)
+{
+  struct move_data_t data;
+
+  puzzle_action_t action;
+  pyraminx_action_init(&action);
+  pyraminx_puzzle_init(&data.puzzle, &action);
+
+  rng_init(&data.rng, 0);
+  data.conf = pyraminx_new(&action);
+  data.num_faces = 4;
+  data.num_layers = 3;
+
+  bench_run("pyraminx_move", bench_puzzle_move, &data);
+  bench_run("pyraminx_apply", bench_puzzle_apply, &data);
+
+  pyraminx_move_table_init(&data.table, &action);
+  move_data_init_pos(&data, &action.decomp);
+  bench_run("pyraminx_table_move", bench_table_move, &data);
+  move_data_cleanup_pos(&data);
+
+  free(data.conf);
+  data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+  puzzle_action_cleanup(&action);
+}
+
+static void bench_megaminx_move(void)
+{
+  struct move_data_t data;
+
+  abs_poly_t dodec;
+  abs_dodec(&dodec);
+  poly_data_t poly_data;
+  poly_data_init(&poly_data, &dodec);
+  puzzle_action_t action;
+  megaminx_action_init(&action, &dodec, &poly_data);
+  poly_data_cleanup(&poly_data);
+  abs_poly_cleanup(&dodec);
+  megaminx_puzzle_init(&data.puzzle, &action);
+
+  rng_init(&data.rng, 0);
+  data.conf = megaminx_new(&action);
+  data.num_faces = 12;
+  data.num_layers = 1;
+
+  bench_run("megaminx_move", bench_puzzle_move, &data);
+  bench_run("megaminx_apply", bench_puzzle_apply, &data);
+
+  megaminx_move_table_init(&data.table, &action);
+  move_data_init_pos(&data, &action.decomp);
+  bench_run("megaminx_table_move", bench_table_move, &data);
+  move_data_cleanup_pos(&data);
+
+  free(data.conf);
+  data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+  puzzle_action_cleanup(&action);
+}
+
+/* random top, bottom and slash moves, some of which are blocked */
+static unsigned int bench_square1_apply(void *data_, unsigned long num)
+{
+  static const unsigned int faces[] = { 0, 1, 3 };
+
+  struct move_data_t *data = data_;
+  puzzle_t *puzzle = &data->puzzle;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t r = rng_next(&data->rng);
+    unsigned int f = faces[(r & 0xffff) % 3];
+    int c = ((r >> 16) & 0xffff) % 11 - 5;
+    ret += puzzle->apply(puzzle->move_data, data->conf, f, 0, c, 0);
+  }
+  return ret;
+}
+
+static void bench_square1_move(void)
+{
+  struct move_data_t data;
+
+  puzzle_action_t action;
+  square1_action_init(&action);
+  square1_puzzle_init(&data.puzzle, &action);
+
+  rng_init(&data.rng, 0);
+  data.conf = square1_new(data.puzzle.decomp);
+
+  bench_run("square1_apply", bench_square1_apply, &data);
+
+  free(data.conf);
+  data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+  puzzle_action_cleanup(&action);
+}
+
+void bench_move(void)
+{
+  static const unsigned int sizes[] = { 2, 3, 5, 10, 50, 100 };
+
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    bench_cube_move(sizes[i]);
+  }
+  bench_pyraminx_move();
+  bench_megaminx_move();
+  bench_square1_move();
+}
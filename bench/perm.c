@@ -0,0 +1,236 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lib/perm.h"
+
+#define POOL_SIZE 64
+
+struct perm_data_t
+{
+  rng_t rng;
+  size_t len;
+  uint8_t x[PERM_MAX_LEN];
+  uint8_t r[PERM_MAX_LEN];
+  uint8_t pool[POOL_SIZE][PERM_MAX_LEN];
+  int indices[POOL_SIZE];
+  uint64_t indices64[POOL_SIZE];
+#ifdef PERM_INDEX128
+  perm_index128_t indices128[POOL_SIZE];
+#endif
+};
+
+static unsigned int bench_perm_composed(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_composed(data->r, data->pool[i % POOL_SIZE],
+                  data->pool[(i + 1) % POOL_SIZE], data->len);
+    ret += data->r[0];
+  }
+  return ret;
+}
+
+static unsigned int bench_perm_mul(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_mul(data->x, data->pool[i % POOL_SIZE], data->len);
+  }
+  return data->x[0];
+}
+
+static unsigned int bench_perm_mul_inv(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_mul_inv(data->x, data->pool[i % POOL_SIZE], data->len);
+  }
+  return data->x[0];
+}
+
+static unsigned int bench_perm_lmul(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_lmul(data->x, data->pool[i % POOL_SIZE], data->len);
+  }
+  return data->x[0];
+}
+
+static unsigned int bench_perm_lmul_inv(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_lmul_inv(data->x, data->pool[i % POOL_SIZE], data->len);
+  }
+  return data->x[0];
+}
+
+static unsigned int bench_perm_inv(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_inv(data->x, data->len);
+  }
+  return data->x[0];
+}
+
+static unsigned int bench_perm_conj(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_conj(data->x, data->pool[i % POOL_SIZE], data->len);
+  }
+  return data->x[0];
+}
+
+static unsigned int bench_perm_index(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    ret += perm_index(data->pool[i % POOL_SIZE], data->len, data->len);
+  }
+  return ret;
+}
+
+static unsigned int bench_perm_sign(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    ret += perm_sign(data->pool[i % POOL_SIZE], data->len);
+  }
+  return ret;
+}
+
+static unsigned int bench_perm_from_index(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_from_index(data->x, data->len,
+                    data->indices[i % POOL_SIZE], data->len);
+    ret += data->x[0];
+  }
+  return ret;
+}
+
+static unsigned int bench_perm_index64(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    ret += perm_index64(data->pool[i % POOL_SIZE], data->len, data->len);
+  }
+  return ret;
+}
+
+static unsigned int bench_perm_from_index64(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_from_index64(data->x, data->len,
+                      data->indices64[i % POOL_SIZE], data->len);
+    ret += data->x[0];
+  }
+  return ret;
+}
+
+#ifdef PERM_INDEX128
+static unsigned int bench_perm_index128(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    ret += perm_index128(data->pool[i % POOL_SIZE], data->len, data->len);
+  }
+  return ret;
+}
+
+static unsigned int bench_perm_from_index128(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  unsigned int ret = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_from_index128(data->x, data->len,
+                       data->indices128[i % POOL_SIZE], data->len);
+    ret += data->x[0];
+  }
+  return ret;
+}
+#endif
+
+static unsigned int bench_perm_shuffle(void *data_, unsigned long num)
+{
+  struct perm_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    perm_shuffle(data->x, data->len, &data->rng);
+  }
+  return data->x[0];
+}
+
+static void perm_data_init(struct perm_data_t *data, size_t len)
+{
+  rng_init(&data->rng, len);
+  data->len = len;
+  perm_id(data->x, len);
+  for (unsigned int i = 0; i < POOL_SIZE; i++) {
+    perm_id(data->pool[i], len);
+    perm_shuffle(data->pool[i], len, &data->rng);
+    if (len <= 12) {
+      data->indices[i] = perm_index(data->pool[i], len, len);
+    }
+    if (len <= 20) {
+      data->indices64[i] = perm_index64(data->pool[i], len, len);
+    }
+#ifdef PERM_INDEX128
+    data->indices128[i] = perm_index128(data->pool[i], len, len);
+#endif
+  }
+}
+
+void bench_perm(void)
+{
+  static const size_t lens[] = { 8, 12, 20, 24, 30 };
+  struct perm_data_t data;
+  char name[64];
+
+  for (unsigned int i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    size_t len = lens[i];
+    perm_data_init(&data, len);
+
+#define RUN(fn) \
+    snprintf(name, sizeof(name), #fn "/%zu", len); \
+    bench_run(name, bench_ ## fn, &data)
+
+    RUN(perm_composed);
+    RUN(perm_mul);
+    RUN(perm_mul_inv);
+    RUN(perm_lmul);
+    RUN(perm_lmul_inv);
+    RUN(perm_inv);
+    RUN(perm_conj);
+    RUN(perm_sign);
+    RUN(perm_shuffle);
+    /* indices are ints, and overflow past 12 elements */
+    if (len <= 12) {
+      RUN(perm_index);
+      RUN(perm_from_index);
+    }
+    if (len <= 20) {
+      RUN(perm_index64);
+      RUN(perm_from_index64);
+    }
+#ifdef PERM_INDEX128
+    RUN(perm_index128);
+    RUN(perm_from_index128);
+#endif
+
+#undef RUN
+  }
+}
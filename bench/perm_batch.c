@@ -0,0 +1,217 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lib/perm.h"
+#include "lib/perm_batch.h"
+
+/* Each operation is a single permutation, so that the figures can be
+   compared with a loop calling the scalar functions over the same
+   contiguous permutations. */
+
+#define BATCH_SIZE 4000
+#define BATCH_MAX_LEN 24
+
+struct perm_batch_data_t
+{
+  size_t len;
+  uint8_t p[BATCH_MAX_LEN];
+  uint8_t x[BATCH_SIZE * BATCH_MAX_LEN];
+  uint8_t y[BATCH_SIZE * BATCH_MAX_LEN];
+  uint8_t r[BATCH_SIZE * BATCH_MAX_LEN];
+  uint8_t xs[BATCH_SIZE * BATCH_MAX_LEN];
+  uint8_t ys[BATCH_SIZE * BATCH_MAX_LEN];
+  uint8_t rs[BATCH_SIZE * BATCH_MAX_LEN];
+  uint8_t signs[BATCH_SIZE];
+  uint64_t indices[BATCH_SIZE];
+};
+
+/* round up to whole batches */
+static inline unsigned long num_batches(unsigned long num)
+{
+  return (num + BATCH_SIZE - 1) / BATCH_SIZE;
+}
+
+static unsigned int bench_scalar_composed(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  size_t len = data->len;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    for (size_t k = 0; k < BATCH_SIZE; k++) {
+      perm_composed(data->r + k * len, data->x + k * len,
+                    data->y + k * len, len);
+    }
+  }
+  return data->r[0];
+}
+
+static unsigned int bench_batch_composed(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    perm_batch_composed(data->rs, data->xs, data->ys, data->len, BATCH_SIZE);
+  }
+  return data->rs[0];
+}
+
+static unsigned int bench_scalar_mul(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  size_t len = data->len;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    for (size_t k = 0; k < BATCH_SIZE; k++) {
+      perm_composed(data->r + k * len, data->x + k * len, data->p, len);
+    }
+  }
+  return data->r[0];
+}
+
+static unsigned int bench_batch_mul(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    perm_batch_mul(data->rs, data->xs, data->p, data->len, BATCH_SIZE);
+  }
+  return data->rs[0];
+}
+
+static unsigned int bench_scalar_lmul(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  size_t len = data->len;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    for (size_t k = 0; k < BATCH_SIZE; k++) {
+      perm_composed(data->r + k * len, data->p, data->x + k * len, len);
+    }
+  }
+  return data->r[0];
+}
+
+static unsigned int bench_batch_lmul(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    perm_batch_lmul(data->rs, data->p, data->xs, data->len, BATCH_SIZE);
+  }
+  return data->rs[0];
+}
+
+static unsigned int bench_scalar_inverted(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  size_t len = data->len;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    for (size_t k = 0; k < BATCH_SIZE; k++) {
+      perm_inverted(data->r + k * len, data->x + k * len, len);
+    }
+  }
+  return data->r[0];
+}
+
+static unsigned int bench_batch_inverted(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    perm_batch_inverted(data->rs, data->xs, data->len, BATCH_SIZE);
+  }
+  return data->rs[0];
+}
+
+static unsigned int bench_scalar_sign(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  size_t len = data->len;
+  unsigned int ret = 0;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    for (size_t k = 0; k < BATCH_SIZE; k++) {
+      ret += perm_sign(data->x + k * len, len);
+    }
+  }
+  return ret;
+}
+
+static unsigned int bench_batch_sign(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    perm_batch_sign(data->signs, data->xs, data->len, BATCH_SIZE);
+  }
+  return data->signs[0];
+}
+
+static unsigned int bench_scalar_index(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  size_t len = data->len;
+  unsigned int ret = 0;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    for (size_t k = 0; k < BATCH_SIZE; k++) {
+      ret += perm_index64(data->x + k * len, len, len);
+    }
+  }
+  return ret;
+}
+
+static unsigned int bench_batch_index(void *data_, unsigned long num)
+{
+  struct perm_batch_data_t *data = data_;
+  for (unsigned long b = 0; b < num_batches(num); b++) {
+    perm_batch_index(data->indices, data->xs, data->len, data->len,
+                     BATCH_SIZE);
+  }
+  return data->indices[0];
+}
+
+static void perm_batch_data_init(struct perm_batch_data_t *data, size_t len)
+{
+  rng_t rng;
+  rng_init(&rng, len);
+  data->len = len;
+  perm_id(data->p, len);
+  perm_shuffle(data->p, len, &rng);
+  for (size_t k = 0; k < BATCH_SIZE; k++) {
+    perm_id(data->x + k * len, len);
+    perm_shuffle(data->x + k * len, len, &rng);
+    perm_id(data->y + k * len, len);
+    perm_shuffle(data->y + k * len, len, &rng);
+  }
+  perm_batch_load(data->xs, data->x, len, BATCH_SIZE);
+  perm_batch_load(data->ys, data->y, len, BATCH_SIZE);
+}
+
+void bench_perm_batch(void)
+{
+  static const size_t lens[] = { 8, 12, 24 };
+  struct perm_batch_data_t *data = malloc(sizeof(struct perm_batch_data_t));
+  char name[64];
+
+  for (unsigned int i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    size_t len = lens[i];
+    perm_batch_data_init(data, len);
+
+#define RUN(fn) \
+    snprintf(name, sizeof(name), #fn "/%zu", len); \
+    bench_run(name, bench_ ## fn, data)
+
+    RUN(scalar_composed);
+    RUN(batch_composed);
+    RUN(scalar_mul);
+    RUN(batch_mul);
+    RUN(scalar_lmul);
+    RUN(batch_lmul);
+    RUN(scalar_inverted);
+    RUN(batch_inverted);
+    RUN(scalar_sign);
+    RUN(batch_sign);
+    /* indices overflow past 20 elements */
+    if (len <= 20) {
+      RUN(scalar_index);
+      RUN(batch_index);
+    }
+
+#undef RUN
+  }
+
+  free(data);
+}
@@ -0,0 +1,105 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lib/abs_poly.h"
+#include "lib/cube.h"
+#include "lib/megaminx.h"
+#include "lib/puzzle.h"
+#include "lib/pyraminx.h"
+#include "lib/square1.h"
+
+struct scramble_data_t
+{
+  rng_t rng;
+  puzzle_t puzzle;
+  uint8_t *conf;
+};
+
+static unsigned int bench_puzzle_scramble(void *data_, unsigned long num)
+{
+  struct scramble_data_t *data = data_;
+  puzzle_t *puzzle = &data->puzzle;
+  for (unsigned long i = 0; i < num; i++) {
+    puzzle->scramble(puzzle->scramble_data, data->conf, &data->rng);
+  }
+  return data->conf[0];
+}
+
+static void bench_cube_scramble(unsigned int n)
+{
+  struct scramble_data_t data;
+  char name[64];
+
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, n);
+  cube_puzzle_init(&data.puzzle, action, shape);
+
+  rng_init(&data.rng, n);
+  data.conf = cube_new(action, shape);
+
+  snprintf(name, sizeof(name), "cube_scramble/%u", n);
+  bench_run(name, bench_puzzle_scramble, &data);
+
+  free(data.conf);
+  data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+}
+
+void bench_scramble(void)
+{
+  static const unsigned int sizes[] = { 2, 3, 5, 10, 50, 100 };
+  struct scramble_data_t data;
+  puzzle_action_t action;
+
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    bench_cube_scramble(sizes[i]);
+  }
+
+  {
+    abs_poly_t dodec;
+    abs_dodec(&dodec);
+    poly_data_t poly_data;
+    poly_data_init(&poly_data, &dodec);
+    megaminx_action_init(&action, &dodec, &poly_data);
+    poly_data_cleanup(&poly_data);
+    abs_poly_cleanup(&dodec);
+    megaminx_puzzle_init(&data.puzzle, &action);
+
+    rng_init(&data.rng, 0);
+    data.conf = megaminx_new(&action);
+    bench_run("megaminx_scramble", bench_puzzle_scramble, &data);
+
+    free(data.conf);
+    data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+    puzzle_action_cleanup(&action);
+  }
+
+  {
+    pyraminx_action_init(&action);
+    pyraminx_puzzle_init(&data.puzzle, &action);
+
+    rng_init(&data.rng, 0);
+    data.conf = pyraminx_new(&action);
+    bench_run("pyraminx_scramble", bench_puzzle_scramble, &data);
+
+    free(data.conf);
+    data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+    puzzle_action_cleanup(&action);
+  }
+
+  {
+    square1_action_init(&action);
+    square1_puzzle_init(&data.puzzle, &action);
+
+    rng_init(&data.rng, 0);
+    data.conf = square1_new(data.puzzle.decomp);
+    bench_run("square1_scramble", bench_puzzle_scramble, &data);
+
+    free(data.conf);
+    data.puzzle.cleanup(data.puzzle.cleanup_data, &data.puzzle);
+    puzzle_action_cleanup(&action);
+  }
+}
@@ -0,0 +1,364 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/cube.h"
+#include "lib/korf.h"
+#include "lib/notation.h"
+#include "lib/pocket.h"
+#include "lib/puzzle.h"
+#include "lib/search.h"
+#include "lib/two_phase.h"
+
+struct pocket_data_t
+{
+  pocket_t pocket;
+  const char *path;
+  rng_t rng;
+  unsigned int num_confs;
+  uint8_t *confs;
+  move_seq_t seq;
+};
+
+static unsigned int bench_pocket_build(void *data_, unsigned long num)
+{
+  struct pocket_data_t *data = data_;
+  for (unsigned long i = 0; i < num; i++) {
+    pocket_build(&data->pocket, 0);
+  }
+  return data->pocket.table.max_depth;
+}
+
+static unsigned int bench_pocket_load(void *data_, unsigned long num)
+{
+  struct pocket_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    r += pocket_load(&data->pocket, data->path);
+  }
+  return r;
+}
+
+static unsigned int bench_pocket_index(void *data_, unsigned long num)
+{
+  struct pocket_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    r += pocket_index(&data->pocket,
+                      &data->confs[(i % data->num_confs) * 8]);
+  }
+  return r;
+}
+
+static unsigned int bench_pocket_solve(void *data_, unsigned long num)
+{
+  struct pocket_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    data->seq.num = 0;
+    r += pocket_solve(&data->pocket, &data->seq,
+                      &data->confs[(i % data->num_confs) * 8]);
+  }
+  return r;
+}
+
+static void bench_pocket(int half_turns)
+{
+  struct pocket_data_t data;
+  const char *metric = half_turns ? "htm" : "qtm";
+  char name[64];
+  char path[256];
+
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, 2);
+  puzzle_t puzzle;
+  cube_puzzle_init(&puzzle, action, shape);
+
+  pocket_init(&data.pocket, action, shape, half_turns);
+  snprintf(name, sizeof(name), "pocket_build/%s", metric);
+  bench_run(name, bench_pocket_build, &data);
+
+  const char *tmpdir = getenv("TMPDIR");
+  snprintf(path, sizeof(path), "%s/bench_pocket_%s.tbl",
+           tmpdir ? tmpdir : "/tmp", metric);
+  data.path = path;
+  if (pocket_save(&data.pocket, path)) {
+    snprintf(name, sizeof(name), "pocket_load/%s", metric);
+    bench_run(name, bench_pocket_load, &data);
+    remove(path);
+  }
+
+  rng_init(&data.rng, 0);
+  data.num_confs = 1024;
+  data.confs = malloc(data.num_confs * 8);
+  for (unsigned int i = 0; i < data.num_confs; i++) {
+    uint8_t *conf = &data.confs[i * 8];
+    uint8_t *solved = cube_new(action, shape);
+    memcpy(conf, solved, 8);
+    free(solved);
+    puzzle.scramble(puzzle.scramble_data, conf, &data.rng);
+  }
+  move_seq_init(&data.seq);
+
+  snprintf(name, sizeof(name), "pocket_index/%s", metric);
+  bench_run(name, bench_pocket_index, &data);
+  snprintf(name, sizeof(name), "pocket_solve/%s", metric);
+  bench_run(name, bench_pocket_solve, &data);
+
+  move_seq_cleanup(&data.seq);
+  free(data.confs);
+  pocket_cleanup(&data.pocket);
+  puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+}
+
+struct two_phase_data_t
+{
+  two_phase_t solver;
+  const char *path;
+  puzzle_action_t *action;
+  cube_shape_t *shape;
+  unsigned int max_length;
+  unsigned int num_confs;
+  uint8_t *confs;
+  move_seq_t seq;
+};
+
+static unsigned int bench_two_phase_init(void *data_, unsigned long num)
+{
+  struct two_phase_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    two_phase_init(&data->solver, data->action, data->shape);
+    r += data->solver.num_flipslice_classes;
+    two_phase_cleanup(&data->solver);
+  }
+  return r;
+}
+
+static unsigned int bench_two_phase_load(void *data_, unsigned long num)
+{
+  struct two_phase_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    r += two_phase_load(&data->solver, data->path);
+  }
+  return r;
+}
+
+static unsigned int bench_two_phase_solve(void *data_, unsigned long num)
+{
+  struct two_phase_data_t *data = data_;
+  unsigned int num_pieces = data->shape->decomp.num_pieces;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    data->seq.num = 0;
+    r += two_phase_solve(&data->solver, &data->seq,
+                         &data->confs[(i % data->num_confs) * num_pieces],
+                         data->max_length);
+  }
+  return r;
+}
+
+/* The pruning tables take a minute to build on a single processor, so
+   they are built once and kept in TMPDIR for the next runs. */
+static void bench_two_phase(void)
+{
+  struct two_phase_data_t data;
+  char path[256];
+
+  data.action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(data.action);
+  data.shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(data.shape, 3);
+  puzzle_t puzzle;
+  cube_puzzle_init(&puzzle, data.action, data.shape);
+
+  bench_run("two_phase_init", bench_two_phase_init, &data);
+  two_phase_init(&data.solver, data.action, data.shape);
+  const char *tmpdir = getenv("TMPDIR");
+  snprintf(path, sizeof(path), "%s/bench_two_phase.tbl",
+           tmpdir ? tmpdir : "/tmp");
+  data.path = path;
+  if (!two_phase_load(&data.solver, path)) {
+    two_phase_build(&data.solver, 0);
+    two_phase_save(&data.solver, path);
+  }
+  bench_run("two_phase_load", bench_two_phase_load, &data);
+
+  rng_t rng;
+  rng_init(&rng, 0);
+  unsigned int num_pieces = data.shape->decomp.num_pieces;
+  data.num_confs = 256;
+  data.confs = malloc(data.num_confs * num_pieces);
+  for (unsigned int i = 0; i < data.num_confs; i++) {
+    uint8_t *conf = &data.confs[i * num_pieces];
+    uint8_t *solved = cube_new(data.action, data.shape);
+    memcpy(conf, solved, num_pieces);
+    free(solved);
+    puzzle.scramble(puzzle.scramble_data, conf, &rng);
+  }
+  move_seq_init(&data.seq);
+
+  data.max_length = 30;
+  bench_run("two_phase_solve/30", bench_two_phase_solve, &data);
+  data.max_length = 24;
+  bench_run("two_phase_solve/24", bench_two_phase_solve, &data);
+
+  move_seq_cleanup(&data.seq);
+  free(data.confs);
+  two_phase_cleanup(&data.solver);
+  puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+}
+
+/* number of random moves of the configurations solved optimally */
+#define BENCH_KORF_SCRAMBLE 12
+/* depth of the tasks of the parallel search */
+#define BENCH_KORF_SPLIT 3
+
+struct korf_data_t
+{
+  korf_t solver;
+  const char *path;
+  unsigned int num_confs;
+  uint8_t *confs;
+  unsigned int next;
+  move_seq_t seq;
+  search_t search;
+};
+
+static unsigned int bench_korf_load(void *data_, unsigned long num)
+{
+  struct korf_data_t *data = data_;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    r += korf_load(&data->solver, data->path);
+  }
+  return r;
+}
+
+/* one operation is one node of the search */
+static unsigned int bench_korf_node(void *data_, unsigned long num)
+{
+  struct korf_data_t *data = data_;
+  unsigned int num_pieces = data->solver.cubies.shape->decomp.num_pieces;
+  unsigned int r = 0;
+  uint64_t num_nodes = 0;
+  while (num_nodes < num) {
+    data->seq.num = 0;
+    uint8_t *conf = &data->confs[data->next * num_pieces];
+    r += korf_solve(&data->solver, &data->seq, conf, KORF_MAX_LENGTH,
+                    num - num_nodes, &num_nodes);
+    data->next = (data->next + 1) % data->num_confs;
+  }
+  return r;
+}
+
+/* one operation is solving all the configurations */
+static unsigned int bench_korf_solve(void *data_, unsigned long num)
+{
+  struct korf_data_t *data = data_;
+  unsigned int num_pieces = data->solver.cubies.shape->decomp.num_pieces;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    for (unsigned int k = 0; k < data->num_confs; k++) {
+      data->seq.num = 0;
+      r += korf_solve(&data->solver, &data->seq,
+                      &data->confs[k * num_pieces], KORF_MAX_LENGTH, 0, 0);
+    }
+  }
+  return r;
+}
+
+static unsigned int bench_korf_solve_parallel(void *data_, unsigned long num)
+{
+  struct korf_data_t *data = data_;
+  unsigned int num_pieces = data->solver.cubies.shape->decomp.num_pieces;
+  unsigned int r = 0;
+  for (unsigned long i = 0; i < num; i++) {
+    for (unsigned int k = 0; k < data->num_confs; k++) {
+      data->seq.num = 0;
+      r += korf_solve_parallel(&data->solver, &data->search, &data->seq,
+                               &data->confs[k * num_pieces], KORF_MAX_LENGTH,
+                               0);
+    }
+  }
+  return r;
+}
+
+/* The databases take minutes to build on a single processor, so they
+   are built once and kept in TMPDIR for the next runs. */
+static void bench_korf(void)
+{
+  struct korf_data_t data;
+  char path[256];
+
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, 3);
+  puzzle_t puzzle;
+  cube_puzzle_init(&puzzle, action, shape);
+
+  korf_init(&data.solver, action, shape, KORF_MAX_EDGES);
+  const char *tmpdir = getenv("TMPDIR");
+  snprintf(path, sizeof(path), "%s/bench_korf_%u.tbl",
+           tmpdir ? tmpdir : "/tmp", KORF_MAX_EDGES);
+  data.path = path;
+  if (!korf_load(&data.solver, path)) {
+    korf_build(&data.solver, 0);
+    korf_save(&data.solver, path);
+  }
+  bench_run("korf_load", bench_korf_load, &data);
+
+  /* configurations scrambled by a fixed sequence of random moves, so
+     that their optimal solutions are short enough to be found in a
+     fraction of a second */
+  rng_t rng;
+  rng_init(&rng, 0);
+  unsigned int num_pieces = shape->decomp.num_pieces;
+  data.num_confs = 8;
+  data.confs = malloc(data.num_confs * num_pieces);
+  move_seq_init(&data.seq);
+  for (unsigned int i = 0; i < data.num_confs; i++) {
+    uint8_t *conf = &data.confs[i * num_pieces];
+    uint8_t *solved = cube_new(action, shape);
+    memcpy(conf, solved, num_pieces);
+    free(solved);
+
+    data.seq.num = 0;
+    unsigned int last = CUBIES_NUM_MOVES;
+    for (unsigned int k = 0; k < BENCH_KORF_SCRAMBLE; k++) {
+      unsigned int m;
+      do {
+        m = rng_uniform(&rng, CUBIES_NUM_MOVES);
+      } while (last < CUBIES_NUM_MOVES && !cubies_move_allowed(last, m));
+      move_seq_push(&data.seq, m / 3, 0, cubies_counts[m % 3]);
+      last = m;
+    }
+    move_seq_apply(&puzzle, conf, &data.seq);
+  }
+
+  data.next = 0;
+  bench_run("korf_node", bench_korf_node, &data);
+  bench_run("korf_solve/8", bench_korf_solve, &data);
+  korf_search_init(&data.solver, &data.search, 0, BENCH_KORF_SPLIT);
+  bench_run("korf_solve_parallel/8", bench_korf_solve_parallel, &data);
+  search_cleanup(&data.search);
+
+  move_seq_cleanup(&data.seq);
+  free(data.confs);
+  korf_cleanup(&data.solver);
+  puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+}
+
+void bench_solve(void)
+{
+  bench_pocket(1);
+  bench_pocket(0);
+  bench_two_phase();
+  bench_korf();
+}
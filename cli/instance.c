@@ -0,0 +1,104 @@
+#include "instance.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/abs_poly.h"
+#include "lib/cube.h"
+#include "lib/megaminx.h"
+#include "lib/pyraminx.h"
+#include "lib/square1.h"
+
+/* the cube puzzle owns its action and shape */
+static void cube_instance_cleanup(instance_t *instance)
+{
+  instance->puzzle.cleanup(instance->puzzle.cleanup_data, &instance->puzzle);
+}
+
+static void action_instance_cleanup(instance_t *instance)
+{
+  instance->puzzle.cleanup(instance->puzzle.cleanup_data, &instance->puzzle);
+  puzzle_action_cleanup(instance->action);
+  free(instance->action);
+}
+
+static void cube_instance_init(instance_t *instance, unsigned int n)
+{
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, n);
+
+  instance->action = action;
+  cube_puzzle_init(&instance->puzzle, action, shape);
+  notation_cube_init(&instance->notation, action, n);
+  instance->solved = cube_new(action, shape);
+  instance->cleanup = cube_instance_cleanup;
+}
+
+static void megaminx_instance_init(instance_t *instance)
+{
+  abs_poly_t dodec;
+  abs_dodec(&dodec);
+  poly_data_t data;
+  poly_data_init(&data, &dodec);
+  instance->action = malloc(sizeof(puzzle_action_t));
+  megaminx_action_init(instance->action, &dodec, &data);
+  poly_data_cleanup(&data);
+  abs_poly_cleanup(&dodec);
+
+  megaminx_puzzle_init(&instance->puzzle, instance->action);
+  notation_megaminx_init(&instance->notation, instance->action);
+  instance->solved = megaminx_new(instance->action);
+  instance->cleanup = action_instance_cleanup;
+}
+
+static void pyraminx_instance_init(instance_t *instance)
+{
+  instance->action = malloc(sizeof(puzzle_action_t));
+  pyraminx_action_init(instance->action);
+
+  pyraminx_puzzle_init(&instance->puzzle, instance->action);
+  notation_pyraminx_init(&instance->notation);
+  instance->solved = pyraminx_new(instance->action);
+  instance->cleanup = action_instance_cleanup;
+}
+
+static void square1_instance_init(instance_t *instance)
+{
+  instance->action = malloc(sizeof(puzzle_action_t));
+  square1_action_init(instance->action);
+
+  square1_puzzle_init(&instance->puzzle, instance->action);
+  notation_square1_init(&instance->notation);
+  instance->solved = square1_new(instance->puzzle.decomp);
+  instance->cleanup = action_instance_cleanup;
+}
+
+int instance_init(instance_t *instance, const char *name, unsigned int n)
+{
+  if (!strcmp(name, "cube")) {
+    if (n < 2) return 0;
+    cube_instance_init(instance, n);
+  }
+  else if (!strcmp(name, "megaminx")) {
+    megaminx_instance_init(instance);
+  }
+  else if (!strcmp(name, "pyraminx")) {
+    pyraminx_instance_init(instance);
+  }
+  else if (!strcmp(name, "square1")) {
+    square1_instance_init(instance);
+  }
+  else {
+    return 0;
+  }
+
+  return 1;
+}
+
+void instance_cleanup(instance_t *instance)
+{
+  free(instance->solved);
+  instance->cleanup(instance);
+}
@@ -0,0 +1,29 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <stdint.h>
+
+#include "lib/notation.h"
+#include "lib/puzzle.h"
+
+/* A puzzle together with everything needed to drive it from text. */
+struct instance_t
+{
+  puzzle_t puzzle;
+  puzzle_action_t *action;
+  notation_t notation;
+
+  /* solved configuration */
+  uint8_t *solved;
+
+  void (*cleanup)(struct instance_t *instance);
+};
+typedef struct instance_t instance_t;
+
+/* Create the puzzle called name, which is one of cube, megaminx,
+   pyraminx and square1. The size n is only used by the cube. Return 0
+   if there is no such puzzle. */
+int instance_init(instance_t *instance, const char *name, unsigned int n);
+void instance_cleanup(instance_t *instance);
+
+#endif /* INSTANCE_H */
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "instance.h"
+
+#include "lib/notation.h"
+#include "lib/puzzle.h"
+#include "lib/rng.h"
+
+struct driver_t
+{
+  instance_t instance;
+  uint8_t *conf;
+  rng_t rng;
+
+  /* number of times every move line is applied */
+  unsigned long repeat;
+
+  move_seq_t seq;
+  unsigned long num_moves;
+  double time;
+};
+typedef struct driver_t driver_t;
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(FILE *stream)
+{
+  fprintf(stream,
+          "Usage: cli [OPTION]... PUZZLE [FILE]...\n"
+          "Apply moves to PUZZLE, which is one of `cube N', `megaminx',\n"
+          "`pyraminx' and `square1', and print the final state.\n"
+          "\n"
+          "Every line of the files, or of the standard input if there are\n"
+          "none, is either a sequence of moves or one of the commands\n"
+          "`scramble', `new', `print' and `stats'. Lines starting with #\n"
+          "are ignored.\n"
+          "\n"
+          "  -e MOVES  apply MOVES instead of reading any input\n"
+          "  -r COUNT  apply every sequence of moves COUNT times\n"
+          "  -s SEED   seed of the random number generator for scrambles\n"
+          "  -q        do not print the final state\n"
+          "  -t        print statistics at the end\n"
+          "  -h        display this help and exit\n");
+}
+
+static int driver_solved(driver_t *driver)
+{
+  return !memcmp(driver->conf, driver->instance.solved,
+                 driver->instance.puzzle.decomp->num_pieces);
+}
+
+static void driver_print(driver_t *driver)
+{
+  decomp_t *decomp = driver->instance.puzzle.decomp;
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    if (k > 0) printf(" |");
+    for (unsigned int i = 0; i < decomp->orbit_size[k]; i++) {
+      printf(" %u", driver->conf[decomp_global(decomp, k, i)]);
+    }
+  }
+  printf("\n");
+}
+
+static void driver_stats(driver_t *driver)
+{
+  printf("moves %lu time %.6f s rate %.0f moves/s %s\n",
+         driver->num_moves, driver->time,
+         driver->time > 0 ? driver->num_moves / driver->time : 0.0,
+         driver_solved(driver) ? "solved" : "unsolved");
+}
+
+/* Run a line of input. Return 0 if it is invalid. */
+static int driver_run(driver_t *driver, const char *line,
+                      const char *source, unsigned int lineno)
+{
+  instance_t *instance = &driver->instance;
+  puzzle_t *puzzle = &instance->puzzle;
+
+  const char *s = line;
+  while (*s == ' ' || *s == '\t') s++;
+  size_t len = strcspn(s, "\r\n");
+  while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\t')) len--;
+
+  if (len == 0 || *s == '#') return 1;
+
+  if (len == 8 && !strncmp(s, "scramble", len)) {
+    puzzle->scramble(puzzle->scramble_data, driver->conf, &driver->rng);
+  }
+  else if (len == 3 && !strncmp(s, "new", len)) {
+    memcpy(driver->conf, instance->solved, puzzle->decomp->num_pieces);
+  }
+  else if (len == 5 && !strncmp(s, "print", len)) {
+    driver_print(driver);
+  }
+  else if (len == 5 && !strncmp(s, "stats", len)) {
+    driver_stats(driver);
+  }
+  else {
+    char *moves = strndup(s, len);
+    const char *end;
+    driver->seq.num = 0;
+    int ok = notation_parse(&instance->notation, &driver->seq, moves, &end);
+    if (!ok) {
+      fprintf(stderr, "%s:%u: invalid move at column %u\n",
+              source, lineno, (unsigned int) (end - moves + (s - line) + 1));
+    }
+    free(moves);
+    if (!ok) return 0;
+
+    double t0 = now();
+    for (unsigned long i = 0; i < driver->repeat; i++) {
+      unsigned int num = move_seq_apply(puzzle, driver->conf, &driver->seq);
+      driver->num_moves += num;
+      if (num < driver->seq.num) {
+        fprintf(stderr, "%s:%u: move %u is not possible\n",
+                source, lineno, num + 1);
+        driver->time += now() - t0;
+        return 0;
+      }
+    }
+    driver->time += now() - t0;
+  }
+
+  return 1;
+}
+
+static int driver_run_file(driver_t *driver, FILE *stream,
+                           const char *source)
+{
+  int ok = 1;
+  char *line = 0;
+  size_t size = 0;
+  unsigned int lineno = 0;
+  while (getline(&line, &size, stream) != -1) {
+    ok &= driver_run(driver, line, source, ++lineno);
+  }
+  free(line);
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  driver_t driver;
+  const char *moves = 0;
+  unsigned long seed = 0;
+  int quiet = 0;
+  int stats = 0;
+  int opt;
+
+  driver.repeat = 1;
+  while ((opt = getopt(argc, argv, "e:r:s:qth")) != -1) {
+    switch (opt) {
+    case 'e':
+      moves = optarg;
+      break;
+    case 'r':
+      driver.repeat = strtoul(optarg, 0, 10);
+      break;
+    case 's':
+      seed = strtoul(optarg, 0, 10);
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 't':
+      stats = 1;
+      break;
+    case 'h':
+      usage(stdout);
+      return 0;
+    default:
+      usage(stderr);
+      return 2;
+    }
+  }
+
+  if (optind >= argc) {
+    usage(stderr);
+    return 2;
+  }
+  const char *name = argv[optind++];
+  unsigned int n = 0;
+  if (!strcmp(name, "cube")) {
+    if (optind >= argc) {
+      fprintf(stderr, "Missing cube size\n");
+      return 2;
+    }
+    n = strtoul(argv[optind++], 0, 10);
+  }
+
+  if (!instance_init(&driver.instance, name, n)) {
+    fprintf(stderr, "Invalid puzzle `%s'\n", name);
+    return 2;
+  }
+
+  unsigned int num_pieces = driver.instance.puzzle.decomp->num_pieces;
+  driver.conf = malloc(num_pieces);
+  memcpy(driver.conf, driver.instance.solved, num_pieces);
+  rng_init(&driver.rng, seed);
+  move_seq_init(&driver.seq);
+  driver.num_moves = 0;
+  driver.time = 0;
+
+  int ok = 1;
+  if (moves) {
+    ok = driver_run(&driver, moves, "-e", 1);
+  }
+  else if (optind >= argc) {
+    ok = driver_run_file(&driver, stdin, "-");
+  }
+  for (; optind < argc && !moves; optind++) {
+    FILE *stream = strcmp(argv[optind], "-") ? fopen(argv[optind], "r") : stdin;
+    if (!stream) {
+      perror(argv[optind]);
+      ok = 0;
+      continue;
+    }
+    ok &= driver_run_file(&driver, stream, argv[optind]);
+    if (stream != stdin) fclose(stream);
+  }
+
+  if (!quiet) driver_print(&driver);
+  if (stats) driver_stats(&driver);
+
+  move_seq_cleanup(&driver.seq);
+  free(driver.conf);
+  instance_cleanup(&driver.instance);
+
+  return ok ? 0 : 1;
+}
@@ -13,6 +13,7 @@
 void bump_cube_model_cleanup(void *data, puzzle_model_t *model)
 {
   free(model->orbit_data);
+  decomp_cleanup(model->decomp);
   free(model->decomp);
   free(model->rots);
 }
@@ -93,54 +93,17 @@ void quat_cube_sym(quat q, uint8_t s)
   /* printf("q: (%f, %f, %f, %f)\n", q[0], q[1], q[2], q[3]); */
 }
 
-void cube_mul_table(uint8_t *table, uint8_t *perm1, unsigned int s1)
-{
-  unsigned int index = 0;
-  uint8_t perm2[3];
-  for (unsigned int p1 = 0; p1 < 6; p1++) {
-    perm_from_index(perm2, 3, p1, 3);
-    unsigned int sign = perm_sign(perm2, 3);
-
-    for (unsigned int j = 0; j < 4; j++) {
-      unsigned int s2 = j | ((sign ^ (__builtin_popcount(j) & 1)) << 2);
-
-      uint8_t perm[3];
-      perm_composed(perm, perm1, perm2, 3);
-
-      table[index++] = (perm_index(perm, 3, 3) << 2) |
-        ((s2 ^ u16_conj(s1, perm2, 3)) & 0x3);
-    }
-  }
-}
-
 quat *cube_puzzle_action_init(puzzle_action_t *action)
 {
   static const unsigned int num_syms = 24;
 
-  /* The group G' of symmetries of a cube is the wreath product G' of
-  Sigma_3 and O(1). G' acts linearly on the cube by permuting
-  coordinates and changing signs. Explicitly, a pair (sigma, u) of a
-  permutation and a choice of signs acts on the basis elements as
-  follows:
-
-    e_i (sigma, u) = u_i e_(sigma i).
-
-  The determinant of (sigma, u) is sign(sigma) * sum(u). We are
-  interested in the subgroup G of G' consisting of those elements that
-  have determinant 1.
-
-  They can be enumerated by enumerating the permutation sigma first,
-  then choosing all possible signs for the first two axes, and setting
-  the third sign to the only value that makes the determinant
-  positive.
-
-  To generate quaternions for all possible elements of G, we regard a
-  quaternion as an element of Spin(3), and observe that Pin(3) is the
-  direct product Spin(3) x O(1). Therefore, an element of Pin(3) can
-  be represented by a pair of a quaternion and a sign. The strategy is
-  then to write every element of G as a product of Pin(3) elements
-  corresponding to reflections (i.e. tensors of rank 1 in the Clifford
-  algebra).
+  /* To generate quaternions for all possible elements of the group G
+  of cube_action_init, we regard a quaternion as an element of
+  Spin(3), and observe that Pin(3) is the direct product Spin(3) x
+  O(1). Therefore, an element of Pin(3) can be represented by a pair
+  of a quaternion and a sign. The strategy is then to write every
+  element of G as a product of Pin(3) elements corresponding to
+  reflections (i.e. tensors of rank 1 in the Clifford algebra).
 
   Since we know that this product is ultimately going to be
   a rotation, we can ignore the sign component, and simply use a
@@ -153,8 +116,6 @@ quat *cube_puzzle_action_init(puzzle_action_t *action)
   associated to v.
  */
 
-  group_t *group = malloc(sizeof(group_t));
-  uint8_t *mul = malloc(num_syms * num_syms);
   quat *rots = malloc(num_syms * sizeof(quat));
 
   unsigned int index = 0;
@@ -174,62 +135,13 @@ quat *cube_puzzle_action_init(puzzle_action_t *action)
     for (unsigned int j = 0; j < 4; j++) {
       unsigned int s = j | ((sign ^ (__builtin_popcount(j) & 1)) << 2);
 
-      cube_mul_table(&mul[index * num_syms], perm, s);
-
-      /* printf("[%u %u %u] %01x\n", perm[0], perm[1], perm[2], s); */
-      /* printf("perm: (%f, %f, %f, %f)\n", q0[0], q0[1], q0[2], q0[3]); */
-
       memcpy(rots[index], q0, sizeof(quat));
       quat_cube_sym(rots[index], s);
       index++;
     }
   }
 
-  group_from_table(group, num_syms, mul);
-
-  unsigned int orbit_size[3] = { 8, 12, 6 };
-  unsigned int stab_gen[3] = { 12, 5, 4 };
-
-  uint8_t *stab[3];
-  uint8_t *orbit[3];
-
-  for (unsigned int k = 0; k < 3; k++) {
-    orbit[k] = malloc(orbit_size[k]);
-    stab[k] = malloc(num_syms / orbit_size[k]);
-    group_cyclic_subgroup(group, stab[k],
-                          num_syms / orbit_size[k],
-                          stab_gen[k]);
-  }
-
-  /* vertices */
-  for (unsigned int v = 0; v < 8; v++) {
-    unsigned int p = __builtin_popcount(v) & 1;
-    unsigned int s = (v & 1) | ((v >> p)& 2);
-    orbit[0][v] = (p << 2) | s;
-  }
-
-  /* edges */
-  for (unsigned int e = 0; e < 12; e++) {
-    unsigned int a = e >> 2;
-    unsigned int p = a & 1;
-    unsigned int s = ((e & 1) << p) | ((e & 2) >> p);
-    s = ((s & 1) << 1) | ((__builtin_popcount(s) & 1) ^ p);
-    orbit[1][e] = (a << 3) | s;
-  }
-
-  /* faces */
-  for (unsigned int f = 0; f < 6; f++) {
-    uint8_t sign = (f >> 1) & 1;
-    unsigned int s = f & 1;
-    orbit[2][f] = ((f & ~1) << 2) | s;
-  }
-
-  puzzle_action_init(action, 3, orbit_size, group, orbit, stab);
-
-  for (unsigned int k = 0; k < 3; k++) {
-    free(stab[k]);
-    free(orbit[k]);
-  }
+  cube_action_init(action);
 
   return rots;
 }
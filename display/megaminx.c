@@ -150,109 +150,6 @@ quat *megaminx_rotations(poly_t *dodec)
   return rots;
 }
 
-static void dodecahedron_group_init(group_t *group, abs_poly_t *dodec, poly_data_t *data)
-{
-  static const unsigned int num = 60;
-  uint8_t *mul = malloc(num * num);
-
-  for (unsigned int s = 0; s < num; s++) {
-    uint8_t *table = &mul[num * s];
-
-    unsigned int f0 = s / 5;
-    unsigned int vi = s % 5;
-
-    for (unsigned int j = 0; j < 5; j++) {
-      table[j] = f0 * 5 + (vi + j) % 5;
-      table[5 + j] = (f0 ^ 1) * 5 + (5 - vi + j) % 5;
-    }
-
-    int vi0 = data->adj[f0 * dodec->num_vertices + data->first_vertex[f0]];
-    assert(vi0 != -1);
-    for (unsigned int i = 0; i < 5; i++) {
-      unsigned int v = dodec->faces[f0].vertices[(vi0 + vi + i) % 5];
-      unsigned int w = dodec->faces[f0].vertices[(vi0 + vi + i + 1) % 5];
-      unsigned int f1 = data->edges[w * dodec->num_vertices + v];
-
-      int wi0 = data->adj[f1 * dodec->num_vertices + data->first_vertex[f1]];
-      assert(wi0 != -1);
-      int wi = data->adj[f1 * dodec->num_vertices + w];
-      assert(wi != -1);
-
-      for (unsigned int j = 0; j < 5; j++) {
-        table[10 * i + 10 + j] = f1 * 5 + (wi - wi0 + j + 5) % 5;
-        table[10 * i + 15 + j] = (f1 ^ 1) * 5 + (wi0 - wi + j + 5) % 5;
-      }
-    }
-  }
-
-  group_from_table(group, num, mul);
-}
-
-void megaminx_puzzle_action_init(puzzle_action_t *puzzle, abs_poly_t *dodec, poly_data_t *data)
-{
-  const unsigned int num_syms = 60;
-  unsigned int orbit_size[] = { 20, 30, 12 };
-  unsigned int stab_gen[] = { 50, 10, 1};
-
-  group_t *group = malloc(sizeof(group_t));
-  dodecahedron_group_init(group, dodec, data);
-
-  uint8_t *orbit[3];
-  uint8_t *stab[3];
-
-  for (unsigned int k = 0; k < 3; k++) {
-    orbit[k] = malloc(orbit_size[k]);
-    memset(orbit[k], num_syms, orbit_size[k]);
-
-    stab[k] = malloc(num_syms / orbit_size[k]);
-    group_cyclic_subgroup(group, stab[k],
-                          num_syms / orbit_size[k],
-                          stab_gen[k]);
-  }
-
-  /* faces */
-  for (unsigned int i = 0; i < orbit_size[2]; i++) {
-    orbit[2][i] = i * 5;
-  }
-
-  /* vertices */
-  {
-    for (unsigned int j = 0; j < orbit_size[2]; j++) {
-      unsigned int n = dodec->faces[j].num_vertices;
-      for (unsigned int i = 0; i < n; i++) {
-        unsigned int v = dodec->faces[j].vertices[i];
-        unsigned int f = j;
-        if (orbit[0][v] != num_syms) continue;
-        int i0 = data->adj[f * dodec->num_vertices + data->first_vertex[f]];
-        assert(i0 != -1);
-        unsigned int s = f * 5 + (i - i0 + 5) % 5;
-        orbit[0][v] = s;
-      }
-    }
-  }
-
-  /* edges */
-  {
-    unsigned int index = 0;
-    for (unsigned int f = 0; f < dodec->num_faces; f++) {
-      unsigned int n = dodec->faces[f].num_vertices;
-      int vi0 = data->adj[f * dodec->num_vertices + data->first_vertex[f]];
-      for (unsigned int i = 0; i < n; i++) {
-        unsigned int f1 = abs_poly_get_adj_face(dodec, f, i, data->edges);
-        if (f1 < f) continue;
-        orbit[1][data->edges_by_face[f][i]] = f * 5 + (i - vi0 + 5) % 5;
-      }
-    }
-  }
-
-  puzzle_action_init(puzzle, 3, orbit_size, group, orbit, stab);
-
-  for (unsigned int k = 0; k < 3; k++) {
-    free(stab[k]);
-    free(orbit[k]);
-  }
-}
-
 int *megaminx_model_init_piece(void *data, poly_t *poly,
                                unsigned int k, void *orbit)
 {
@@ -335,7 +232,7 @@ puzzle_scene_t *megaminx_scene_new(scene_t *scene)
 
   poly_data_t poly_data;
   poly_data_init(&poly_data, &dodec->abs);
-  megaminx_puzzle_action_init(action, &dodec->abs, &poly_data);
+  megaminx_action_init(action, &dodec->abs, &poly_data);
   poly_data_cleanup(&poly_data);
 
   uint8_t *conf = megaminx_new(action);
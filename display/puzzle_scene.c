@@ -52,9 +52,10 @@ void puzzle_scene_move_face(puzzle_scene_t *s, void *data_)
 
   unsigned int layer = data->layer >= 0 ?
     (unsigned int) data->layer : s->count;
-  turn_t *turn = s->puzzle->move(s->puzzle->move_data, s->conf,
-                                 data->face, layer, data->count);
-  if (!turn) return;
+  turn_t *turn = s->turn;
+  if (!s->puzzle->apply(s->puzzle->move_data, s->conf,
+                        data->face, layer, data->count, turn))
+    return;
 
   const unsigned int num_orbits = s->model->decomp->num_orbits;
   unsigned int *num_pieces = malloc(num_orbits * sizeof(unsigned int));
@@ -75,7 +76,7 @@ void puzzle_scene_rotate(puzzle_scene_t *s, void *data_)
   unsigned int sym = *data;
 
   for (unsigned int i = 0; i < s->model->decomp->num_pieces; i++) {
-    s->conf[i] = group_mul(s->puzzle->group, s->conf[i], sym);
+    s->conf[i] = group_table_mul(s->puzzle->group->table, s->conf[i], sym);
   }
 
   for (unsigned int k = 0; k < s->model->decomp->num_orbits; k++) {
@@ -85,7 +86,7 @@ void puzzle_scene_rotate(puzzle_scene_t *s, void *data_)
 
 void puzzle_scene_scramble(puzzle_scene_t *s, void *data)
 {
-  s->puzzle->scramble(s->puzzle->scramble_data, s->conf);
+  s->puzzle->scramble(s->puzzle->scramble_data, s->conf, rng_default());
   for (unsigned int k = 0; k < s->model->decomp->num_orbits; k++) {
     piece_set_conf(&s->piece[k], s->conf + s->model->decomp->orbit_offset[k]);
   }
@@ -102,6 +103,7 @@ void puzzle_scene_init(puzzle_scene_t *s,
   s->puzzle = puzzle;
   s->model = model;
   s->conf = conf;
+  s->turn = turn_new(puzzle->decomp->num_pieces);
   s->key_bindings = calloc(256, sizeof(key_action_t));
 
   for (unsigned int i = 0; i < model->decomp->num_orbits; i++) {
@@ -171,6 +173,7 @@ void puzzle_scene_cleanup(puzzle_scene_t *s)
     free(s->key_bindings[i].data);
   }
   free(s->key_bindings);
+  turn_del(s->turn);
   s->puzzle->cleanup(s->puzzle->cleanup_data, s->puzzle);
   s->model->cleanup(s->model->cleanup_data, s->model);
 }
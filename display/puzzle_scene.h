@@ -23,6 +23,9 @@ typedef struct poly_t poly_t;
 struct piece_t;
 typedef struct piece_t piece_t;
 
+struct turn_t;
+typedef struct turn_t turn_t;
+
 struct key_action_t
 {
   void (*run)(puzzle_scene_t *s, void *data);
@@ -65,6 +68,9 @@ struct puzzle_scene_t
   puzzle_t *puzzle;
   puzzle_model_t *model;
 
+  /* buffer for the last move */
+  turn_t *turn;
+
   unsigned int count;
 };
 
@@ -0,0 +1,198 @@
+#include "bfs.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "notation.h"
+#include "puzzle.h"
+
+struct bfs_level_t
+{
+  bfs_t *bfs;
+  uint64_t *visited;
+  uint64_t *cur;
+  uint64_t *next;
+  uint64_t num_words;
+  int backward;
+
+  uint64_t chunk;
+  uint64_t count;
+};
+
+#define BFS_CHUNK 256
+
+static inline int bitset_get(uint64_t *set, uint64_t i)
+{
+  return (__atomic_load_n(&set[i / 64], __ATOMIC_RELAXED) >> (i % 64)) & 1;
+}
+
+/* Set bit i, and return whether it was clear. */
+static inline int bitset_claim(uint64_t *set, uint64_t i)
+{
+  uint64_t bit = 1ull << (i % 64);
+  if (__atomic_load_n(&set[i / 64], __ATOMIC_RELAXED) & bit) return 0;
+  return !(__atomic_fetch_or(&set[i / 64], bit, __ATOMIC_RELAXED) & bit);
+}
+
+/* index of the configuration after move m from conf, using next as
+   scratch space, or num_states if the move is not possible */
+static inline uint64_t bfs_neighbour(bfs_t *bfs, uint8_t *conf,
+                                     uint8_t *next, unsigned int m)
+{
+  memcpy(next, conf, bfs->puzzle->decomp->num_pieces);
+  if (!move_op_apply(bfs->puzzle, next, &bfs->moves->ops[m])) {
+    return bfs->num_states;
+  }
+  return bfs->index(bfs->data, next);
+}
+
+static void *bfs_level_run(void *data)
+{
+  struct bfs_level_t *level = data;
+  bfs_t *bfs = level->bfs;
+  unsigned int num_pieces = bfs->puzzle->decomp->num_pieces;
+  uint8_t *conf = malloc(2 * num_pieces);
+  uint8_t *next = conf + num_pieces;
+  uint64_t count = 0;
+
+  while (1) {
+    uint64_t c = __atomic_fetch_add(&level->chunk, 1, __ATOMIC_RELAXED);
+    uint64_t start = c * BFS_CHUNK;
+    if (start >= level->num_words) break;
+    uint64_t end = start + BFS_CHUNK;
+    if (end > level->num_words) end = level->num_words;
+
+    for (uint64_t w = start; w < end; w++) {
+      if (level->backward) {
+        /* words of this chunk are only written by this thread */
+        uint64_t bits = ~level->visited[w];
+        if (w == level->num_words - 1 && bfs->num_states % 64) {
+          bits &= (1ull << (bfs->num_states % 64)) - 1;
+        }
+        for (; bits; bits &= bits - 1) {
+          uint64_t i = w * 64 + __builtin_ctzll(bits);
+          bfs->conf(bfs->data, conf, i);
+          for (unsigned int m = 0; m < bfs->moves->num; m++) {
+            uint64_t j = bfs_neighbour(bfs, conf, next, m);
+            if (j == bfs->num_states || !bitset_get(level->cur, j)) continue;
+            level->visited[w] |= 1ull << (i % 64);
+            level->next[w] |= 1ull << (i % 64);
+            count++;
+            break;
+          }
+        }
+      }
+      else {
+        for (uint64_t bits = level->cur[w]; bits; bits &= bits - 1) {
+          uint64_t i = w * 64 + __builtin_ctzll(bits);
+          bfs->conf(bfs->data, conf, i);
+          for (unsigned int m = 0; m < bfs->moves->num; m++) {
+            uint64_t j = bfs_neighbour(bfs, conf, next, m);
+            if (j == bfs->num_states || !bitset_claim(level->visited, j))
+              continue;
+            __atomic_fetch_or(&level->next[j / 64], 1ull << (j % 64),
+                              __ATOMIC_RELAXED);
+            count++;
+          }
+        }
+      }
+    }
+  }
+
+  free(conf);
+  __atomic_fetch_add(&level->count, count, __ATOMIC_RELAXED);
+  return 0;
+}
+
+void bfs_init(bfs_t *bfs, puzzle_t *puzzle, move_seq_t *moves,
+              uint64_t num_states, bfs_index_t index, bfs_conf_t conf,
+              void *data)
+{
+  bfs->puzzle = puzzle;
+  bfs->moves = moves;
+  bfs->num_states = num_states;
+  bfs->index = index;
+  bfs->conf = conf;
+  bfs->data = data;
+
+  bfs->max_depth = 0;
+  memset(bfs->num_by_depth, 0, sizeof(bfs->num_by_depth));
+  bfs->num_antipodes = 0;
+  bfs->antipodes = 0;
+}
+
+void bfs_cleanup(bfs_t *bfs)
+{
+  free(bfs->antipodes);
+}
+
+uint64_t bfs_run(bfs_t *bfs, uint8_t *conf, unsigned int num_threads)
+{
+  if (num_threads == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = n > 0 ? n : 1;
+  }
+
+  uint64_t num_words = (bfs->num_states + 63) / 64;
+  uint64_t *visited = calloc(num_words, sizeof(uint64_t));
+  uint64_t *cur = calloc(num_words, sizeof(uint64_t));
+  uint64_t *next = calloc(num_words, sizeof(uint64_t));
+  pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+
+  memset(bfs->num_by_depth, 0, sizeof(bfs->num_by_depth));
+  uint64_t s = bfs->index(bfs->data, conf);
+  visited[s / 64] |= 1ull << (s % 64);
+  cur[s / 64] |= 1ull << (s % 64);
+  bfs->num_by_depth[0] = 1;
+  bfs->max_depth = 0;
+
+  uint64_t num_left = bfs->num_states - 1;
+  for (unsigned int d = 0; d + 1 < BFS_MAX_DEPTH && num_left; d++) {
+    struct bfs_level_t level = {
+      .bfs = bfs,
+      .visited = visited,
+      .cur = cur,
+      .next = next,
+      .num_words = num_words,
+      .backward = num_left < bfs->num_by_depth[d],
+    };
+
+    for (unsigned int k = 1; k < num_threads; k++) {
+      pthread_create(&threads[k], 0, bfs_level_run, &level);
+    }
+    bfs_level_run(&level);
+    for (unsigned int k = 1; k < num_threads; k++) {
+      pthread_join(threads[k], 0);
+    }
+
+    if (level.count == 0) break;
+    bfs->num_by_depth[d + 1] = level.count;
+    bfs->max_depth = d + 1;
+    num_left -= level.count;
+
+    uint64_t *tmp = cur;
+    cur = next;
+    next = tmp;
+    memset(next, 0, num_words * sizeof(uint64_t));
+  }
+
+  /* the current level is the last one */
+  bfs->num_antipodes = bfs->num_by_depth[bfs->max_depth];
+  bfs->antipodes = realloc(bfs->antipodes,
+                           bfs->num_antipodes * sizeof(uint64_t));
+  uint64_t n = 0;
+  for (uint64_t w = 0; w < num_words; w++) {
+    for (uint64_t bits = cur[w]; bits; bits &= bits - 1) {
+      bfs->antipodes[n++] = w * 64 + __builtin_ctzll(bits);
+    }
+  }
+
+  free(threads);
+  free(visited);
+  free(cur);
+  free(next);
+
+  return bfs->num_states - num_left;
+}
@@ -0,0 +1,66 @@
+#ifndef BFS_H
+#define BFS_H
+
+#include <stdint.h>
+
+struct puzzle_t;
+typedef struct puzzle_t puzzle_t;
+
+struct move_seq_t;
+typedef struct move_seq_t move_seq_t;
+
+/* Breadth-first enumeration of the configurations of a puzzle.
+
+Configurations are given by an index, which must map the
+configurations reachable from the start one-to-one onto [0,
+num_states), and by its inverse. The moves are the ops of a move
+sequence, applied by the apply callback of the puzzle, and must
+include the inverse of every move.
+
+The visited configurations, the current level and the next one are
+bitsets. Threads take chunks of words of the current level, and claim
+neighbours with atomic bit operations, so that every configuration is
+counted once. Once fewer configurations are left than there are in
+the current level, levels are found backwards instead: every
+configuration not visited yet is checked for a neighbour in the
+current level, and only written by the thread owning its word. */
+
+#define BFS_MAX_DEPTH 64
+
+typedef uint64_t (*bfs_index_t)(void *data, uint8_t *conf);
+typedef void (*bfs_conf_t)(void *data, uint8_t *conf, uint64_t i);
+
+struct bfs_t
+{
+  puzzle_t *puzzle;
+  move_seq_t *moves;
+
+  uint64_t num_states;
+  bfs_index_t index;
+  bfs_conf_t conf;
+  void *data;
+
+  /* number of configurations at every distance from the start */
+  unsigned int max_depth;
+  uint64_t num_by_depth[BFS_MAX_DEPTH];
+
+  /* indices of the configurations at distance max_depth, in
+     increasing order */
+  uint64_t num_antipodes;
+  uint64_t *antipodes;
+};
+typedef struct bfs_t bfs_t;
+
+/* Enumerate configurations of puzzle with the moves of seq, which is
+   not copied. */
+void bfs_init(bfs_t *bfs, puzzle_t *puzzle, move_seq_t *moves,
+              uint64_t num_states, bfs_index_t index, bfs_conf_t conf,
+              void *data);
+void bfs_cleanup(bfs_t *bfs);
+
+/* Visit all the configurations reachable from conf using num_threads
+   threads, or one per processor if it is 0, and fill the histogram
+   and the antipodes. Return the number of configurations visited. */
+uint64_t bfs_run(bfs_t *bfs, uint8_t *conf, unsigned int num_threads);
+
+#endif /* BFS_H */
@@ -0,0 +1,197 @@
+#include "conf.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "group.h"
+#include "puzzle.h"
+
+void conf_space_init(conf_space_t *space,
+                     puzzle_action_t *action, decomp_t *decomp,
+                     unsigned int *dim)
+{
+  unsigned int num = action->table.num;
+
+  space->action = action;
+  space->decomp = decomp;
+  space->pos = malloc(decomp->num_orbits * num);
+  space->rep = malloc(decomp->num_orbits * sizeof(uint8_t *));
+
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int d = dim ? dim[k] : k;
+    unsigned int size = decomp->orbit_size[k];
+
+    /* the positions of orbit k are the cosets of the stabiliser of
+       the representative of orbit d, or the symmetries themselves */
+    assert(size == action->decomp.orbit_size[d] || size == num);
+
+    space->rep[k] = action->by_stab[d];
+    for (unsigned int g = 0; g < num; g++) {
+      space->pos[k * num + g] = size ? action->inv_by_stab[d][g] % size : 0;
+    }
+  }
+}
+
+void conf_space_cleanup(conf_space_t *space)
+{
+  free(space->pos);
+  free(space->rep);
+}
+
+/* position x of orbit k acted on by g */
+static inline unsigned int conf_act(conf_space_t *space, unsigned int k,
+                                    unsigned int x, unsigned int g)
+{
+  group_table_t *table = &space->action->table;
+  unsigned int h = group_table_mul(table, space->rep[k][x], g);
+  return space->pos[k * table->num + h];
+}
+
+void conf_compose(conf_space_t *space, uint8_t *r, uint8_t *a, uint8_t *b)
+{
+  group_table_t *table = &space->action->table;
+  decomp_t *decomp = space->decomp;
+
+  assert(r != a && r != b);
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int offset = decomp->orbit_offset[k];
+    for (unsigned int x = 0; x < decomp->orbit_size[k]; x++) {
+      unsigned int g = a[offset + x];
+      unsigned int y = conf_act(space, k, x, g);
+      r[offset + x] = group_table_mul(table, g, b[offset + y]);
+    }
+  }
+}
+
+void conf_invert(conf_space_t *space, uint8_t *r, uint8_t *a)
+{
+  group_table_t *table = &space->action->table;
+  decomp_t *decomp = space->decomp;
+
+  /* a'(x a(x)) = a(x)' */
+  assert(r != a);
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int offset = decomp->orbit_offset[k];
+    for (unsigned int x = 0; x < decomp->orbit_size[k]; x++) {
+      unsigned int g = a[offset + x];
+      unsigned int y = conf_act(space, k, x, g);
+      r[offset + y] = group_table_inv(table, g);
+    }
+  }
+}
+
+void conf_pow(conf_space_t *space, uint8_t *r, uint8_t *a, long n)
+{
+  unsigned int num_pieces = space->decomp->num_pieces;
+  uint8_t *base = malloc(num_pieces);
+  uint8_t *tmp = malloc(num_pieces);
+
+  if (n < 0) {
+    conf_invert(space, base, a);
+    n = -n;
+  } else {
+    memcpy(base, a, num_pieces);
+  }
+
+  /* square and multiply, using the fact that powers of a commute */
+  memset(r, 0, num_pieces);
+  while (n) {
+    if (n & 1) {
+      conf_compose(space, tmp, r, base);
+      memcpy(r, tmp, num_pieces);
+    }
+    n >>= 1;
+    if (n) {
+      conf_compose(space, tmp, base, base);
+      memcpy(base, tmp, num_pieces);
+    }
+  }
+
+  free(base);
+  free(tmp);
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+  while (b) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+uint64_t conf_order(conf_space_t *space, uint8_t *a)
+{
+  group_table_t *table = &space->action->table;
+  decomp_t *decomp = space->decomp;
+  uint8_t *visited = calloc(decomp->num_pieces, 1);
+  uint64_t order = 1;
+
+  /* The positions x a(x) form a permutation of every orbit. If x is
+     in a cycle of length len, a^len(x) is the product t of a along
+     the cycle, and fixes x. Then a^n(x) is trivial exactly when n is
+     a multiple of len times the order of t. */
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int offset = decomp->orbit_offset[k];
+    for (unsigned int x = 0; x < decomp->orbit_size[k]; x++) {
+      if (visited[offset + x]) continue;
+
+      unsigned int len = 0;
+      unsigned int t = 0;
+      unsigned int y = x;
+      do {
+        visited[offset + y] = 1;
+        unsigned int g = a[offset + y];
+        t = group_table_mul(table, t, g);
+        y = conf_act(space, k, y, g);
+        len++;
+      } while (y != x);
+
+      uint64_t m = (uint64_t) len * group_table_order(table, t);
+      m /= gcd(order, m);
+      if (order > UINT64_MAX / m) {
+        free(visited);
+        return 0;
+      }
+      order *= m;
+    }
+  }
+
+  free(visited);
+  return order;
+}
+
+void conf_apply(conf_space_t *space, uint8_t *u1, uint8_t *u, uint8_t *a)
+{
+  group_table_t *table = &space->action->table;
+  decomp_t *decomp = space->decomp;
+  unsigned int num = table->num;
+
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int offset = decomp->orbit_offset[k];
+    uint8_t *pos = &space->pos[k * num];
+    for (unsigned int x = 0; x < decomp->orbit_size[k]; x++) {
+      unsigned int g = u[offset + x];
+      u1[offset + x] = group_table_mul(table, g, a[offset + pos[g]]);
+    }
+  }
+}
+
+void conf_relative(conf_space_t *space, uint8_t *a, uint8_t *u, uint8_t *u1)
+{
+  group_table_t *table = &space->action->table;
+  decomp_t *decomp = space->decomp;
+  unsigned int num = table->num;
+
+  /* a(0 u(x)) = u(x)' u1(x) */
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int offset = decomp->orbit_offset[k];
+    uint8_t *pos = &space->pos[k * num];
+    for (unsigned int x = 0; x < decomp->orbit_size[k]; x++) {
+      unsigned int g = u[offset + x];
+      a[offset + pos[g]] = group_table_inv_mul(table, g, u1[offset + x]);
+    }
+  }
+}
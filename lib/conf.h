@@ -0,0 +1,74 @@
+#ifndef CONF_H
+#define CONF_H
+
+#include <stdint.h>
+
+struct puzzle_action_t;
+typedef struct puzzle_action_t puzzle_action_t;
+
+struct decomp_t;
+typedef struct decomp_t decomp_t;
+
+/* Relative configurations (see the Note in cube.c).
+
+A relative configuration assigns a symmetry to every position, and the
+positions of an orbit are numbered like its pieces, so that piece x
+of a solved puzzle is in position x. Positions are acted on by
+symmetries, and relative configurations compose as follows:
+
+  (ab)(x) = a(x) b(x a(x)).
+
+An absolute configuration u, i.e. the usual configuration of a puzzle,
+is acted on by a relative configuration a as follows:
+
+  (ua)(x) = u(x) a(0 u(x)),
+
+where 0 u(x) is the position of piece x. Moves are relative
+configurations, so a sequence of moves can be composed once, and then
+applied to any number of configurations. */
+
+struct conf_space_t
+{
+  puzzle_action_t *action;
+  decomp_t *decomp;
+
+  /* position of a piece of orbit k with symmetry g, at index
+     k * |G| + g */
+  uint8_t *pos;
+
+  /* for every orbit, a symmetry mapping position 0 to each position */
+  uint8_t **rep;
+};
+typedef struct conf_space_t conf_space_t;
+
+/* Orbit k of decomp has the positions of orbit dim[k] of the action,
+   or all the symmetries when its size is that of the group. When dim
+   is null, decomp is the decomposition of the action itself. */
+void conf_space_init(conf_space_t *space,
+                     puzzle_action_t *action, decomp_t *decomp,
+                     unsigned int *dim);
+void conf_space_cleanup(conf_space_t *space);
+
+/* All functions below take configurations of decomp->num_pieces
+   symmetries. Only conf_pow and conf_apply can store their result in
+   one of their arguments. */
+
+/* r = a b */
+void conf_compose(conf_space_t *space, uint8_t *r, uint8_t *a, uint8_t *b);
+
+/* r = a' */
+void conf_invert(conf_space_t *space, uint8_t *r, uint8_t *a);
+
+/* r = a^n, where n can be negative */
+void conf_pow(conf_space_t *space, uint8_t *r, uint8_t *a, long n);
+
+/* order of a, or 0 if it does not fit in 64 bits */
+uint64_t conf_order(conf_space_t *space, uint8_t *a);
+
+/* absolute configuration u1 = u a */
+void conf_apply(conf_space_t *space, uint8_t *u1, uint8_t *u, uint8_t *a);
+
+/* relative configuration a such that u1 = u a */
+void conf_relative(conf_space_t *space, uint8_t *a, uint8_t *u, uint8_t *u1);
+
+#endif /* CONF_H */
@@ -0,0 +1,309 @@
+#include "conf_pack.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perm.h"
+#include "puzzle.h"
+
+void conf_packing_init(conf_packing_t *packing,
+                       puzzle_action_t *action, decomp_t *decomp,
+                       unsigned int *dim)
+{
+  unsigned int num = action->table.num;
+
+  packing->decomp = decomp;
+  packing->num_syms = num;
+  packing->orbits = malloc(decomp->num_orbits * sizeof(conf_pack_orbit_t));
+
+  /* at most one digit per piece for positions, and one for symmetries
+     or orientations */
+  packing->radix = malloc(2 * decomp->num_pieces + 1);
+  unsigned int num_digits = 0;
+
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    conf_pack_orbit_t *orbit = &packing->orbits[k];
+    unsigned int d = dim ? dim[k] : k;
+    orbit->size = decomp->orbit_size[k];
+
+    if (d < action->decomp.num_orbits &&
+        orbit->size == action->decomp.orbit_size[d]) {
+      orbit->num_positions = orbit->size;
+    }
+    else if (d < action->decomp.num_orbits && orbit->size == num) {
+      orbit->num_positions = num;
+    }
+    else {
+      orbit->num_positions = 0;
+    }
+
+    if (orbit->num_positions == 0) {
+      orbit->num_orientations = num;
+      orbit->pos = orbit->ori = orbit->sym = 0;
+      for (unsigned int i = 0; i < orbit->size; i++) {
+        packing->radix[num_digits++] = num;
+      }
+      continue;
+    }
+
+    assert(orbit->num_positions <= 64);
+    orbit->num_orientations = num / orbit->num_positions;
+    orbit->pos = malloc(num);
+    orbit->ori = malloc(num);
+    orbit->sym = malloc(num);
+    for (unsigned int g = 0; g < num; g++) {
+      unsigned int j = action->inv_by_stab[d][g];
+      orbit->pos[g] = j % orbit->num_positions;
+      orbit->ori[g] = j / orbit->num_positions;
+      orbit->sym[j] = g;
+    }
+
+    /* the last digit of a Lehmer code is always 0 */
+    for (unsigned int i = 0; i + 1 < orbit->size; i++) {
+      packing->radix[num_digits++] = orbit->size - i;
+    }
+    if (orbit->num_orientations > 1) {
+      for (unsigned int i = 0; i < orbit->size; i++) {
+        packing->radix[num_digits++] = orbit->num_orientations;
+      }
+    }
+  }
+  packing->num_digits = num_digits;
+
+  /* split digits into chunks whose range fits in 64 bits */
+  packing->chunk_digits = malloc(num_digits + 1);
+  packing->chunk_bits = malloc(num_digits + 1);
+  packing->num_chunks = 0;
+  size_t total_bits = 0;
+  unsigned int i = 0;
+  while (i < num_digits) {
+    uint64_t range = 1;
+    unsigned int n = 0;
+    while (i < num_digits && range <= UINT64_MAX / packing->radix[i]) {
+      range *= packing->radix[i++];
+      n++;
+    }
+
+    unsigned int bits = 0;
+    while (bits < 64 && (range - 1) >> bits) bits++;
+
+    packing->chunk_digits[packing->num_chunks] = n;
+    packing->chunk_bits[packing->num_chunks] = bits;
+    packing->num_chunks++;
+    total_bits += bits;
+  }
+
+  packing->size = (total_bits + 7) / 8;
+}
+
+void conf_packing_cleanup(conf_packing_t *packing)
+{
+  for (unsigned int k = 0; k < packing->decomp->num_orbits; k++) {
+    free(packing->orbits[k].pos);
+    free(packing->orbits[k].ori);
+    free(packing->orbits[k].sym);
+  }
+  free(packing->orbits);
+  free(packing->radix);
+  free(packing->chunk_digits);
+  free(packing->chunk_bits);
+}
+
+/* Digits are accumulated into chunks, which are written as a little
+   endian stream of bits. */
+struct pack_writer_t
+{
+  conf_packing_t *packing;
+  uint8_t *out;
+  uint64_t acc;
+  unsigned int num_bits;
+
+  unsigned int digit;
+  unsigned int chunk;
+  unsigned int chunk_digit;
+  uint64_t value;
+};
+
+static void write_bits(struct pack_writer_t *w, uint64_t value,
+                       unsigned int bits)
+{
+  while (bits) {
+    unsigned int b = bits > 32 ? 32 : bits;
+    w->acc |= (value & ((1ull << b) - 1)) << w->num_bits;
+    w->num_bits += b;
+    value >>= b;
+    bits -= b;
+    while (w->num_bits >= 8) {
+      *w->out++ = w->acc;
+      w->acc >>= 8;
+      w->num_bits -= 8;
+    }
+  }
+}
+
+static void write_digit(struct pack_writer_t *w, unsigned int x)
+{
+  conf_packing_t *packing = w->packing;
+  w->value = w->value * packing->radix[w->digit++] + x;
+  if (++w->chunk_digit == packing->chunk_digits[w->chunk]) {
+    write_bits(w, w->value, packing->chunk_bits[w->chunk]);
+    w->chunk++;
+    w->chunk_digit = 0;
+    w->value = 0;
+  }
+}
+
+int conf_pack(conf_packing_t *packing, uint8_t *packed, uint8_t *conf)
+{
+  decomp_t *decomp = packing->decomp;
+  struct pack_writer_t w = { .packing = packing, .out = packed };
+
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    conf_pack_orbit_t *orbit = &packing->orbits[k];
+    uint8_t *c = &conf[decomp->orbit_offset[k]];
+
+    if (orbit->num_positions == 0) {
+      for (unsigned int i = 0; i < orbit->size; i++) {
+        write_digit(&w, c[i]);
+      }
+      continue;
+    }
+
+    uint64_t visited = 0;
+    for (unsigned int i = 0; i < orbit->size; i++) {
+      unsigned int x = orbit->pos[c[i]];
+      if ((visited >> x) & 1) return 0;
+      if (i + 1 < orbit->size) {
+        write_digit(&w, __builtin_popcountll(~visited &
+                                             ((1ull << x) - 1)));
+      }
+      visited |= 1ull << x;
+    }
+    if (orbit->num_orientations > 1) {
+      for (unsigned int i = 0; i < orbit->size; i++) {
+        write_digit(&w, orbit->ori[c[i]]);
+      }
+    }
+  }
+
+  if (w.num_bits) *w.out++ = w.acc;
+  assert((size_t) (w.out - packed) == packing->size);
+  return 1;
+}
+
+struct pack_reader_t
+{
+  conf_packing_t *packing;
+  uint8_t *in;
+  uint64_t acc;
+  unsigned int num_bits;
+
+  unsigned int digit;
+  unsigned int chunk;
+  unsigned int chunk_digit;
+  /* digits of the current chunk */
+  uint8_t digits[64];
+};
+
+static uint64_t read_bits(struct pack_reader_t *r, unsigned int bits)
+{
+  uint64_t value = 0;
+  unsigned int shift = 0;
+  while (bits) {
+    unsigned int b = bits > 32 ? 32 : bits;
+    while (r->num_bits < b) {
+      r->acc |= (uint64_t) *r->in++ << r->num_bits;
+      r->num_bits += 8;
+    }
+    value |= (r->acc & ((1ull << b) - 1)) << shift;
+    r->acc >>= b;
+    r->num_bits -= b;
+    shift += b;
+    bits -= b;
+  }
+  return value;
+}
+
+static unsigned int read_digit(struct pack_reader_t *r)
+{
+  conf_packing_t *packing = r->packing;
+  unsigned int n = packing->chunk_digits[r->chunk];
+
+  if (r->chunk_digit == 0) {
+    uint64_t value = read_bits(r, packing->chunk_bits[r->chunk]);
+    for (unsigned int i = n; i-- > 0;) {
+      unsigned int radix = packing->radix[r->digit + i];
+      r->digits[i] = value % radix;
+      value /= radix;
+    }
+  }
+
+  unsigned int x = r->digits[r->chunk_digit];
+  r->digit++;
+  if (++r->chunk_digit == n) {
+    r->chunk++;
+    r->chunk_digit = 0;
+  }
+  return x;
+}
+
+void conf_unpack(conf_packing_t *packing, uint8_t *conf, uint8_t *packed)
+{
+  decomp_t *decomp = packing->decomp;
+  struct pack_reader_t r = { .packing = packing, .in = packed };
+
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    conf_pack_orbit_t *orbit = &packing->orbits[k];
+    uint8_t *c = &conf[decomp->orbit_offset[k]];
+
+    if (orbit->num_positions == 0) {
+      for (unsigned int i = 0; i < orbit->size; i++) {
+        c[i] = read_digit(&r);
+      }
+      continue;
+    }
+
+    uint8_t lehmer[64];
+    uint8_t pos[64];
+    for (unsigned int i = 0; i + 1 < orbit->size; i++) {
+      lehmer[i] = read_digit(&r);
+    }
+    lehmer[orbit->size - 1] = 0;
+    perm_from_lehmer(pos, lehmer, orbit->size);
+
+    for (unsigned int i = 0; i < orbit->size; i++) {
+      unsigned int o = orbit->num_orientations > 1 ? read_digit(&r) : 0;
+      c[i] = orbit->sym[o * orbit->num_positions + pos[i]];
+    }
+  }
+}
+
+static inline uint64_t hash_mix(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+uint64_t conf_hash(const uint8_t *data, size_t size)
+{
+  uint64_t h = 0x9e3779b97f4a7c15ull ^ size;
+
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t w;
+    memcpy(&w, data, 8);
+    h = (h ^ hash_mix(w)) * 0x9e3779b97f4a7c15ull;
+    h = (h << 27) | (h >> 37);
+  }
+  if (size) {
+    uint64_t w = 0;
+    memcpy(&w, data, size);
+    h = (h ^ hash_mix(w)) * 0x9e3779b97f4a7c15ull;
+  }
+
+  return hash_mix(h);
+}
@@ -0,0 +1,85 @@
+#ifndef CONF_PACK_H
+#define CONF_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct puzzle_action_t;
+typedef struct puzzle_action_t puzzle_action_t;
+
+struct decomp_t;
+typedef struct decomp_t decomp_t;
+
+/* Packed configurations.
+
+The pieces of an orbit whose size is the number of positions of an
+orbit of the action occupy every position exactly once. Their
+symmetries are then determined by the permutation of positions and the
+orientation of every piece, i.e. the index of its symmetry in the
+stabiliser coset of its position. The permutation is stored as its
+Lehmer code, and orientations as digits in base the size of the
+stabiliser. Other orbits, like those of the Square-1, store every
+symmetry as a digit in base |G|.
+
+Consecutive digits are accumulated in mixed radix into 64-bit chunks,
+and every chunk is written with the minimum number of bits for its
+range, so that the result is within a bit per chunk of the
+information-theoretic size. */
+
+struct conf_pack_orbit_t
+{
+  unsigned int size;
+
+  /* Number of positions and orientations. A number of positions of 0
+     means that symmetries are stored as they are. */
+  unsigned int num_positions;
+  unsigned int num_orientations;
+
+  /* position and orientation of a piece by symmetry */
+  uint8_t *pos;
+  uint8_t *ori;
+
+  /* symmetry by position and orientation, at index o * num_positions
+     + x */
+  uint8_t *sym;
+};
+typedef struct conf_pack_orbit_t conf_pack_orbit_t;
+
+struct conf_packing_t
+{
+  decomp_t *decomp;
+  unsigned int num_syms;
+  conf_pack_orbit_t *orbits;
+
+  /* radix of every digit */
+  unsigned int num_digits;
+  uint8_t *radix;
+
+  /* number of digits and bits of every chunk */
+  unsigned int num_chunks;
+  uint8_t *chunk_digits;
+  uint8_t *chunk_bits;
+
+  /* size of a packed configuration in bytes */
+  size_t size;
+};
+typedef struct conf_packing_t conf_packing_t;
+
+/* Orbit k of decomp has the positions of orbit dim[k] of the action,
+   or all the symmetries when its size is that of the group (see
+   conf_space_init). When dim is null, decomp is the decomposition of
+   the action itself. */
+void conf_packing_init(conf_packing_t *packing,
+                       puzzle_action_t *action, decomp_t *decomp,
+                       unsigned int *dim);
+void conf_packing_cleanup(conf_packing_t *packing);
+
+/* Pack conf into packing->size bytes, and back. conf_pack returns 0 if
+   conf cannot be packed, because some positions are occupied twice. */
+int conf_pack(conf_packing_t *packing, uint8_t *packed, uint8_t *conf);
+void conf_unpack(conf_packing_t *packing, uint8_t *conf, uint8_t *packed);
+
+/* 64-bit hash of size bytes, such as a packed configuration */
+uint64_t conf_hash(const uint8_t *data, size_t size);
+
+#endif /* CONF_PACK_H */
@@ -0,0 +1,300 @@
+#include "conf_sym.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conf.h"
+#include "group.h"
+#include "puzzle.h"
+
+/* The symmetries are computed in a group B containing G, which is
+   either G itself or the group of symmetries of a polyhedron. */
+struct sym_group_t
+{
+  group_table_t *table;
+  symmetries_t *poly_syms;
+  unsigned int num;
+
+  /* embedding of G into B, and its inverse on the rotations */
+  uint8_t *emb;
+  uint8_t *proj;
+};
+
+static unsigned int sym_mul(struct sym_group_t *b,
+                            unsigned int x, unsigned int y)
+{
+  if (!b->poly_syms) return group_table_mul(b->table, x, y);
+  return b->poly_syms->mul[x + y * b->num];
+}
+
+static unsigned int sym_inv(struct sym_group_t *b, unsigned int x)
+{
+  if (!b->poly_syms) return group_table_inv(b->table, x);
+  return b->poly_syms->inv_mul[x];
+}
+
+static int sym_is_reflection(struct sym_group_t *b, unsigned int x)
+{
+  return b->poly_syms && x >= b->poly_syms->num_rotations;
+}
+
+/* Find the rotation of the polyhedron acting on faces like every
+   element of G on orbit face_orbit. */
+static int sym_group_embed(struct sym_group_t *b, puzzle_action_t *action,
+                           unsigned int face_orbit)
+{
+  symmetries_t *poly_syms = b->poly_syms;
+  unsigned int num = action->table.num;
+  unsigned int nf = poly_syms->num_faces;
+
+  if (poly_syms->num_rotations != num ||
+      face_orbit >= action->decomp.num_orbits ||
+      action->decomp.orbit_size[face_orbit] != nf) return 0;
+
+  for (unsigned int g = 0; g < num; g++) {
+    unsigned int s;
+    for (s = 0; s < num; s++) {
+      unsigned int f;
+      for (f = 0; f < nf; f++) {
+        if (poly_syms->face_action[s * nf + f] !=
+            puzzle_action_local_act(action, face_orbit, f, g)) break;
+      }
+      if (f == nf) break;
+    }
+    if (s == num) return 0;
+    b->emb[g] = s;
+    b->proj[s] = g;
+  }
+
+  for (unsigned int g = 0; g < num; g++) {
+    for (unsigned int h = 0; h < num; h++) {
+      unsigned int gh = group_table_mul(&action->table, g, h);
+      if (b->emb[gh] != sym_mul(b, b->emb[g], b->emb[h])) return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* A reflection fixing the cell corresponding to the representative of
+   orbit d of the action, or 0 if there is none. */
+static unsigned int sym_group_mirror(struct sym_group_t *b,
+                                     puzzle_action_t *action,
+                                     unsigned int d)
+{
+  symmetries_t *poly_syms = b->poly_syms;
+  unsigned int size = action->decomp.orbit_size[d];
+  unsigned int stab_size = action->table.num / size;
+
+  for (unsigned int dim = 0; dim < 3; dim++) {
+    unsigned int num_cells = symmetries_num_cells(poly_syms, dim);
+    if (num_cells != size) continue;
+
+    for (unsigned int c = 0; c < num_cells; c++) {
+      unsigned int o;
+      for (o = 0; o < stab_size; o++) {
+        unsigned int u = b->emb[action->by_stab[d][o * size]];
+        if (symmetries_cell_act(poly_syms, dim, c, u) != c) break;
+      }
+      if (o < stab_size) continue;
+
+      for (unsigned int m = poly_syms->num_rotations;
+           m < poly_syms->num; m++) {
+        if (symmetries_cell_act(poly_syms, dim, c, m) == c) return m;
+      }
+    }
+  }
+
+  return 0;
+}
+
+int conf_syms_init(conf_syms_t *syms, conf_space_t *space,
+                   symmetries_t *poly_syms, unsigned int face_orbit,
+                   int inverse)
+{
+  puzzle_action_t *action = space->action;
+  decomp_t *decomp = space->decomp;
+  group_table_t *table = &action->table;
+  unsigned int num = table->num;
+
+  struct sym_group_t b;
+  b.table = table;
+  b.poly_syms = poly_syms;
+  b.num = poly_syms ? poly_syms->num : num;
+  b.emb = malloc(num);
+  b.proj = malloc(b.num);
+  for (unsigned int g = 0; g < num; g++) b.emb[g] = b.proj[g] = g;
+
+  /* orbit of the action and reflection of every orbit */
+  unsigned int *dim = malloc(decomp->num_orbits * sizeof(unsigned int));
+  unsigned int *mirror = calloc(decomp->num_orbits, sizeof(unsigned int));
+
+  int ok = !poly_syms || sym_group_embed(&b, action, face_orbit);
+  for (unsigned int k = 0; k < decomp->num_orbits && ok; k++) {
+    for (dim[k] = 0; dim[k] < action->decomp.num_orbits; dim[k]++) {
+      if (space->rep[k] == action->by_stab[dim[k]]) break;
+    }
+    assert(dim[k] < action->decomp.num_orbits);
+
+    if (b.num > num) {
+      if (decomp->orbit_size[k] != action->decomp.orbit_size[dim[k]]) ok = 0;
+      else if (!(mirror[k] = sym_group_mirror(&b, action, dim[k]))) ok = 0;
+    }
+  }
+
+  if (!ok) {
+    free(b.emb);
+    free(b.proj);
+    free(dim);
+    free(mirror);
+    return 0;
+  }
+
+  unsigned int n = decomp->num_pieces;
+  syms->space = space;
+  syms->num = b.num;
+  syms->inverse = inverse;
+  syms->src = malloc(b.num * n * sizeof(unsigned int));
+  syms->left = malloc(b.num * n);
+  syms->right = malloc(b.num * decomp->num_orbits * num);
+
+  for (unsigned int s = 0; s < b.num; s++) {
+    for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+      unsigned int size = decomp->orbit_size[k];
+      unsigned int offset = decomp->orbit_offset[k];
+      uint8_t *rep = space->rep[k];
+
+      /* m is the identity for rotations */
+      unsigned int m = sym_is_reflection(&b, s) ? mirror[k] : 0;
+      unsigned int m1 = sym_inv(&b, m);
+
+      for (unsigned int y = 0; y < size; y++) {
+        /* the frame of y, reflected back by s and m */
+        unsigned int w = sym_mul(&b, sym_mul(&b, m1, b.emb[rep[y]]),
+                                 sym_inv(&b, s));
+        assert(!sym_is_reflection(&b, w));
+        w = b.proj[w];
+        unsigned int x = space->pos[k * num + w];
+        unsigned int v = group_table_mul(table, w,
+                                         group_table_inv(table, rep[x]));
+        v = sym_mul(&b, sym_mul(&b, m, b.emb[v]), m1);
+
+        syms->src[s * n + offset + y] = offset + x;
+        syms->left[s * n + offset + y] = b.proj[v];
+      }
+
+      uint8_t *right = &syms->right[(s * decomp->num_orbits + k) * num];
+      unsigned int ms = sym_mul(&b, m, s);
+      for (unsigned int g = 0; g < num; g++) {
+        unsigned int h = sym_mul(&b, sym_mul(&b, m, b.emb[g]), m1);
+        right[g] = b.proj[sym_mul(&b, h, ms)];
+      }
+    }
+  }
+
+  free(b.emb);
+  free(b.proj);
+  free(dim);
+  free(mirror);
+  return 1;
+}
+
+void conf_syms_cleanup(conf_syms_t *syms)
+{
+  free(syms->src);
+  free(syms->left);
+  free(syms->right);
+}
+
+void conf_sym_apply(conf_syms_t *syms, uint8_t *r, uint8_t *conf,
+                    unsigned int s)
+{
+  decomp_t *decomp = syms->space->decomp;
+  group_table_t *table = &syms->space->action->table;
+  unsigned int n = decomp->num_pieces;
+  unsigned int *src = &syms->src[s * n];
+  uint8_t *left = &syms->left[s * n];
+
+  assert(r != conf);
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    uint8_t *right = &syms->right[(s * decomp->num_orbits + k) * table->num];
+    unsigned int end = decomp->orbit_offset[k + 1];
+    for (unsigned int y = decomp->orbit_offset[k]; y < end; y++) {
+      r[y] = group_table_mul(table, left[y], right[conf[src[y]]]);
+    }
+  }
+}
+
+void conf_sym_invert(conf_syms_t *syms, uint8_t *r, uint8_t *conf)
+{
+  conf_space_t *space = syms->space;
+  decomp_t *decomp = space->decomp;
+  group_table_t *table = &space->action->table;
+
+  /* u'(y) = by_stab(y) u(x)' by_stab(x), where y is the position of x */
+  assert(r != conf);
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    unsigned int offset = decomp->orbit_offset[k];
+    uint8_t *rep = space->rep[k];
+    for (unsigned int x = 0; x < decomp->orbit_size[k]; x++) {
+      unsigned int g = conf[offset + x];
+      unsigned int y = space->pos[k * table->num + g];
+      unsigned int h = group_table_inv_mul(table, g, rep[x]);
+      r[offset + y] = group_table_mul(table, rep[y], h);
+    }
+  }
+}
+
+/* Replace r with the image of conf by s if it is smaller. The image
+   is compared as it is computed, so that most symmetries are
+   discarded after a few pieces. */
+static int conf_sym_min(conf_syms_t *syms, uint8_t *r, uint8_t *conf,
+                        unsigned int s)
+{
+  decomp_t *decomp = syms->space->decomp;
+  group_table_t *table = &syms->space->action->table;
+  unsigned int n = decomp->num_pieces;
+  unsigned int *src = &syms->src[s * n];
+  uint8_t *left = &syms->left[s * n];
+  int less = 0;
+
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    uint8_t *right = &syms->right[(s * decomp->num_orbits + k) * table->num];
+    unsigned int end = decomp->orbit_offset[k + 1];
+    for (unsigned int y = decomp->orbit_offset[k]; y < end; y++) {
+      unsigned int v = group_table_mul(table, left[y], right[conf[src[y]]]);
+      if (!less) {
+        if (v > r[y]) return 0;
+        if (v < r[y]) less = 1;
+      }
+      r[y] = v;
+    }
+  }
+
+  return less;
+}
+
+unsigned int conf_canonical(conf_syms_t *syms, uint8_t *r, uint8_t *conf)
+{
+  unsigned int n = syms->space->decomp->num_pieces;
+  unsigned int best = 0;
+
+  assert(r != conf);
+  memcpy(r, conf, n);
+  for (unsigned int s = 1; s < syms->num; s++) {
+    if (conf_sym_min(syms, r, conf, s)) best = s;
+  }
+
+  if (syms->inverse) {
+    uint8_t buf[256];
+    uint8_t *inv = n <= sizeof(buf) ? buf : malloc(n);
+    conf_sym_invert(syms, inv, conf);
+    for (unsigned int s = 0; s < syms->num; s++) {
+      if (conf_sym_min(syms, r, inv, s)) best = syms->num + s;
+    }
+    if (inv != buf) free(inv);
+  }
+
+  return best;
+}
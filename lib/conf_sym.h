@@ -0,0 +1,88 @@
+#ifndef CONF_SYM_H
+#define CONF_SYM_H
+
+#include <stdint.h>
+
+struct conf_space_t;
+typedef struct conf_space_t conf_space_t;
+
+struct symmetries_t;
+typedef struct symmetries_t symmetries_t;
+
+/* Symmetric configurations.
+
+A configuration u is a map sending the frame u_0 by_stab(x) of piece x
+to u_0 u(x), for u_0 in the stabiliser of the representative of its
+orbit. Conjugating this map by a symmetry h of the whole puzzle gives
+another configuration, that of the puzzle after the same moves
+conjugated by h:
+
+  u^h(y) = by_stab(y) h' by_stab(x)' u(x) h,
+
+where x is the position of by_stab(y) h'. The solved configuration is
+fixed by conjugation, so a configuration and its conjugates are at the
+same distance from it.
+
+A mirror symmetry m is not in G, but conjugating by m works in the
+same way once u is extended to reflected frames, by choosing for every
+orbit a reflection m_0 fixing its representative, and letting u send
+m_0 f to m_0 u(f). This requires every orbit of pieces to correspond
+to the cells of some dimension of a polyhedron.
+
+The inverse of a configuration, i.e. the configuration reached by
+inverting its sequence of moves, is also at the same distance from the
+solved one, so the canonical representative of a configuration is
+chosen among all conjugates of the configuration and of its inverse.
+
+In all cases, the image of u is of the form:
+
+  v(y) = l(y) t_k(u(x)),
+
+where x only depends on y, and t_k is a map on G depending on the orbit
+k of y. */
+
+struct conf_syms_t
+{
+  conf_space_t *space;
+
+  /* Number of symmetries, i.e. rotations, followed by reflections if
+     any. Symmetry 0 is the identity. */
+  unsigned int num;
+
+  /* whether conf_canonical also considers the inverse */
+  int inverse;
+
+  /* for symmetry s and piece y, the piece x and the symmetry l(y) at
+     index s * num_pieces + y */
+  unsigned int *src;
+  uint8_t *left;
+
+  /* for symmetry s and orbit k, the map t_k at index (s * num_orbits
+     + k) * |G| */
+  uint8_t *right;
+};
+typedef struct conf_syms_t conf_syms_t;
+
+/* Symmetries of the configurations of space. When poly_syms is null,
+   they are the elements of G. Otherwise they are the symmetries of
+   the polyhedron, including reflections, whose faces are the
+   positions of orbit face_orbit of the action, in the same order. In
+   that case, return 0 if the configurations cannot be reflected. */
+int conf_syms_init(conf_syms_t *syms, conf_space_t *space,
+                   symmetries_t *poly_syms, unsigned int face_orbit,
+                   int inverse);
+void conf_syms_cleanup(conf_syms_t *syms);
+
+/* r = conf conjugated by symmetry s */
+void conf_sym_apply(conf_syms_t *syms, uint8_t *r, uint8_t *conf,
+                    unsigned int s);
+
+/* r = inverse of conf, which must be a permutation of every orbit */
+void conf_sym_invert(conf_syms_t *syms, uint8_t *r, uint8_t *conf);
+
+/* Set r to the lexicographically minimal image of conf. Return the
+   symmetry giving r, plus syms->num if it is applied to the inverse of
+   conf. */
+unsigned int conf_canonical(conf_syms_t *syms, uint8_t *r, uint8_t *conf);
+
+#endif /* CONF_SYM_H */
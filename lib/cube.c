@@ -3,8 +3,12 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "conf.h"
+#include "conf_pack.h"
 #include "group.h"
+#include "move_table.h"
 #include "puzzle.h"
 #include "utils.h"
 #include "perm.h"
@@ -25,74 +29,172 @@ configurations are a torsor over this group.
 Relative configurations compose as follows: (ab)(x) = a(x) b(x a(x)),
 where symmetries act on pieces on the right. The right action of a
 relative configuration a on absolute one u is: (ua)(x) = u(x) a(0
-u(x)).
+u(x)). These operations are implemented in conf.c.
 */
 
+static void cube_mul_table(uint8_t *table, uint8_t *perm1, unsigned int s1)
+{
+  unsigned int index = 0;
+  uint8_t perm2[3];
+  for (unsigned int p1 = 0; p1 < 6; p1++) {
+    perm_from_index(perm2, 3, p1, 3);
+    unsigned int sign = perm_sign(perm2, 3);
+
+    for (unsigned int j = 0; j < 4; j++) {
+      unsigned int s2 = j | ((sign ^ (__builtin_popcount(j) & 1)) << 2);
+
+      uint8_t perm[3];
+      perm_composed(perm, perm1, perm2, 3);
+
+      table[index++] = (perm_index(perm, 3, 3) << 2) |
+        ((s2 ^ u16_conj(s1, perm2, 3)) & 0x3);
+    }
+  }
+}
+
+void cube_action_init(puzzle_action_t *action)
+{
+  static const unsigned int num_syms = 24;
+
+  /* The group G' of symmetries of a cube is the wreath product G' of
+  Sigma_3 and O(1). G' acts linearly on the cube by permuting
+  coordinates and changing signs. Explicitly, a pair (sigma, u) of a
+  permutation and a choice of signs acts on the basis elements as
+  follows:
+
+    e_i (sigma, u) = u_i e_(sigma i).
+
+  The determinant of (sigma, u) is sign(sigma) * sum(u). We are
+  interested in the subgroup G of G' consisting of those elements that
+  have determinant 1.
+
+  They can be enumerated by enumerating the permutation sigma first,
+  then choosing all possible signs for the first two axes, and setting
+  the third sign to the only value that makes the determinant
+  positive.
+ */
+
+  group_t *group = malloc(sizeof(group_t));
+  uint8_t *mul = malloc(num_syms * num_syms);
+
+  unsigned int index = 0;
+  for (unsigned int p = 0; p < 6; p++) {
+    uint8_t lehmer[3];
+    uint8_t perm[3];
+
+    lehmer_from_index(lehmer, 3, p, 3);
+    perm_from_lehmer(perm, lehmer, 3);
+    uint8_t sign = lehmer_sign(lehmer, 3);
+
+    for (unsigned int j = 0; j < 4; j++) {
+      unsigned int s = j | ((sign ^ (__builtin_popcount(j) & 1)) << 2);
+      cube_mul_table(&mul[index * num_syms], perm, s);
+      index++;
+    }
+  }
+
+  group_from_table(group, num_syms, mul);
+
+  unsigned int orbit_size[3] = { 8, 12, 6 };
+  unsigned int stab_gen[3] = { 12, 5, 4 };
+
+  uint8_t *stab[3];
+  uint8_t *orbit[3];
+
+  for (unsigned int k = 0; k < 3; k++) {
+    orbit[k] = malloc(orbit_size[k]);
+    stab[k] = malloc(num_syms / orbit_size[k]);
+    group_cyclic_subgroup(group, stab[k],
+                          num_syms / orbit_size[k],
+                          stab_gen[k]);
+  }
+
+  /* vertices */
+  for (unsigned int v = 0; v < 8; v++) {
+    unsigned int p = __builtin_popcount(v) & 1;
+    unsigned int s = (v & 1) | ((v >> p)& 2);
+    orbit[0][v] = (p << 2) | s;
+  }
+
+  /* edges */
+  for (unsigned int e = 0; e < 12; e++) {
+    unsigned int a = e >> 2;
+    unsigned int p = a & 1;
+    unsigned int s = ((e & 1) << p) | ((e & 2) >> p);
+    s = ((s & 1) << 1) | ((__builtin_popcount(s) & 1) ^ p);
+    orbit[1][e] = (a << 3) | s;
+  }
+
+  /* faces */
+  for (unsigned int f = 0; f < 6; f++) {
+    uint8_t sign = (f >> 1) & 1;
+    unsigned int s = f & 1;
+    orbit[2][f] = ((f & ~1) << 2) | s;
+  }
+
+  puzzle_action_init(action, 3, orbit_size, group, orbit, stab);
+
+  for (unsigned int k = 0; k < 3; k++) {
+    free(stab[k]);
+    free(orbit[k]);
+  }
+}
+
 void cube_shape_init(cube_shape_t *shape, unsigned int n)
 {
   assert(n >= 1);
   shape->n = n;
 
   unsigned int num_corners = n > 1 ? 8 : 0;
-  unsigned int num_edges = 12 * (n - 2);
-  unsigned int num_centres = n > 1 ? 6 * (n - 2) * (n - 2) : 1;
-  shape->decomp.num_pieces = num_corners + num_edges + num_centres;
 
   unsigned int num_corner_orbits = num_corners != 0;
   unsigned int num_edge_orbits = (n - 1) / 2;
   unsigned int num_centre_orbits = (n - 2) * (n - 2) / 4;
   if (n % 2 == 1) num_centre_orbits++;
   unsigned int num_orbits = num_corner_orbits + num_edge_orbits + num_centre_orbits;
-  shape->decomp.num_orbits = num_orbits;
-
-  unsigned int offset = 0;
 
   shape->orbits = malloc(num_orbits * sizeof(orbit_t));
-  shape->decomp.orbit_size = malloc(num_orbits * sizeof(unsigned int));
-  shape->decomp.orbit_offset = malloc(num_orbits * sizeof(unsigned int));
+  unsigned int *orbit_size = malloc(num_orbits * sizeof(unsigned int));
   /* only 1 corner orbit of size 8 */
-  shape->decomp.orbit_size[0] = num_corners;
-  shape->decomp.orbit_offset[0] = offset;
+  orbit_size[0] = num_corners;
   shape->orbits[0].dim = 0;
   shape->orbits[0].x = 0;
   shape->orbits[0].y = 0;
   shape->orbits[0].z = 0;
-  offset += shape->decomp.orbit_size[0];
 
   /* edge orbits have size 24, except the middle one when n is odd */
   for (unsigned int i = 1; i <= num_edge_orbits; i++) {
-    shape->decomp.orbit_size[i] = (i * 2 == n - 1) ? 12 : 24;
-    shape->decomp.orbit_offset[i] = offset;
+    orbit_size[i] = (i * 2 == n - 1) ? 12 : 24;
     shape->orbits[i].dim = 1;
     shape->orbits[i].x = i;
     shape->orbits[i].y = 0;
     shape->orbits[i].z = 0;
-    offset += shape->decomp.orbit_size[i];
   }
 
   /* centre orbits have size 24, except the central one when n is odd */
   unsigned int y = 1; unsigned int z = 1;
-  for (unsigned int i = num_edge_orbits + 1;
-       i < shape->decomp.num_orbits; i++) {
-    shape->decomp.orbit_size[i] = 24;
-    shape->decomp.orbit_offset[i] = offset;
+  for (unsigned int i = num_edge_orbits + 1; i < num_orbits; i++) {
+    orbit_size[i] = 24;
     shape->orbits[i].dim = 2;
     shape->orbits[i].x = n - 1;
     shape->orbits[i].y = y++;
     shape->orbits[i].z = z;
-    offset += shape->decomp.orbit_size[i];
 
     if (y > num_edge_orbits) {
       z++;
       y = (z > (n - 2) / 2) ? z : 1;
     }
   }
-  if (n % 2 == 1) shape->decomp.orbit_size[num_orbits - 1] = 6;
+  if (n % 2 == 1) orbit_size[num_orbits - 1] = 6;
+
+  decomp_init(&shape->decomp, num_orbits, orbit_size);
+  free(orbit_size);
 }
 
 void cube_shape_cleanup(cube_shape_t *shape)
 {
   free(shape->orbits);
+  decomp_cleanup(&shape->decomp);
 }
 
 uint8_t *cube_new(puzzle_action_t *action, cube_shape_t *shape)
@@ -110,13 +212,13 @@ uint8_t *cube_new(puzzle_action_t *action, cube_shape_t *shape)
   return conf;
 }
 
-int in_layer(puzzle_action_t *action, cube_shape_t *shape,
-             uint8_t *conf, unsigned int k, unsigned int i,
-             unsigned int f, unsigned int l)
+/* whether a piece of orbit k with symmetry g is in layer l of face f */
+static int in_layer_sym(puzzle_action_t *action, cube_shape_t *shape,
+                        unsigned int k, unsigned int g,
+                        unsigned int f, unsigned int l)
 {
-  unsigned int g = conf[i];
   unsigned int f1 = puzzle_action_local_act
-    (action, 2, f, group_inv(action->group, g));
+    (action, 2, f, group_table_inv(&action->table, g));
   orbit_t *orbit = &shape->orbits[k];
 
   switch (orbit->dim) {
@@ -149,26 +251,70 @@ int in_layer(puzzle_action_t *action, cube_shape_t *shape,
   return 0;
 }
 
-void cube_scramble(puzzle_action_t *action, cube_shape_t *shape, uint8_t *conf)
+int in_layer(puzzle_action_t *action, cube_shape_t *shape,
+             uint8_t *conf, unsigned int k, unsigned int i,
+             unsigned int f, unsigned int l)
+{
+  return in_layer_sym(action, shape, k, conf[i], f, l);
+}
+
+/* Permutation parities of the orbits of a random reachable state.
+
+   They are not independent: every quarter turn is a product of
+   4-cycles on each orbit, so it changes the parity of an orbit exactly
+   when it moves an odd multiple of 4 of its pieces. The reachable
+   parities are then the combinations of those of the turns of the
+   layers of a single face, excluding the central layer of odd cubes,
+   which would move the fixed centres. */
+static void cube_random_parities(puzzle_action_t *action,
+                                 cube_shape_t *shape,
+                                 uint8_t *parity, rng_t *rng)
+{
+  uint8_t *conf = cube_new(action, shape);
+  memset(parity, 0, shape->decomp.num_orbits);
+
+  for (unsigned int l = 0; l < shape->n / 2; l++) {
+    if (rng_uniform(rng, 2) == 0) continue;
+
+    for (unsigned int k = 0; k < shape->decomp.num_orbits; k++) {
+      unsigned int count = 0;
+      for (unsigned int i = 0; i < shape->decomp.orbit_size[k]; i++) {
+        unsigned int x = decomp_global(&shape->decomp, k, i);
+        count += in_layer(action, shape, conf, k, x, 0, l);
+      }
+      parity[k] ^= (count / 4) & 1;
+    }
+  }
+
+  free(conf);
+}
+
+void cube_scramble(puzzle_action_t *action, cube_shape_t *shape, uint8_t *conf,
+                   rng_t *rng)
 {
-  uint8_t parity = 0;
-  for (int k = shape->decomp.num_orbits - 1; k >= 0; k--) {
+  unsigned int num_orbits = shape->decomp.num_orbits;
+  uint8_t *parity = malloc(num_orbits);
+  cube_random_parities(action, shape, parity, rng);
+
+  for (unsigned int k = 0; k < num_orbits; k++) {
     unsigned int orb_size = shape->decomp.orbit_size[k];
+    if (orb_size == 0) continue;
+
     unsigned int stab_size = action->group->num / orb_size;
     uint8_t *perm = malloc(orb_size);
     perm_id(perm, orb_size);
 
-    if (k == 0 && shape->n % 2 == 1) {
-      /* only even permutations on odd cubes */
-      parity_shuffle(perm, orb_size, parity);
+    if (k == num_orbits - 1 && shape->n % 2 == 1) {
+      /* the central centres of odd cubes never move */
+      for (unsigned int i = 0; i < orb_size; i++) {
+        unsigned int x = decomp_global(&shape->decomp, k, i);
+        conf[x] = action->by_stab[shape->orbits[k].dim][i];
+      }
+      free(perm);
+      continue;
     }
-    else {
-      shuffle(perm, orb_size);
 
-      /* keep track of corner and edge parity */
-      if (shape->orbits[k].dim < 2)
-        parity ^= perm_sign(perm, orb_size);
-    }
+    parity_shuffle(perm, orb_size, parity[k], rng);
 
     unsigned int total = 0;
     for (unsigned int i = 0; i < orb_size; i++) {
@@ -178,7 +324,7 @@ void cube_scramble(puzzle_action_t *action, cube_shape_t *shape, uint8_t *conf)
         assert((total + o) % stab_size == 0);
       }
       else {
-        o = rand() % stab_size;
+        o = rng_uniform(rng, stab_size);
         total += o;
       }
 
@@ -190,6 +336,8 @@ void cube_scramble(puzzle_action_t *action, cube_shape_t *shape, uint8_t *conf)
 
     free(perm);
   }
+
+  free(parity);
 }
 
 void cube_puzzle_cleanup(void *data, puzzle_t *puzzle)
@@ -222,8 +370,8 @@ int cube_move_in_layer(void *data_, uint8_t *conf,
                   data->face, data->layer);
 }
 
-turn_t *cube_puzzle_move(void *data_, uint8_t *conf,
-                         unsigned int f, unsigned int l, int c)
+int cube_puzzle_apply(void *data_, uint8_t *conf,
+                      unsigned int f, unsigned int l, int c, turn_t *turn)
 {
   cube_puzzle_data_t *data = data_;
 
@@ -239,13 +387,160 @@ turn_t *cube_puzzle_move(void *data_, uint8_t *conf,
   move.in_layer_data = &ldata;
   move.in_layer = cube_move_in_layer;
 
-  return puzzle_move(data->puzzle, conf, &move);
+  puzzle_apply_move(data->puzzle, conf, &move, turn);
+  return 1;
+}
+
+turn_t *cube_puzzle_move(void *data_, uint8_t *conf,
+                         unsigned int f, unsigned int l, int c)
+{
+  cube_puzzle_data_t *data = data_;
+  turn_t *turn = turn_new(data->shape->decomp.num_pieces);
+  cube_puzzle_apply(data, conf, f, l, c, turn);
+  return turn;
+}
+
+struct move_table_data_t
+{
+  puzzle_action_t *action;
+  cube_shape_t *shape;
+};
+
+static int cube_move_table_in_layer(void *data_, unsigned int k,
+                                    unsigned int g, unsigned int f,
+                                    unsigned int l)
+{
+  struct move_table_data_t *data = data_;
+  return in_layer_sym(data->action, data->shape, k, g, f, l);
+}
+
+void cube_move_table_init(move_table_t *table, puzzle_action_t *action,
+                          cube_shape_t *shape)
+{
+  struct move_table_data_t data;
+  data.action = action;
+  data.shape = shape;
+
+  /* layer n - 1 of a face is layer 0 of the opposite one */
+  unsigned int num_layers = shape->n > 1 ? shape->n - 1 : 1;
+  move_table_init(table, action, &shape->decomp, 2, num_layers,
+                  cube_move_table_in_layer, &data);
+}
+
+void cube_conf_space_init(conf_space_t *space, puzzle_action_t *action,
+                          cube_shape_t *shape)
+{
+  unsigned int *dim = malloc(shape->decomp.num_orbits * sizeof(unsigned int));
+  for (unsigned int k = 0; k < shape->decomp.num_orbits; k++) {
+    dim[k] = shape->orbits[k].dim;
+  }
+  conf_space_init(space, action, &shape->decomp, dim);
+  free(dim);
+}
+
+void cube_conf_packing_init(conf_packing_t *packing, puzzle_action_t *action,
+                            cube_shape_t *shape)
+{
+  unsigned int *dim = malloc(shape->decomp.num_orbits * sizeof(unsigned int));
+  for (unsigned int k = 0; k < shape->decomp.num_orbits; k++) {
+    dim[k] = shape->orbits[k].dim;
+  }
+  conf_packing_init(packing, action, &shape->decomp, dim);
+  free(dim);
+}
+
+void cube_coords_init(cube_coords_t *coords, puzzle_action_t *action,
+                      cube_shape_t *shape, uint8_t *conf)
+{
+  unsigned int num = action->table.num;
+  unsigned int n = shape->n;
+  assert(n <= 256);
+
+  coords->action = action;
+  coords->shape = shape;
+  coords->by_sym = malloc(shape->decomp.num_orbits * num * 3);
+  for (unsigned int a = 0; a < 3; a++) {
+    coords->coords[a] = malloc(shape->decomp.num_pieces);
+  }
+
+  /* The coordinate along an axis is the layer of one of the two faces
+     orthogonal to it containing the piece. The last layer of a face is
+     not used, since in_layer_sym only handles it for some pieces. */
+  for (unsigned int k = 0; k < shape->decomp.num_orbits; k++) {
+    for (unsigned int g = 0; g < num; g++) {
+      uint8_t *c = &coords->by_sym[(k * num + g) * 3];
+      for (unsigned int a = 0; a < 3; a++) {
+        c[a] = n - 1;
+        for (unsigned int l = 0; l + 1 < n; l++) {
+          if (in_layer_sym(action, shape, k, g, 2 * a + 1, l)) {
+            c[a] = l;
+            break;
+          }
+          if (in_layer_sym(action, shape, k, g, 2 * a, l)) {
+            c[a] = n - 1 - l;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  cube_coords_set(coords, conf);
+}
+
+void cube_coords_cleanup(cube_coords_t *coords)
+{
+  free(coords->by_sym);
+  for (unsigned int a = 0; a < 3; a++) {
+    free(coords->coords[a]);
+  }
+}
+
+void cube_coords_set(cube_coords_t *coords, uint8_t *conf)
+{
+  decomp_t *decomp = &coords->shape->decomp;
+  unsigned int num = coords->action->table.num;
+
+  for (unsigned int x = 0; x < decomp->num_pieces; x++) {
+    uint8_t *c = &coords->by_sym[(decomp->orbit_of[x] * num + conf[x]) * 3];
+    for (unsigned int a = 0; a < 3; a++) {
+      coords->coords[a][x] = c[a];
+    }
+  }
+}
+
+void cube_coords_apply(cube_coords_t *coords, uint8_t *conf,
+                       unsigned int f, unsigned int l, int c, turn_t *turn)
+{
+  puzzle_action_t *action = coords->action;
+  decomp_t *decomp = &coords->shape->decomp;
+  unsigned int num = action->table.num;
+  unsigned int n = coords->shape->n;
+
+  unsigned int g = puzzle_action_stab(action, 2, f, c);
+  if (turn) {
+    turn->g = g;
+    turn->num_pieces = 0;
+  }
+
+  uint8_t *layer = coords->coords[f / 2];
+  uint8_t value = (f & 1) ? l : n - 1 - l;
+  for (unsigned int x = 0; x < decomp->num_pieces; x++) {
+    if (layer[x] != value) continue;
+
+    conf[x] = group_table_mul(&action->table, conf[x], g);
+    uint8_t *c = &coords->by_sym[(decomp->orbit_of[x] * num + conf[x]) * 3];
+    for (unsigned int a = 0; a < 3; a++) {
+      coords->coords[a][x] = c[a];
+    }
+    if (turn) turn->pieces[turn->num_pieces++] = x;
+  }
 }
 
-void cube_puzzle_scramble(void *data_, uint8_t *conf)
+void cube_puzzle_scramble(void *data_, uint8_t *conf, rng_t *rng)
 {
   cube_puzzle_data_t *data = data_;
-  cube_scramble(data->action, data->shape, conf);
+  cube_scramble(data->action, data->shape, conf, rng);
 }
 
 void cube_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action, cube_shape_t *shape)
@@ -264,6 +559,7 @@ void cube_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action, cube_shape_t *s
 
   puzzle->move = cube_puzzle_move;
   puzzle->move_data = data;
+  puzzle->apply = cube_puzzle_apply;
 
   puzzle->scramble = cube_puzzle_scramble;
   puzzle->scramble_data = data;
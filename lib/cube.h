@@ -6,12 +6,25 @@
 
 #include "puzzle.h"
 
+struct move_table_t;
+typedef struct move_table_t move_table_t;
+
+struct conf_space_t;
+typedef struct conf_space_t conf_space_t;
+
+struct conf_packing_t;
+typedef struct conf_packing_t conf_packing_t;
+
 struct orbit_t {
   int dim;
   int x, y, z;
 };
 typedef struct orbit_t orbit_t;
 
+/* Action of the rotation group of the cube on its vertices, edges and
+   faces, which are the orbits 0, 1 and 2 respectively. */
+void cube_action_init(puzzle_action_t *action);
+
 void cube_orbit_act_(unsigned int n, orbit_t *orbit, unsigned int g);
 
 typedef struct
@@ -34,6 +47,8 @@ struct cube_puzzle_data_t
 typedef struct cube_puzzle_data_t cube_puzzle_data_t;
 
 uint8_t *cube_new(puzzle_action_t *action, cube_shape_t *shape);
+void cube_scramble(puzzle_action_t *action, cube_shape_t *shape, uint8_t *conf,
+                   rng_t *rng);
 
 turn_t *cube_move_(puzzle_action_t *action, cube_shape_t *shape,
                    uint8_t *conf, unsigned int f, unsigned int l, int c);
@@ -42,6 +57,56 @@ turn_t *cube_move(puzzle_action_t *action,
                   uint8_t *conf1, uint8_t *conf,
                   unsigned int f, unsigned int l, int c);
 
+/* Precompiled moves of every face and layer, on configurations in
+   position form for the orbits of shape. */
+void cube_move_table_init(move_table_t *table, puzzle_action_t *action,
+                          cube_shape_t *shape);
+
+/* relative configurations of the pieces of shape */
+void cube_conf_space_init(conf_space_t *space, puzzle_action_t *action,
+                          cube_shape_t *shape);
+
+/* packed configurations of the pieces of shape */
+void cube_conf_packing_init(conf_packing_t *packing, puzzle_action_t *action,
+                            cube_shape_t *shape);
+
+/* Coordinates of the pieces of a configuration.
+
+   The coordinate of a piece along axis a is its layer index counted
+   from face 2a + 1, so that the piece is in layer l of face 2a + 1 if
+   and only if its coordinate is l, and in layer l of face 2a if and
+   only if it is n - 1 - l. Keeping the coordinates along with a
+   configuration turns finding the pieces of a layer into a scan of an
+   array of coordinates, and only the pieces that move need to be
+   updated. The size of the cube is at most 256. */
+struct cube_coords_t
+{
+  puzzle_action_t *action;
+  cube_shape_t *shape;
+
+  /* coordinates of a piece of orbit k with symmetry g, at index (k *
+     |G| + g) * 3 + a */
+  uint8_t *by_sym;
+
+  /* coordinates of every piece, along each axis */
+  uint8_t *coords[3];
+};
+typedef struct cube_coords_t cube_coords_t;
+
+void cube_coords_init(cube_coords_t *coords, puzzle_action_t *action,
+                      cube_shape_t *shape, uint8_t *conf);
+void cube_coords_cleanup(cube_coords_t *coords);
+
+/* recompute the coordinates of all the pieces of conf */
+void cube_coords_set(cube_coords_t *coords, uint8_t *conf);
+
+/* Same as cube_puzzle_apply, for a configuration whose coordinates are
+   kept in coords, on any layer l < n - 1. Unlike cube_puzzle_apply,
+   which does nothing on layer n - 1, this turns that layer, which is
+   the opposite face: (f, n - 1, c) is the same as (f ^ 1, 0, -c). */
+void cube_coords_apply(cube_coords_t *coords, uint8_t *conf,
+                       unsigned int f, unsigned int l, int c, turn_t *turn);
+
 void cube_puzzle_init(puzzle_t *puzzle,
                       puzzle_action_t *action,
                       cube_shape_t *shape);
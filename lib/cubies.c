@@ -0,0 +1,344 @@
+#include "cubies.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conf_sym.h"
+#include "group.h"
+#include "notation.h"
+#include "perm.h"
+
+const int cubies_counts[3] = { 1, 2, -1 };
+
+/* Face of a cubie of the solved cube along axis a, or 6 if it is in
+   the middle layer. */
+static unsigned int cubie_face(cube_coords_t *coords, unsigned int x,
+                               unsigned int a)
+{
+  switch (coords->coords[a][x]) {
+  case 0: return 2 * a + 1;
+  case 2: return 2 * a;
+  }
+  return 6;
+}
+
+static void cubies_init_coords(cubies_t *cubies, cube_coords_t *coords)
+{
+  puzzle_action_t *action = cubies->action;
+  group_table_t *table = &action->table;
+  decomp_t *decomp = &cubies->shape->decomp;
+
+  for (unsigned int g = 0; g < 24; g++) {
+    cubies->corner_pos[g] = action->inv_by_stab[0][g] % 8;
+    cubies->edge_pos[g] = action->inv_by_stab[1][g] % 12;
+  }
+
+  memset(cubies->corner_layer, 0, sizeof(cubies->corner_layer));
+  memset(cubies->edge_layer, 0, sizeof(cubies->edge_layer));
+  for (unsigned int a = 0; a < 3; a++) {
+    for (unsigned int p = 0; p < 8; p++) {
+      cubies->corner_layer[cubie_face(coords, p, a)] |= 1 << p;
+    }
+    for (unsigned int p = 0; p < 12; p++) {
+      unsigned int f = cubie_face(coords, decomp->orbit_offset[1] + p, a);
+      if (f < 6) cubies->edge_layer[f] |= 1 << p;
+    }
+  }
+
+  /* The sticker of corner x on the axis of faces 2 and 3 is on face f
+     when x is solved, and on face f s' g for symmetry g, where s is
+     the symmetry of the solved corner. Its orientation is the index of
+     that face among those of the position, in the same rotational
+     order for every position. */
+  for (unsigned int x = 0; x < 8; x++) {
+    unsigned int s = action->by_stab[0][x];
+    unsigned int f = cubie_face(coords, x, 1);
+    for (unsigned int g = 0; g < 24; g++) {
+      unsigned int p = cubies->corner_pos[g];
+      unsigned int h = group_table_inv_mul(table, s, g);
+      unsigned int a = puzzle_action_local_act(action, 2, f, h) / 2;
+
+      unsigned int num_plus = 0;
+      for (unsigned int b = 0; b < 3; b++) {
+        num_plus += coords->coords[b][p] != 0;
+      }
+      unsigned int o = a == 1 ? 0 : a == ((num_plus & 1) ? 2 : 0) ? 1 : 2;
+      cubies->corner_ori[x * 24 + g] = o;
+      cubies->corner_sym[(x * 8 + p) * 3 + o] = g;
+    }
+  }
+
+  /* the reference sticker of an edge is on the axis of faces 2 and 3
+     if it has one, and on that of faces 4 and 5 otherwise */
+  cubies->slice_edges = 0;
+  unsigned int num[2] = { 0, 0 };
+  for (unsigned int x = 0; x < 12; x++) {
+    unsigned int i = decomp->orbit_offset[1] + x;
+    unsigned int s = action->by_stab[1][x];
+    unsigned int f = cubie_face(coords, i, 1);
+    if (f == 6) {
+      f = cubie_face(coords, i, 2);
+      cubies->slice_edges |= 1 << x;
+    }
+    cubies->edge_rank[x] = num[f >= 4]++;
+
+    for (unsigned int g = 0; g < 24; g++) {
+      unsigned int p = cubies->edge_pos[g];
+      unsigned int h = group_table_inv_mul(table, s, g);
+      unsigned int a = puzzle_action_local_act(action, 2, f, h) / 2;
+      unsigned int ref = cubie_face(coords, decomp->orbit_offset[1] + p,
+                                    1) == 6 ? 2 : 1;
+      unsigned int o = a != ref;
+      cubies->edge_ori[x * 24 + g] = o;
+      cubies->edge_sym[(x * 12 + p) * 2 + o] = g;
+    }
+  }
+  assert(num[1] == 4);
+
+  for (unsigned int x = 0; x < 8; x++) {
+    assert(cubies->corner_sym[(x * 8 + x) * 3] == action->by_stab[0][x]);
+  }
+  for (unsigned int x = 0; x < 12; x++) {
+    assert(cubies->edge_sym[(x * 12 + x) * 2] == action->by_stab[1][x]);
+  }
+}
+
+void cubies_init(cubies_t *cubies, puzzle_action_t *action,
+                 cube_shape_t *shape)
+{
+  assert(shape->n == 3);
+  cubies->action = action;
+  cubies->shape = shape;
+
+  for (unsigned int m = 0; m < CUBIES_NUM_MOVES; m++) {
+    cubies->t[m] = puzzle_action_stab(action, 2, m / 3, cubies_counts[m % 3]);
+  }
+
+  uint8_t *conf = cube_new(action, shape);
+  cube_coords_t coords;
+  cube_coords_init(&coords, action, shape, conf);
+  cubies_init_coords(cubies, &coords);
+  cube_coords_cleanup(&coords);
+  free(conf);
+}
+
+void cubies_solved(cubies_t *cubies, uint8_t *c)
+{
+  for (unsigned int x = 0; x < 8; x++) {
+    c[x] = cubies->corner_sym[(x * 8 + x) * 3];
+  }
+  for (unsigned int x = 0; x < 12; x++) {
+    c[8 + x] = cubies->edge_sym[(x * 12 + x) * 2];
+  }
+}
+
+void cubies_move(cubies_t *cubies, uint8_t *c, unsigned int m)
+{
+  group_table_t *table = &cubies->action->table;
+  unsigned int f = m / 3;
+  unsigned int t = cubies->t[m];
+
+  for (unsigned int x = 0; x < 8; x++) {
+    if ((cubies->corner_layer[f] >> cubies->corner_pos[c[x]]) & 1) {
+      c[x] = group_table_mul(table, c[x], t);
+    }
+  }
+  for (unsigned int x = 0; x < 12; x++) {
+    if ((cubies->edge_layer[f] >> cubies->edge_pos[c[8 + x]]) & 1) {
+      c[8 + x] = group_table_mul(table, c[8 + x], t);
+    }
+  }
+}
+
+/* Rotation bringing the centres of conf to their positions, or -1 if
+   there is none. */
+static int centre_rotation(cubies_t *cubies, uint8_t *conf)
+{
+  puzzle_action_t *action = cubies->action;
+  decomp_t *decomp = &cubies->shape->decomp;
+  unsigned int k = decomp->num_orbits - 1;
+  unsigned int offset = decomp->orbit_offset[k];
+
+  for (unsigned int h = 0; h < action->table.num; h++) {
+    unsigned int x;
+    for (x = 0; x < 6; x++) {
+      unsigned int g = group_table_mul(&action->table, conf[offset + x], h);
+      if (action->inv_by_stab[2][g] % 6 != x) break;
+    }
+    if (x == 6) return h;
+  }
+
+  return -1;
+}
+
+/* whether the cubies form a configuration reachable by turns */
+static int cubies_valid(cubies_t *cubies, uint8_t *c)
+{
+  uint8_t cperm[8];
+  uint8_t eperm[12];
+  unsigned int cmask = 0, emask = 0;
+  unsigned int twist = 0, flip = 0;
+
+  for (unsigned int x = 0; x < 8; x++) {
+    cperm[x] = cubies->corner_pos[c[x]];
+    cmask |= 1 << cperm[x];
+    twist += cubies->corner_ori[x * 24 + c[x]];
+  }
+  for (unsigned int x = 0; x < 12; x++) {
+    eperm[x] = cubies->edge_pos[c[8 + x]];
+    emask |= 1 << eperm[x];
+    flip += cubies->edge_ori[x * 24 + c[8 + x]];
+  }
+
+  return cmask == 0xff && emask == 0xfff &&
+    twist % 3 == 0 && flip % 2 == 0 &&
+    perm_sign(cperm, 8) == perm_sign(eperm, 12);
+}
+
+int cubies_from_conf(cubies_t *cubies, uint8_t *c, uint8_t *conf)
+{
+  puzzle_action_t *action = cubies->action;
+  decomp_t *decomp = &cubies->shape->decomp;
+
+  int h = centre_rotation(cubies, conf);
+  if (h < 0) return -1;
+  for (unsigned int x = 0; x < 8; x++) {
+    c[x] = group_table_mul(&action->table, conf[x], h);
+  }
+  for (unsigned int x = 0; x < 12; x++) {
+    unsigned int i = decomp->orbit_offset[1] + x;
+    c[8 + x] = group_table_mul(&action->table, conf[i], h);
+  }
+  if (!cubies_valid(cubies, c)) return -1;
+
+  return h;
+}
+
+void cubies_push_moves(cubies_t *cubies, move_seq_t *seq,
+                       const uint8_t *moves, unsigned int num_moves,
+                       unsigned int h)
+{
+  puzzle_action_t *action = cubies->action;
+
+  /* moves of the rotated configuration are the same moves of the
+     rotated back faces */
+  unsigned int h1 = group_table_inv(&action->table, h);
+  for (unsigned int i = 0; i < num_moves; i++) {
+    unsigned int m = moves[i];
+    unsigned int f = puzzle_action_local_act(action, 2, m / 3, h1);
+    move_seq_push(seq, f, 0, cubies_counts[m % 3]);
+  }
+  if (h != 0) move_seq_push(seq, MOVE_OP_ROTATION, h, 1);
+}
+
+/* Same as conf_sym_apply, on the orbits of the corners and edges,
+   which are the first two orbits of the configurations. */
+void cubies_conj(cubies_t *cubies, conf_syms_t *syms, uint8_t *c1,
+                 uint8_t *c, unsigned int s)
+{
+  decomp_t *decomp = &cubies->shape->decomp;
+  group_table_t *table = &cubies->action->table;
+  unsigned int n = decomp->num_pieces;
+  unsigned int *src = &syms->src[s * n];
+  uint8_t *left = &syms->left[s * n];
+
+  for (unsigned int k = 0; k < 2; k++) {
+    uint8_t *right = &syms->right[(s * decomp->num_orbits + k) * table->num];
+    unsigned int offset = decomp->orbit_offset[k];
+    unsigned int end = decomp->orbit_offset[k + 1];
+    unsigned int i = k ? 8 : 0;
+    for (unsigned int y = offset; y < end; y++) {
+      c1[i + y - offset] =
+        group_table_mul(table, left[y], right[c[i + src[y] - offset]]);
+    }
+  }
+}
+
+/* Orientations are indexed by position, and the last one is
+   determined by the others. */
+
+unsigned int cubies_twist(cubies_t *cubies, uint8_t *c)
+{
+  uint8_t ori[8];
+  for (unsigned int x = 0; x < 8; x++) {
+    ori[cubies->corner_pos[c[x]]] = cubies->corner_ori[x * 24 + c[x]];
+  }
+  unsigned int twist = 0;
+  for (unsigned int p = 0; p < 7; p++) twist = 3 * twist + ori[p];
+  return twist;
+}
+
+void cubies_set_twist(cubies_t *cubies, uint8_t *c, unsigned int twist)
+{
+  unsigned int sum = 0;
+  cubies_solved(cubies, c);
+  for (unsigned int p = 7; p-- > 0;) {
+    unsigned int o = twist % 3;
+    c[p] = cubies->corner_sym[(p * 8 + p) * 3 + o];
+    sum += o;
+    twist /= 3;
+  }
+  c[7] = cubies->corner_sym[(7 * 8 + 7) * 3 + (3 - sum % 3) % 3];
+}
+
+unsigned int cubies_flip(cubies_t *cubies, uint8_t *c)
+{
+  uint8_t ori[12];
+  for (unsigned int x = 0; x < 12; x++) {
+    ori[cubies->edge_pos[c[8 + x]]] = cubies->edge_ori[x * 24 + c[8 + x]];
+  }
+  unsigned int flip = 0;
+  for (unsigned int p = 0; p < 11; p++) flip = 2 * flip + ori[p];
+  return flip;
+}
+
+void cubies_set_flip(cubies_t *cubies, uint8_t *c, unsigned int flip)
+{
+  unsigned int sum = 0;
+  cubies_solved(cubies, c);
+  for (unsigned int p = 11; p-- > 0;) {
+    unsigned int o = flip & 1;
+    c[8 + p] = cubies->edge_sym[(p * 12 + p) * 2 + o];
+    sum += o;
+    flip >>= 1;
+  }
+  c[8 + 11] = cubies->edge_sym[(11 * 12 + 11) * 2 + sum % 2];
+}
+
+unsigned int cubies_cperm(cubies_t *cubies, uint8_t *c)
+{
+  uint8_t perm[8];
+  for (unsigned int x = 0; x < 8; x++) {
+    perm[x] = cubies->corner_pos[c[x]];
+  }
+  return perm_index(perm, 8, 8);
+}
+
+void cubies_set_cperm(cubies_t *cubies, uint8_t *c, unsigned int cperm)
+{
+  uint8_t perm[8];
+  cubies_solved(cubies, c);
+  perm_from_index(perm, 8, cperm, 8);
+  for (unsigned int x = 0; x < 8; x++) {
+    c[x] = cubies->corner_sym[(x * 8 + perm[x]) * 3];
+  }
+}
+
+uint16_t *cubies_move_table_new(cubies_t *cubies, unsigned int size,
+                                const uint8_t *moves, unsigned int num_moves,
+                                cubies_get_t get, cubies_set_t set)
+{
+  uint16_t *table = malloc(size * num_moves * sizeof(uint16_t));
+  uint8_t c[CUBIES_NUM];
+
+  for (unsigned int i = 0; i < size; i++) {
+    for (unsigned int k = 0; k < num_moves; k++) {
+      set(cubies, c, i);
+      cubies_move(cubies, c, moves[k]);
+      table[i * num_moves + k] = get(cubies, c);
+    }
+  }
+
+  return table;
+}
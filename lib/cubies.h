@@ -0,0 +1,118 @@
+#ifndef CUBIES_H
+#define CUBIES_H
+
+#include <stdint.h>
+
+#include "cube.h"
+
+struct move_seq_t;
+typedef struct move_seq_t move_seq_t;
+
+struct conf_syms_t;
+typedef struct conf_syms_t conf_syms_t;
+
+/* Corners and edges of the 3x3x3 cube, as used by the solvers.
+
+A configuration is the array of the symmetries of the 8 corners
+followed by the 12 edges, with the centres brought back in place by a
+rotation of the whole cube. Moves are the outer turns: move m turns
+face m / 3 by 1, 2 and -1 for m % 3 = 0, 1 and 2 respectively.
+
+The corner orientation is the position of the sticker on the axis of
+faces 2 and 3, and the edge orientation tells whether the sticker on
+that axis, or on the axis of faces 4 and 5 for middle layer edges, is
+on the corresponding facet of its position. The orientations of the
+centres are not visible and are ignored. */
+
+#define CUBIES_NUM 20
+#define CUBIES_NUM_MOVES 18
+
+#define CUBIES_NUM_TWISTS 2187
+#define CUBIES_NUM_FLIPS 2048
+#define CUBIES_NUM_CPERMS 40320
+
+struct cubies_t
+{
+  puzzle_action_t *action;
+  cube_shape_t *shape;
+
+  /* symmetry of every move */
+  uint8_t t[CUBIES_NUM_MOVES];
+
+  /* For corners and edges: the position of a piece with symmetry g,
+     its orientation at index x * |G| + g for piece x, and the
+     symmetry of piece x at position p with orientation o. */
+  uint8_t corner_pos[24];
+  uint8_t edge_pos[24];
+  uint8_t corner_ori[8 * 24];
+  uint8_t edge_ori[12 * 24];
+  uint8_t corner_sym[8 * 8 * 3];
+  uint8_t edge_sym[12 * 12 * 2];
+
+  /* positions in layer 0 of every face, as bit sets */
+  uint8_t corner_layer[6];
+  uint16_t edge_layer[6];
+
+  /* edges of the middle layer of the axis of faces 2 and 3, and index
+     of every edge among the middle layer edges or the others */
+  uint16_t slice_edges;
+  uint8_t edge_rank[12];
+};
+typedef struct cubies_t cubies_t;
+
+extern const int cubies_counts[3];
+
+void cubies_init(cubies_t *cubies, puzzle_action_t *action,
+                 cube_shape_t *shape);
+
+void cubies_solved(cubies_t *cubies, uint8_t *c);
+void cubies_move(cubies_t *cubies, uint8_t *c, unsigned int m);
+
+/* Whether move m may follow move last. Turns of the same face are
+   merged, and turns of opposite faces commute, so they are only
+   considered in one order. */
+static inline int cubies_move_allowed(unsigned int last, unsigned int m)
+{
+  unsigned int f = m / 3;
+  last /= 3;
+  return f != last && !(f == (last ^ 1) && f < last);
+}
+
+/* Get the cubies of conf. Return the rotation bringing its centres in
+   place, or -1 if conf is not reachable by turns. */
+int cubies_from_conf(cubies_t *cubies, uint8_t *c, uint8_t *conf);
+
+/* Append moves of the cubies of a configuration rotated by h to seq,
+   as moves of that configuration, followed by the rotation h. */
+void cubies_push_moves(cubies_t *cubies, move_seq_t *seq,
+                       const uint8_t *moves, unsigned int num_moves,
+                       unsigned int h);
+
+/* Conjugate c by symmetry s of syms, symmetries of the configurations
+   of the 3x3x3 cube (see conf_sym.h), i.e. set c1 to the configuration
+   reached from the solved one by the moves reaching c, with every face
+   replaced by its image by s, and, if s is a reflection, every turn
+   replaced by its inverse. */
+void cubies_conj(cubies_t *cubies, conf_syms_t *syms, uint8_t *c1,
+                 uint8_t *c, unsigned int s);
+
+/* Coordinates: orientations of the corners (twist) and edges (flip),
+   indexed by position, and permutation of the corners (cperm). Set
+   functions reset the other cubies to their solved state. */
+unsigned int cubies_twist(cubies_t *cubies, uint8_t *c);
+void cubies_set_twist(cubies_t *cubies, uint8_t *c, unsigned int twist);
+unsigned int cubies_flip(cubies_t *cubies, uint8_t *c);
+void cubies_set_flip(cubies_t *cubies, uint8_t *c, unsigned int flip);
+unsigned int cubies_cperm(cubies_t *cubies, uint8_t *c);
+void cubies_set_cperm(cubies_t *cubies, uint8_t *c, unsigned int cperm);
+
+typedef unsigned int (*cubies_get_t)(cubies_t *cubies, uint8_t *c);
+typedef void (*cubies_set_t)(cubies_t *cubies, uint8_t *c, unsigned int x);
+
+/* Table of a coordinate of size values after each of the given moves,
+   at index value * num_moves + k. */
+uint16_t *cubies_move_table_new(cubies_t *cubies, unsigned int size,
+                                const uint8_t *moves, unsigned int num_moves,
+                                cubies_get_t get, cubies_set_t set);
+
+#endif /* CUBIES_H */
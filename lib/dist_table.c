@@ -0,0 +1,285 @@
+#include "dist_table.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "conf_pack.h"
+#include "utils.h"
+
+void dist_table_init(dist_table_t *table, uint64_t num_states,
+                     unsigned int bits)
+{
+  assert(bits == 2 || bits == 4);
+  table->bits = bits;
+  table->num_states = num_states;
+  table->num_words = (num_states + 64 / bits - 1) / (64 / bits);
+  table->words = malloc(table->num_words * sizeof(uint64_t));
+  memset(table->words, 0xff, table->num_words * sizeof(uint64_t));
+  table->max_depth = 0;
+  memset(table->num_by_depth, 0, sizeof(table->num_by_depth));
+}
+
+void dist_table_cleanup(dist_table_t *table)
+{
+  free(table->words);
+}
+
+/* entry of a configuration at distance d */
+static inline unsigned int table_value(dist_table_t *table, unsigned int d)
+{
+  return table->bits == 2 ? d % 3 : d;
+}
+
+struct dist_table_level_t
+{
+  dist_table_t *table;
+  unsigned int num_moves;
+  dist_table_expand_t expand;
+  dist_table_equiv_t equiv;
+  void *data;
+
+  /* entries per word are 1 << log, and an unknown entry is unknown */
+  unsigned int log;
+  unsigned int unknown;
+
+  unsigned int depth;
+  int backward;
+
+  uint64_t chunk;
+  uint64_t count;
+};
+
+#define DIST_TABLE_CHUNK 1024
+
+static inline unsigned int table_load(struct dist_table_level_t *level,
+                                      uint64_t i)
+{
+  uint64_t *word = &level->table->words[i >> level->log];
+  unsigned int shift = level->table->bits * (i & ((1 << level->log) - 1));
+  return (__atomic_load_n(word, __ATOMIC_RELAXED) >> shift) & level->unknown;
+}
+
+static inline int table_claim(struct dist_table_level_t *level, uint64_t i,
+                              unsigned int value)
+{
+  uint64_t *word = &level->table->words[i >> level->log];
+  unsigned int shift = level->table->bits * (i & ((1 << level->log) - 1));
+  if (((__atomic_load_n(word, __ATOMIC_RELAXED) >> shift) & level->unknown)
+      != level->unknown) return 0;
+
+  uint64_t mask = ~((uint64_t) (level->unknown ^ value) << shift);
+  uint64_t old = __atomic_fetch_and(word, mask, __ATOMIC_RELAXED);
+  return ((old >> shift) & level->unknown) == level->unknown;
+}
+
+/* Claim entry i and its equivalents, and return how many were
+   claimed. */
+static unsigned int level_claim(struct dist_table_level_t *level,
+                                uint64_t i, unsigned int value)
+{
+  if (!table_claim(level, i, value)) return 0;
+
+  unsigned int count = 1;
+  if (level->equiv) {
+    uint64_t equiv[DIST_TABLE_MAX_EQUIV];
+    unsigned int n = level->equiv(level->data, i, equiv);
+    assert(n <= DIST_TABLE_MAX_EQUIV);
+    for (unsigned int k = 0; k < n; k++) {
+      count += table_claim(level, equiv[k], value);
+    }
+  }
+  return count;
+}
+
+static void *dist_table_level_run(void *data)
+{
+  struct dist_table_level_t *level = data;
+  dist_table_t *table = level->table;
+  unsigned int bits = table->bits;
+  unsigned int value = table_value(table, level->depth);
+  unsigned int next_value = table_value(table, level->depth + 1);
+  unsigned int wanted = level->backward ? level->unknown : value;
+  uint64_t next[DIST_TABLE_MAX_MOVES];
+  uint64_t count = 0;
+
+  while (1) {
+    uint64_t c = __atomic_fetch_add(&level->chunk, 1, __ATOMIC_RELAXED);
+    uint64_t start = c * DIST_TABLE_CHUNK;
+    if (start >= table->num_words) break;
+    uint64_t end = start + DIST_TABLE_CHUNK;
+    if (end > table->num_words) end = table->num_words;
+
+    for (uint64_t w = start; w < end; w++) {
+      uint64_t word = __atomic_load_n(&table->words[w], __ATOMIC_RELAXED);
+      for (unsigned int k = 0; k < 64 / bits; k++) {
+        if (((word >> (bits * k)) & level->unknown) != wanted) continue;
+        uint64_t i = (w << level->log) + k;
+        if (i >= table->num_states) break;
+        level->expand(level->data, i, next);
+
+        if (level->backward) {
+          for (unsigned int m = 0; m < level->num_moves; m++) {
+            if (table_load(level, next[m]) != value) continue;
+            count += level_claim(level, i, next_value);
+            break;
+          }
+        }
+        else {
+          for (unsigned int m = 0; m < level->num_moves; m++) {
+            count += level_claim(level, next[m], next_value);
+          }
+        }
+      }
+    }
+  }
+
+  __atomic_fetch_add(&level->count, count, __ATOMIC_RELAXED);
+  return 0;
+}
+
+void dist_table_build(dist_table_t *table, uint64_t solved,
+                      unsigned int num_moves, dist_table_expand_t expand,
+                      dist_table_equiv_t equiv, void *data,
+                      unsigned int num_threads)
+{
+  assert(num_moves <= DIST_TABLE_MAX_MOVES);
+  if (num_threads == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = n > 0 ? n : 1;
+  }
+  pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+
+  struct dist_table_level_t level = {
+    .table = table,
+    .num_moves = num_moves,
+    .expand = expand,
+    .equiv = equiv,
+    .data = data,
+    .log = table->bits == 2 ? 5 : 4,
+    .unknown = (1 << table->bits) - 1,
+  };
+
+  /* with 4 bits, the largest distance is one less than unknown */
+  unsigned int max_depth = table->bits == 2 ?
+    DIST_TABLE_MAX_DEPTH : level.unknown;
+
+  memset(table->words, 0xff, table->num_words * sizeof(uint64_t));
+  memset(table->num_by_depth, 0, sizeof(table->num_by_depth));
+  table->num_by_depth[0] = level_claim(&level, solved, 0);
+  table->max_depth = 0;
+
+  uint64_t num_unknown = table->num_states - table->num_by_depth[0];
+  for (unsigned int d = 0; d + 1 < max_depth && num_unknown; d++) {
+    level.depth = d;
+    level.backward = num_unknown < table->num_by_depth[d];
+    level.chunk = 0;
+    level.count = 0;
+
+    for (unsigned int k = 1; k < num_threads; k++) {
+      pthread_create(&threads[k], 0, dist_table_level_run, &level);
+    }
+    dist_table_level_run(&level);
+    for (unsigned int k = 1; k < num_threads; k++) {
+      pthread_join(threads[k], 0);
+    }
+
+    if (level.count == 0) break;
+    table->num_by_depth[d + 1] = level.count;
+    table->max_depth = d + 1;
+    num_unknown -= level.count;
+  }
+  assert(num_unknown == 0);
+
+  free(threads);
+}
+
+#define DIST_TABLE_HEADER_SIZE (16 + 8 * DIST_TABLE_MAX_DEPTH + 8)
+
+int dist_table_save(dist_table_t **tables, unsigned int num_tables,
+                    const char *path, const uint8_t *prefix, size_t size)
+{
+  size_t header_size = size + num_tables * DIST_TABLE_HEADER_SIZE;
+  uint8_t *header = calloc(1, header_size);
+  memcpy(header, prefix, size);
+
+  FILE *f = fopen(path, "wb");
+  int ok = f != 0;
+  if (ok) ok = fwrite(header, header_size, 1, f) == 1;
+  for (unsigned int k = 0; k < num_tables && ok; k++) {
+    dist_table_t *table = tables[k];
+    size_t data_size = table->num_words * 8;
+    uint8_t *data = malloc(data_size);
+    for (uint64_t w = 0; w < table->num_words; w++) {
+      put_u64(&data[8 * w], table->words[w]);
+    }
+
+    uint8_t *h = &header[size + k * DIST_TABLE_HEADER_SIZE];
+    put_u64(&h[0], table->num_states);
+    put_u32(&h[8], table->bits);
+    put_u32(&h[12], table->max_depth);
+    for (unsigned int d = 0; d < DIST_TABLE_MAX_DEPTH; d++) {
+      put_u64(&h[16 + 8 * d], table->num_by_depth[d]);
+    }
+    put_u64(&h[16 + 8 * DIST_TABLE_MAX_DEPTH], conf_hash(data, data_size));
+
+    ok = fwrite(data, data_size, 1, f) == 1;
+    free(data);
+  }
+
+  /* the header is complete once the hashes are known */
+  if (ok) ok = fseek(f, 0, SEEK_SET) == 0;
+  if (ok) ok = fwrite(header, header_size, 1, f) == 1;
+  if (f && fclose(f) != 0) ok = 0;
+
+  free(header);
+  return ok;
+}
+
+int dist_table_load(dist_table_t **tables, unsigned int num_tables,
+                    const char *path, const uint8_t *prefix, size_t size)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+
+  size_t header_size = size + num_tables * DIST_TABLE_HEADER_SIZE;
+  uint8_t *header = malloc(header_size);
+  uint8_t **data = calloc(num_tables, sizeof(uint8_t *));
+  int ok = fread(header, header_size, 1, f) == 1 &&
+    memcmp(header, prefix, size) == 0;
+  for (unsigned int k = 0; k < num_tables && ok; k++) {
+    dist_table_t *table = tables[k];
+    const uint8_t *h = &header[size + k * DIST_TABLE_HEADER_SIZE];
+    size_t data_size = table->num_words * 8;
+    data[k] = malloc(data_size);
+    ok = get_u64(&h[0]) == table->num_states &&
+      get_u32(&h[8]) == table->bits &&
+      get_u32(&h[12]) < DIST_TABLE_MAX_DEPTH &&
+      fread(data[k], data_size, 1, f) == 1 &&
+      get_u64(&h[16 + 8 * DIST_TABLE_MAX_DEPTH]) ==
+      conf_hash(data[k], data_size);
+  }
+  fclose(f);
+
+  for (unsigned int k = 0; k < num_tables; k++) {
+    dist_table_t *table = tables[k];
+    if (ok) {
+      const uint8_t *h = &header[size + k * DIST_TABLE_HEADER_SIZE];
+      for (uint64_t w = 0; w < table->num_words; w++) {
+        table->words[w] = get_u64(&data[k][8 * w]);
+      }
+      table->max_depth = get_u32(&h[12]);
+      for (unsigned int d = 0; d < DIST_TABLE_MAX_DEPTH; d++) {
+        table->num_by_depth[d] = get_u64(&h[16 + 8 * d]);
+      }
+    }
+    free(data[k]);
+  }
+
+  free(data);
+  free(header);
+  return ok;
+}
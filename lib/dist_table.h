@@ -0,0 +1,91 @@
+#ifndef DIST_TABLE_H
+#define DIST_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Packed tables of the distances of configurations from the solved
+one, as used by the solvers.
+
+An entry has 2 or 4 bits, all set meaning that the distance is
+unknown. With 4 bits, it is the distance itself, at most 14. With 2
+bits, it is the distance modulo 3, which is enough to find, at every
+step of an optimal solution, a move to a configuration one move
+closer, since the distances of neighbours differ by at most 1.
+
+Tables are filled by a breadth-first search, one level at a time.
+Forward levels expand the configurations of the last level, and
+backward levels look for a neighbour in the last level from every
+configuration of unknown distance, which is faster once most of the
+distances are known. With 2 bits, forward levels also expand the
+configurations at distance depth - 3, depth - 6 and so on, whose
+neighbours are all known already. Threads take chunks of the table
+from a shared counter, and claim configurations by clearing bits of
+their entries, which only ever turns an unknown distance into that of
+the next level. */
+
+#define DIST_TABLE_MAX_DEPTH 32
+#define DIST_TABLE_MAX_MOVES 32
+#define DIST_TABLE_MAX_EQUIV 64
+
+struct dist_table_t
+{
+  /* 64 / bits entries per word */
+  uint64_t *words;
+  uint64_t num_states;
+  uint64_t num_words;
+  unsigned int bits;
+
+  /* number of configurations at every distance */
+  unsigned int max_depth;
+  uint64_t num_by_depth[DIST_TABLE_MAX_DEPTH];
+};
+typedef struct dist_table_t dist_table_t;
+
+/* A table of num_states unknown distances, with 2 or 4 bits each. */
+void dist_table_init(dist_table_t *table, uint64_t num_states,
+                     unsigned int bits);
+void dist_table_cleanup(dist_table_t *table);
+
+static inline unsigned int dist_table_get(const dist_table_t *table,
+                                          uint64_t i)
+{
+  if (table->bits == 2) return (table->words[i / 32] >> (2 * (i % 32))) & 3;
+  return (table->words[i / 16] >> (4 * (i % 16))) & 15;
+}
+
+/* Index of the neighbours of configuration i by every move. */
+typedef void (*dist_table_expand_t)(void *data, uint64_t i, uint64_t *next);
+
+/* Other configurations to claim together with i, and their number.
+   They are needed when several entries stand for the same
+   configurations up to symmetry, but are not reached at the same
+   level from the neighbours of the configurations that are expanded
+   (see two_phase.c). */
+typedef unsigned int (*dist_table_equiv_t)(void *data, uint64_t i,
+                                           uint64_t *equiv);
+
+/* Fill table by a breadth-first search from configuration solved,
+   with num_moves moves, using num_threads threads, or one per
+   processor if it is 0. equiv may be null. Every configuration must
+   be reachable. */
+void dist_table_build(dist_table_t *table, uint64_t solved,
+                      unsigned int num_moves, dist_table_expand_t expand,
+                      dist_table_equiv_t equiv, void *data,
+                      unsigned int num_threads);
+
+/* Save tables to path, after the size bytes of prefix, or load tables
+   saved with the same prefix. Return 0 on error, in which case loaded
+   tables are unchanged.
+
+   The prefix is followed by a header of little endian words for every
+   table: 64-bit number of configurations, 32-bit number of bits per
+   entry and maximum depth, 64-bit number of configurations at every
+   depth and 64-bit hash of the table. The tables follow, as little
+   endian 64-bit words. */
+int dist_table_save(dist_table_t **tables, unsigned int num_tables,
+                    const char *path, const uint8_t *prefix, size_t size);
+int dist_table_load(dist_table_t **tables, unsigned int num_tables,
+                    const char *path, const uint8_t *prefix, size_t size);
+
+#endif /* DIST_TABLE_H */
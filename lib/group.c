@@ -1,7 +1,9 @@
 #include "group.h"
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "perm.h"
 
@@ -22,15 +24,26 @@ unsigned int group_inv_mul(group_t *group, unsigned int x, unsigned int y)
 
 unsigned int group_inv(group_t *group, unsigned int x)
 {
+  if (group->table) return group_table_inv(group->table, x);
   return group->inv_mul(group->data, x, 0);
 }
 
 unsigned int group_conj(group_t *group, unsigned int x, unsigned int y)
 {
+  if (group->table) return group_table_conj(group->table, x, y);
   unsigned int y_inv_x = group_inv_mul(group, y, x);
   return group_mul(group, y_inv_x, y);
 }
 
+unsigned int group_order(group_t *group, unsigned int x)
+{
+  if (group->table) return group_table_order(group->table, x);
+
+  unsigned int order = 1;
+  for (unsigned int y = x; y != 0; y = group_mul(group, y, x)) order++;
+  return order;
+}
+
 void action_cleanup(action_t *action)
 {
   if (action->cleanup) action->cleanup(action->data);
@@ -41,30 +54,24 @@ unsigned int action_act(action_t *action, unsigned int a, unsigned int g)
   return action->act(action->data, a, g);
 }
 
-struct group_memo_data_t
+static unsigned int group_memo_mul(void *data, unsigned int x, unsigned int y)
 {
-  unsigned int num;
-  uint8_t *mul;
-  uint8_t *inv_mul;
-};
-
-static unsigned int group_memo_mul(void *data_, unsigned int x, unsigned int y)
-{
-  struct group_memo_data_t *data = data_;
-  return data->mul[x + y * data->num];
+  return group_table_mul(data, x, y);
 }
 
-static unsigned int group_memo_inv_mul(void *data_, unsigned int x, unsigned int y)
+static unsigned int group_memo_inv_mul(void *data, unsigned int x, unsigned int y)
 {
-  struct group_memo_data_t *data = data_;
-  return data->inv_mul[x + y * data->num];
+  return group_table_inv_mul(data, x, y);
 }
 
 static void group_memo_cleanup(void *data_)
 {
-  struct group_memo_data_t *data = data_;
+  group_table_t *data = data_;
   free(data->mul);
   free(data->inv_mul);
+  free(data->inv);
+  free(data->conj);
+  free(data->order);
   free(data);
 }
 
@@ -73,13 +80,34 @@ void group_from_tables(group_t *memo,
                        uint8_t *mul,
                        uint8_t *inv_mul)
 {
-  struct group_memo_data_t *data = malloc(sizeof(struct group_memo_data_t));
+  group_table_t *data = malloc(sizeof(group_table_t));
   data->mul = mul;
   data->inv_mul = inv_mul;
   data->num = num;
 
+  /* the inverse of x is x' 0 */
+  data->inv = malloc(num);
+  memcpy(data->inv, inv_mul, num);
+
+  /* y' x y, computed as (x' y)' y to read both tables by row */
+  data->conj = malloc(num * num);
+  for (unsigned int y = 0; y < num; y++) {
+    for (unsigned int x = 0; x < num; x++) {
+      unsigned int z = inv_mul[x + y * num];
+      data->conj[x + y * num] = mul[data->inv[z] + y * num];
+    }
+  }
+
+  data->order = malloc(num);
+  for (unsigned int x = 0; x < num; x++) {
+    unsigned int order = 1;
+    for (unsigned int y = x; y != 0; y = mul[y + x * num]) order++;
+    data->order[x] = order;
+  }
+
   memo->num = num;
   memo->data = data;
+  memo->table = data;
   memo->mul = group_memo_mul;
   memo->inv_mul = group_memo_inv_mul;
   memo->cleanup = group_memo_cleanup;
@@ -116,38 +144,72 @@ void group_memo(group_t *memo, group_t *group)
   group_from_tables(memo, group->num, table, inv_table);
 }
 
+/* Symmetric groups whose multiplication table fits the element type
+   of group_table_t are memoised. */
+#define GROUP_PERM_MEMO_MAX 5
+
+/* Larger groups must have an order that fits an unsigned int. */
+#define GROUP_PERM_MAX 12
+
 static unsigned int group_perm_mul(void *data_, unsigned int x, unsigned int y)
 {
   unsigned int *data = data_;
   unsigned int n = *data;
 
-  uint8_t *perm1 = malloc(n);
-  uint8_t *perm2 = malloc(n);
+  uint8_t perm1[GROUP_PERM_MAX];
+  uint8_t perm2[GROUP_PERM_MAX];
 
   perm_from_index(perm1, n, x, n);
   perm_from_index(perm2, n, y, n);
 
   perm_mul(perm1, perm2, n);
 
-  unsigned int z = perm_index(perm1, n, n);
+  return perm_index(perm1, n, n);
+}
+
+static unsigned int group_perm_inv_mul(void *data_, unsigned int x, unsigned int y)
+{
+  unsigned int *data = data_;
+  unsigned int n = *data;
+
+  uint8_t perm1[GROUP_PERM_MAX];
+  uint8_t perm2[GROUP_PERM_MAX];
+
+  perm_from_index(perm1, n, x, n);
+  perm_from_index(perm2, n, y, n);
 
-  free(perm1);
-  free(perm2);
+  perm_lmul_inv(perm2, perm1, n);
 
-  return z;
+  return perm_index(perm2, n, n);
 }
 
-void group_perm(group_t *group, unsigned int n)
+static void group_perm_direct(group_t *group, unsigned int n)
 {
   group->num = 1;
-  for (unsigned int i = 2; i < n; i++) group->num *= i;
+  for (unsigned int i = 2; i <= n; i++) group->num *= i;
 
   unsigned int *data = malloc(sizeof(unsigned int));
   *data = n;
   group->data = data;
   group->cleanup = free;
   group->mul = group_perm_mul;
-  group->inv_mul = 0;
+  group->inv_mul = group_perm_inv_mul;
+  group->table = 0;
+}
+
+void group_perm(group_t *group, unsigned int n)
+{
+  assert(n <= GROUP_PERM_MAX);
+
+  if (n <= GROUP_PERM_MEMO_MAX) {
+    group_t direct;
+    group_perm_direct(&direct, n);
+    group_memo(group, &direct);
+    group_cleanup(&direct);
+  }
+  else {
+    group_perm_direct(group, n);
+  }
 }
 
 static unsigned int group_u16_mul(void *data, unsigned int x, unsigned int y)
@@ -162,6 +224,7 @@ void group_u16(group_t *group, unsigned int n)
   group->cleanup = free;
   group->mul = group_u16_mul;
   group->inv_mul = group_u16_mul;
+  group->table = 0;
 }
 
 void group_inv_table(uint8_t *inv_mul, uint8_t *mul, unsigned int n)
@@ -201,6 +264,7 @@ void group_cyclic_subgroup(group_t *group,
                            uint8_t *elems, unsigned int num,
                            unsigned int gen)
 {
+  assert(num == group_order(group, gen));
   elems[0] = 0;
   for (unsigned int i = 1; i < num; i++) {
     elems[i] = group_mul(group, elems[i - 1], gen);
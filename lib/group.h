@@ -3,9 +3,61 @@
 
 #include <stdint.h>
 
+/* Multiplication tables of a group with at most 256 elements. The
+   product x y is at index x + y * num of mul, x' y at index x + y *
+   num of inv_mul, and the conjugate y' x y at index x + y * num of
+   conj. The inverse and the order of x are at index x of inv and
+   order respectively. */
+struct group_table_t
+{
+  unsigned int num;
+  uint8_t *mul;
+  uint8_t *inv_mul;
+  uint8_t *inv;
+  uint8_t *conj;
+  uint8_t *order;
+};
+typedef struct group_table_t group_table_t;
+
+static inline unsigned int group_table_mul(const group_table_t *table,
+                                           unsigned int x, unsigned int y)
+{
+  return table->mul[x + y * table->num];
+}
+
+static inline unsigned int group_table_inv_mul(const group_table_t *table,
+                                               unsigned int x, unsigned int y)
+{
+  return table->inv_mul[x + y * table->num];
+}
+
+static inline unsigned int group_table_inv(const group_table_t *table,
+                                           unsigned int x)
+{
+  return table->inv[x];
+}
+
+/* y' x y */
+static inline unsigned int group_table_conj(const group_table_t *table,
+                                            unsigned int x, unsigned int y)
+{
+  return table->conj[x + y * table->num];
+}
+
+static inline unsigned int group_table_order(const group_table_t *table,
+                                             unsigned int x)
+{
+  return table->order[x];
+}
+
 /* A group structure on the natural numbers below num.
    mul is the operation of the group, inv the inverse. The unit
-   element is 0. */
+   element is 0.
+
+   Groups obtained from group_memo and group_from_table also have
+   multiplication tables, which should be used instead of the
+   function pointers in performance critical code. For other groups,
+   table is null. */
 struct group_t
 {
   unsigned int num;
@@ -13,6 +65,7 @@ struct group_t
   unsigned int (*inv_mul)(void *data, unsigned int x, unsigned int y);
   void (*cleanup)(void *data);
   void *data;
+  group_table_t *table;
 };
 typedef struct group_t group_t;
 
@@ -20,6 +73,7 @@ unsigned int group_inv(group_t *group, unsigned int x);
 unsigned int group_inv_mul(group_t *group, unsigned int x, unsigned int y);
 unsigned int group_mul(group_t *group, unsigned int x, unsigned int y);
 unsigned int group_conj(group_t *group, unsigned int x, unsigned int y);
+unsigned int group_order(group_t *group, unsigned int x);
 void group_cleanup(group_t *group);
 void group_memo(group_t *memo, group_t *group);
 
@@ -41,6 +95,11 @@ void group_cyclic_subgroup(group_t *group,
                            uint8_t *elems, unsigned int num,
                            unsigned int gen);
 
+/* The symmetric group on n elements, with permutations numbered by
+   perm_index. It has multiplication tables for n up to 5, and n can
+   be at most 12. */
+void group_perm(group_t *group, unsigned int n);
+
 void group_a4_init(group_t *group);
 
 #endif /* GROUP_H */
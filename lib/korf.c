@@ -0,0 +1,401 @@
+#include "korf.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "group.h"
+#include "notation.h"
+#include "search.h"
+#include "utils.h"
+
+#define KORF_MAGIC 0x46524f4b /* "KORF" */
+#define KORF_VERSION 2
+
+static inline uint64_t corner_index(unsigned int cperm, unsigned int twist)
+{
+  return (uint64_t) cperm * CUBIES_NUM_TWISTS + twist;
+}
+
+/* Index of the tracked edges with the given codes, from their
+   positions, as a partial permutation of the 12 positions, and their
+   orientations. */
+static inline uint64_t edge_index(korf_t *solver, const uint8_t *codes)
+{
+  unsigned int n = solver->num_edges;
+  unsigned int used = 0;
+  uint64_t perm = 0;
+  unsigned int ori = 0;
+  for (unsigned int i = 0; i < n; i++) {
+    unsigned int p = codes[i] >> 1;
+    perm = perm * (12 - i) + p - __builtin_popcount(used & ((1 << p) - 1));
+    used |= 1 << p;
+    ori |= (codes[i] & 1) << i;
+  }
+  return (perm << n) | ori;
+}
+
+static void edge_codes(korf_t *solver, uint8_t *codes, uint64_t index)
+{
+  unsigned int n = solver->num_edges;
+  uint64_t perm = index >> n;
+  uint8_t digits[KORF_MAX_EDGES];
+  for (unsigned int i = n; i-- > 0;) {
+    digits[i] = perm % (12 - i);
+    perm /= 12 - i;
+  }
+
+  unsigned int used = 0;
+  for (unsigned int i = 0; i < n; i++) {
+    /* position digits[i] among the unused ones */
+    unsigned int p = 0;
+    for (unsigned int k = digits[i];; p++) {
+      if ((used >> p) & 1) continue;
+      if (k-- == 0) break;
+    }
+    used |= 1 << p;
+    codes[i] = 2 * p + ((index >> i) & 1);
+  }
+}
+
+static void corner_expand(void *data, uint64_t i, uint64_t *next)
+{
+  korf_t *solver = data;
+  unsigned int cperm = i / CUBIES_NUM_TWISTS;
+  unsigned int twist = i % CUBIES_NUM_TWISTS;
+  for (unsigned int m = 0; m < CUBIES_NUM_MOVES; m++) {
+    next[m] =
+      corner_index(solver->cperm_move[cperm * CUBIES_NUM_MOVES + m],
+                   solver->twist_move[twist * CUBIES_NUM_MOVES + m]);
+  }
+}
+
+static void edge_expand(void *data, uint64_t i, uint64_t *next)
+{
+  korf_t *solver = data;
+  uint8_t codes[KORF_MAX_EDGES];
+  uint8_t codes1[KORF_MAX_EDGES];
+  edge_codes(solver, codes, i);
+  for (unsigned int m = 0; m < CUBIES_NUM_MOVES; m++) {
+    for (unsigned int k = 0; k < solver->num_edges; k++) {
+      codes1[k] =
+        solver->code_move[(k * 24 + codes[k]) * CUBIES_NUM_MOVES + m];
+    }
+    next[m] = edge_index(solver, codes1);
+  }
+}
+
+void korf_init(korf_t *solver, puzzle_action_t *action, cube_shape_t *shape,
+               unsigned int num_edges)
+{
+  assert(num_edges >= 6 && num_edges <= KORF_MAX_EDGES);
+  cubies_t *cubies = &solver->cubies;
+  group_table_t *table = &action->table;
+  cubies_init(cubies, action, shape);
+  solver->num_edges = num_edges;
+
+  /* edges in layer 0 of face 2, then middle layer edges */
+  unsigned int n = 0;
+  for (unsigned int x = 0; x < 12; x++) {
+    if ((cubies->edge_layer[2] >> x) & 1) solver->edges[0][n++] = x;
+  }
+  static const uint8_t middle[3][2] = { { 4, 1 }, { 4, 0 }, { 5, 1 } };
+  for (unsigned int k = 0; n < num_edges; k++) {
+    unsigned int mask = cubies->slice_edges &
+      cubies->edge_layer[middle[k][0]] & cubies->edge_layer[middle[k][1]];
+    assert(mask != 0 && (mask & (mask - 1)) == 0);
+    solver->edges[0][n++] = __builtin_ctz(mask);
+  }
+
+  /* The half turn r maps edge x to the edge y at the position of x r,
+     and the edge of the second group with symmetry g to edge y with
+     symmetry s_y r' s_x' g r, where s_x and s_y are the symmetries of
+     the solved edges, which is conjugating the configuration by r. */
+  unsigned int r = puzzle_action_stab(action, 2, 0, 2);
+  unsigned int covered = 0;
+  for (unsigned int i = 0; i < num_edges; i++) {
+    unsigned int y = solver->edges[0][i];
+    unsigned int sy = action->by_stab[1][y];
+    unsigned int x = cubies->edge_pos[group_table_mul(table, sy, r)];
+    unsigned int sx = action->by_stab[1][x];
+    solver->edges[1][i] = x;
+    covered |= (1 << x) | (1 << y);
+
+    unsigned int k = group_table_mul(table, group_table_mul(table, sy,
+                                     group_table_inv(table, r)),
+                                     group_table_inv(table, sx));
+    for (unsigned int g = 0; g < 24; g++) {
+      unsigned int g1 = group_table_mul(table, group_table_mul(table, k, g),
+                                        r);
+      solver->edge_code[i * 24 + g] =
+        2 * cubies->edge_pos[g] + cubies->edge_ori[y * 24 + g];
+      solver->edge_code[(num_edges + i) * 24 + g] =
+        2 * cubies->edge_pos[g1] + cubies->edge_ori[y * 24 + g1];
+    }
+  }
+  assert(covered == 0xfff);
+
+  for (unsigned int i = 0; i < 2 * num_edges; i++) {
+    for (unsigned int g = 0; g < 24; g++) {
+      unsigned int code = solver->edge_code[i * 24 + g];
+      for (unsigned int m = 0; m < CUBIES_NUM_MOVES; m++) {
+        unsigned int g1 = g;
+        if ((cubies->edge_layer[m / 3] >> cubies->edge_pos[g]) & 1) {
+          g1 = group_table_mul(table, g, cubies->t[m]);
+        }
+        solver->code_move[(i * 24 + code) * CUBIES_NUM_MOVES + m] =
+          solver->edge_code[i * 24 + g1];
+      }
+    }
+  }
+
+  uint8_t moves[CUBIES_NUM_MOVES];
+  for (unsigned int m = 0; m < CUBIES_NUM_MOVES; m++) moves[m] = m;
+  solver->twist_move =
+    cubies_move_table_new(cubies, CUBIES_NUM_TWISTS, moves,
+                          CUBIES_NUM_MOVES, cubies_twist, cubies_set_twist);
+  solver->cperm_move =
+    cubies_move_table_new(cubies, CUBIES_NUM_CPERMS, moves,
+                          CUBIES_NUM_MOVES, cubies_cperm, cubies_set_cperm);
+
+  uint64_t num_edge_states = 1ull << num_edges;
+  for (unsigned int i = 0; i < num_edges; i++) num_edge_states *= 12 - i;
+  dist_table_init(&solver->corner_db, KORF_NUM_CORNER_STATES, 4);
+  dist_table_init(&solver->edge_db, num_edge_states, 4);
+}
+
+void korf_cleanup(korf_t *solver)
+{
+  free(solver->twist_move);
+  free(solver->cperm_move);
+  dist_table_cleanup(&solver->corner_db);
+  dist_table_cleanup(&solver->edge_db);
+}
+
+void korf_build(korf_t *solver, unsigned int num_threads)
+{
+  uint8_t c[CUBIES_NUM];
+  cubies_solved(&solver->cubies, c);
+  uint8_t codes[KORF_MAX_EDGES];
+  for (unsigned int i = 0; i < solver->num_edges; i++) {
+    codes[i] = solver->edge_code[i * 24 + c[8 + solver->edges[0][i]]];
+  }
+
+  dist_table_build(&solver->corner_db,
+                   corner_index(cubies_cperm(&solver->cubies, c),
+                                cubies_twist(&solver->cubies, c)),
+                   CUBIES_NUM_MOVES, corner_expand, 0, solver, num_threads);
+  dist_table_build(&solver->edge_db, edge_index(solver, codes),
+                   CUBIES_NUM_MOVES, edge_expand, 0, solver, num_threads);
+}
+
+/* The file starts with little endian 32-bit words: magic, version and
+   number of edges, followed by the corner and edge databases as saved
+   by dist_table_save. */
+#define KORF_PREFIX_SIZE 12
+
+static void korf_prefix(korf_t *solver, uint8_t *prefix)
+{
+  put_u32(&prefix[0], KORF_MAGIC);
+  put_u32(&prefix[4], KORF_VERSION);
+  put_u32(&prefix[8], solver->num_edges);
+}
+
+int korf_save(korf_t *solver, const char *path)
+{
+  dist_table_t *tables[2] = { &solver->corner_db, &solver->edge_db };
+  uint8_t prefix[KORF_PREFIX_SIZE];
+  korf_prefix(solver, prefix);
+  return dist_table_save(tables, 2, path, prefix, KORF_PREFIX_SIZE);
+}
+
+int korf_load(korf_t *solver, const char *path)
+{
+  dist_table_t *tables[2] = { &solver->corner_db, &solver->edge_db };
+  uint8_t prefix[KORF_PREFIX_SIZE];
+  korf_prefix(solver, prefix);
+  return dist_table_load(tables, 2, path, prefix, KORF_PREFIX_SIZE);
+}
+
+struct korf_search_t
+{
+  korf_t *solver;
+  uint64_t max_nodes;
+  uint64_t num_nodes;
+
+  unsigned int length;
+  uint8_t moves[KORF_MAX_LENGTH];
+};
+
+/* Search for a solution of depth moves. Return 1 if one was found, 0
+   if there is none, and -1 if the node limit was reached. */
+static int korf_search(struct korf_search_t *search,
+                       unsigned int cperm, unsigned int twist,
+                       const uint8_t *codes, unsigned int depth,
+                       unsigned int n)
+{
+  korf_t *solver = search->solver;
+  unsigned int num_edges = solver->num_edges;
+
+  if (search->max_nodes && search->num_nodes >= search->max_nodes) return -1;
+  search->num_nodes++;
+
+  dist_table_t *edge_db = &solver->edge_db;
+  if (dist_table_get(&solver->corner_db, corner_index(cperm, twist)) > depth ||
+      dist_table_get(edge_db, edge_index(solver, codes)) > depth ||
+      dist_table_get(edge_db, edge_index(solver, codes + num_edges)) > depth)
+    return 0;
+  if (depth == 0) {
+    search->length = n;
+    return 1;
+  }
+
+  uint8_t codes1[2 * KORF_MAX_EDGES];
+  for (unsigned int m = 0; m < CUBIES_NUM_MOVES; m++) {
+    if (n > 0 && !cubies_move_allowed(search->moves[n - 1], m)) continue;
+    search->moves[n] = m;
+    for (unsigned int i = 0; i < 2 * num_edges; i++) {
+      codes1[i] =
+        solver->code_move[(i * 24 + codes[i]) * CUBIES_NUM_MOVES + m];
+    }
+    int r = korf_search(search,
+                        solver->cperm_move[cperm * CUBIES_NUM_MOVES + m],
+                        solver->twist_move[twist * CUBIES_NUM_MOVES + m],
+                        codes1, depth - 1, n + 1);
+    if (r != 0) return r;
+  }
+
+  return 0;
+}
+
+/* Set the coordinates of conf, and return the rotation bringing its
+   centres in place, or -1 if conf cannot be solved. */
+static int korf_coords(korf_t *solver, uint8_t *conf, unsigned int *cperm,
+                       unsigned int *twist, uint8_t *codes)
+{
+  cubies_t *cubies = &solver->cubies;
+  uint8_t c[CUBIES_NUM];
+  int h = cubies_from_conf(cubies, c, conf);
+  if (h < 0) return -1;
+
+  *cperm = cubies_cperm(cubies, c);
+  *twist = cubies_twist(cubies, c);
+  for (unsigned int i = 0; i < 2 * solver->num_edges; i++) {
+    unsigned int k = i / solver->num_edges;
+    unsigned int x = solver->edges[k][i % solver->num_edges];
+    codes[i] = solver->edge_code[i * 24 + c[8 + x]];
+  }
+  return h;
+}
+
+int korf_solve(korf_t *solver, move_seq_t *seq, uint8_t *conf,
+               unsigned int max_length, uint64_t max_nodes,
+               uint64_t *num_nodes)
+{
+  cubies_t *cubies = &solver->cubies;
+  struct korf_search_t search;
+  search.solver = solver;
+  search.max_nodes = max_nodes;
+  search.num_nodes = 0;
+
+  unsigned int cperm, twist;
+  uint8_t codes[2 * KORF_MAX_EDGES];
+  int h = korf_coords(solver, conf, &cperm, &twist, codes);
+  if (h < 0) return -1;
+
+  if (max_length > KORF_MAX_LENGTH) max_length = KORF_MAX_LENGTH;
+  int found = 0;
+  for (unsigned int depth = 0; depth <= max_length && !found; depth++) {
+    found = korf_search(&search, cperm, twist, codes, depth, 0);
+  }
+
+  if (num_nodes) *num_nodes += search.num_nodes;
+  if (found <= 0) return -1;
+
+  cubies_push_moves(cubies, seq, search.moves, search.length, h);
+  return search.length;
+}
+
+/* states of the parallel search */
+struct korf_state_t
+{
+  uint16_t cperm;
+  uint16_t twist;
+  uint8_t codes[2 * KORF_MAX_EDGES];
+};
+
+static int korf_state_move(void *data, const void *state_, unsigned int m,
+                           void *next_)
+{
+  korf_t *solver = data;
+  const struct korf_state_t *state = state_;
+  struct korf_state_t *next = next_;
+
+  next->cperm = solver->cperm_move[state->cperm * CUBIES_NUM_MOVES + m];
+  next->twist = solver->twist_move[state->twist * CUBIES_NUM_MOVES + m];
+  for (unsigned int i = 0; i < 2 * solver->num_edges; i++) {
+    next->codes[i] =
+      solver->code_move[(i * 24 + state->codes[i]) * CUBIES_NUM_MOVES + m];
+  }
+  return 1;
+}
+
+static unsigned int korf_state_heuristic(void *data, const void *state_,
+                                         unsigned int bound)
+{
+  korf_t *solver = data;
+  const struct korf_state_t *state = state_;
+  unsigned int h = dist_table_get(&solver->corner_db,
+                                  corner_index(state->cperm, state->twist));
+  for (unsigned int k = 0; k < 2 && h <= bound; k++) {
+    unsigned int e = dist_table_get(&solver->edge_db,
+                                    edge_index(solver, state->codes +
+                                               k * solver->num_edges));
+    if (e > h) h = e;
+  }
+  return h;
+}
+
+/* the corners and both groups of edges, which cover all the edges, are
+   solved */
+static int korf_state_goal(void *data, const void *state)
+{
+  return korf_state_heuristic(data, state, 0) == 0;
+}
+
+static int korf_state_allowed(void *data, unsigned int last, unsigned int m)
+{
+  return cubies_move_allowed(last, m);
+}
+
+void korf_search_init(korf_t *solver, search_t *search,
+                      unsigned int num_threads, unsigned int split_depth)
+{
+  search_init(search, sizeof(struct korf_state_t), CUBIES_NUM_MOVES,
+              korf_state_move, solver, korf_state_heuristic,
+              korf_state_goal, korf_state_allowed, solver, num_threads,
+              split_depth);
+}
+
+int korf_solve_parallel(korf_t *solver, search_t *search, move_seq_t *seq,
+                        uint8_t *conf, unsigned int max_length,
+                        uint64_t *num_nodes)
+{
+  struct korf_state_t state;
+  unsigned int cperm, twist;
+  memset(&state, 0, sizeof(state));
+  int h = korf_coords(solver, conf, &cperm, &twist, state.codes);
+  if (h < 0) return -1;
+  state.cperm = cperm;
+  state.twist = twist;
+
+  if (max_length > KORF_MAX_LENGTH) max_length = KORF_MAX_LENGTH;
+  search_result_t result;
+  search_result_init(&result);
+  int n = search_run(search, &state, max_length, 0, &result);
+  if (num_nodes) *num_nodes += result.num_nodes;
+  if (n >= 0) cubies_push_moves(&solver->cubies, seq, result.moves, n, h);
+  search_result_cleanup(&result);
+
+  return n;
+}
@@ -0,0 +1,109 @@
+#ifndef KORF_H
+#define KORF_H
+
+#include <stdint.h>
+
+#include "cubies.h"
+#include "dist_table.h"
+
+struct move_seq_t;
+typedef struct move_seq_t move_seq_t;
+
+struct search_t;
+typedef struct search_t search_t;
+
+/* Optimal solver for the 3x3x3 cube.
+
+An iterative deepening A* search, where the number of moves left is
+bounded below by the number of moves needed to solve the corners, and
+to solve either of two groups of edges. These distances are read from
+pattern databases built by breadth-first searches, with 4 bits per
+configuration.
+
+The corner database is indexed by permutation, then orientation. The
+first group of edges consists of the edges in layer 0 of face 2 and
+the first num_edges - 4 middle layer edges in the order of faces 4 and
+1, 4 and 0, 5 and 1; the second group is its image by a half turn of
+the whole cube around the axis of faces 0 and 1, so that both groups
+cover all the edges. Conjugating a configuration by that half turn
+maps the second group onto the first one, and distances of both groups
+are read from a single edge database. It is indexed by the positions
+of the edges of the first group, then their orientations.
+
+Moves and orientations are those of cubies.h. */
+
+#define KORF_MAX_EDGES 7
+#define KORF_NUM_CORNER_STATES (CUBIES_NUM_CPERMS * CUBIES_NUM_TWISTS)
+
+/* maximum length of a solution */
+#define KORF_MAX_LENGTH 26
+
+struct korf_t
+{
+  cubies_t cubies;
+
+  /* number of edges of every group, and the edges of each group, the
+     edge at index i of the second group being the image of the one at
+     index i of the first group */
+  unsigned int num_edges;
+  uint8_t edges[2][KORF_MAX_EDGES];
+
+  /* Edges are tracked as 2 * position + orientation, of the edges of
+     the first group, followed by the conjugated edges of the second
+     group. For tracked edge i, the code of the edge with symmetry g at
+     index i * 24 + g, and the code after move m at index (i * 24 +
+     code) * CUBIES_NUM_MOVES + m. */
+  uint8_t edge_code[2 * KORF_MAX_EDGES * 24];
+  uint8_t code_move[2 * KORF_MAX_EDGES * 24 * CUBIES_NUM_MOVES];
+
+  /* corner coordinates after move m, at index coordinate *
+     CUBIES_NUM_MOVES + m */
+  uint16_t *twist_move;
+  uint16_t *cperm_move;
+
+  /* distances, 4 bits each */
+  dist_table_t corner_db;
+  dist_table_t edge_db;
+};
+typedef struct korf_t korf_t;
+
+/* Compute the move tables for the 3x3x3 cube of shape, with groups of
+   num_edges edges, between 6 and KORF_MAX_EDGES. The databases are
+   empty until korf_build or korf_load is called. */
+void korf_init(korf_t *solver, puzzle_action_t *action, cube_shape_t *shape,
+               unsigned int num_edges);
+void korf_cleanup(korf_t *solver);
+
+/* Fill the databases using num_threads threads, or one per processor
+   if it is 0. */
+void korf_build(korf_t *solver, unsigned int num_threads);
+
+/* Save the databases, or load ones saved with the same number of
+   edges. Return 0 on error. */
+int korf_save(korf_t *solver, const char *path);
+int korf_load(korf_t *solver, const char *path);
+
+/* Append an optimal solution of conf to seq, followed by a rotation of
+   the whole cube if its centres are not in place. Return the number
+   of moves, or -1 if conf cannot be solved or no solution of at most
+   max_length moves was found within max_nodes nodes, unless max_nodes
+   is 0. The number of nodes visited is added to *num_nodes if
+   num_nodes is not null. Databases are only read, so several threads
+   can solve at the same time. */
+int korf_solve(korf_t *solver, move_seq_t *seq, uint8_t *conf,
+               unsigned int max_length, uint64_t max_nodes,
+               uint64_t *num_nodes);
+
+/* Initialise a parallel search on the databases of solver, with
+   num_threads threads, or one per processor if it is 0, and tasks of
+   split_depth moves. */
+void korf_search_init(korf_t *solver, search_t *search,
+                      unsigned int num_threads, unsigned int split_depth);
+
+/* Same as korf_solve, with a search initialised by korf_search_init,
+   and without limit on the number of nodes. */
+int korf_solve_parallel(korf_t *solver, search_t *search, move_seq_t *seq,
+                        uint8_t *conf, unsigned int max_length,
+                        uint64_t *num_nodes);
+
+#endif /* KORF_H */
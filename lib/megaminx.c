@@ -7,10 +7,114 @@
 
 #include "abs_poly.h"
 #include "group.h"
+#include "move_table.h"
 #include "perm.h"
 #include "puzzle.h"
 #include "utils.h"
 
+static void dodecahedron_group_init(group_t *group, abs_poly_t *dodec, poly_data_t *data)
+{
+  static const unsigned int num = 60;
+  uint8_t *mul = malloc(num * num);
+
+  for (unsigned int s = 0; s < num; s++) {
+    uint8_t *table = &mul[num * s];
+
+    unsigned int f0 = s / 5;
+    unsigned int vi = s % 5;
+
+    for (unsigned int j = 0; j < 5; j++) {
+      table[j] = f0 * 5 + (vi + j) % 5;
+      table[5 + j] = (f0 ^ 1) * 5 + (5 - vi + j) % 5;
+    }
+
+    int vi0 = data->adj[f0 * dodec->num_vertices + data->first_vertex[f0]];
+    assert(vi0 != -1);
+    for (unsigned int i = 0; i < 5; i++) {
+      unsigned int v = dodec->faces[f0].vertices[(vi0 + vi + i) % 5];
+      unsigned int w = dodec->faces[f0].vertices[(vi0 + vi + i + 1) % 5];
+      unsigned int f1 = data->edges[w * dodec->num_vertices + v];
+
+      int wi0 = data->adj[f1 * dodec->num_vertices + data->first_vertex[f1]];
+      assert(wi0 != -1);
+      int wi = data->adj[f1 * dodec->num_vertices + w];
+      assert(wi != -1);
+
+      for (unsigned int j = 0; j < 5; j++) {
+        table[10 * i + 10 + j] = f1 * 5 + (wi - wi0 + j + 5) % 5;
+        table[10 * i + 15 + j] = (f1 ^ 1) * 5 + (wi0 - wi + j + 5) % 5;
+      }
+    }
+  }
+
+  group_from_table(group, num, mul);
+}
+
+void megaminx_action_init(puzzle_action_t *puzzle, abs_poly_t *dodec, poly_data_t *data)
+{
+  const unsigned int num_syms = 60;
+  unsigned int orbit_size[] = { 20, 30, 12 };
+  unsigned int stab_gen[] = { 50, 10, 1};
+
+  group_t *group = malloc(sizeof(group_t));
+  dodecahedron_group_init(group, dodec, data);
+
+  uint8_t *orbit[3];
+  uint8_t *stab[3];
+
+  for (unsigned int k = 0; k < 3; k++) {
+    orbit[k] = malloc(orbit_size[k]);
+    memset(orbit[k], num_syms, orbit_size[k]);
+
+    stab[k] = malloc(num_syms / orbit_size[k]);
+    group_cyclic_subgroup(group, stab[k],
+                          num_syms / orbit_size[k],
+                          stab_gen[k]);
+  }
+
+  /* faces */
+  for (unsigned int i = 0; i < orbit_size[2]; i++) {
+    orbit[2][i] = i * 5;
+  }
+
+  /* vertices */
+  {
+    for (unsigned int j = 0; j < orbit_size[2]; j++) {
+      unsigned int n = dodec->faces[j].num_vertices;
+      for (unsigned int i = 0; i < n; i++) {
+        unsigned int v = dodec->faces[j].vertices[i];
+        unsigned int f = j;
+        if (orbit[0][v] != num_syms) continue;
+        int i0 = data->adj[f * dodec->num_vertices + data->first_vertex[f]];
+        assert(i0 != -1);
+        unsigned int s = f * 5 + (i - i0 + 5) % 5;
+        orbit[0][v] = s;
+      }
+    }
+  }
+
+  /* edges */
+  {
+    unsigned int index = 0;
+    for (unsigned int f = 0; f < dodec->num_faces; f++) {
+      unsigned int n = dodec->faces[f].num_vertices;
+      int vi0 = data->adj[f * dodec->num_vertices + data->first_vertex[f]];
+      for (unsigned int i = 0; i < n; i++) {
+        unsigned int f1 = abs_poly_get_adj_face(dodec, f, i, data->edges);
+        if (f1 < f) continue;
+        orbit[1][data->edges_by_face[f][i]] = f * 5 + (i - vi0 + 5) % 5;
+      }
+    }
+  }
+
+  puzzle_action_init(puzzle, 3, orbit_size, group, orbit, stab);
+
+  for (unsigned int k = 0; k < 3; k++) {
+    free(stab[k]);
+    free(orbit[k]);
+  }
+}
+
 uint8_t *megaminx_new(puzzle_action_t *action)
 {
   uint8_t *conf = malloc(action->decomp.num_pieces);
@@ -25,11 +129,8 @@ uint8_t *megaminx_new(puzzle_action_t *action)
 
 static int in_layer(puzzle_action_t *action, unsigned int k, unsigned int f, unsigned int g)
 {
-  unsigned int f1 =
-    decomp_local(&action->decomp,
-                 puzzle_action_act(action,
-                            decomp_global(&action->decomp, 2, f),
-                            group_inv(action->group, g)));
+  unsigned int f1 = puzzle_action_local_act
+    (action, 2, f, group_table_inv(&action->table, g));
   switch (k) {
   case 0:
     return f1 == 0 || f1 == 2 || f1 == 10;
@@ -45,6 +146,19 @@ static int in_layer(puzzle_action_t *action, unsigned int k, unsigned int f, uns
   return 0;
 }
 
+static int megaminx_move_table_in_layer(void *data, unsigned int k,
+                                        unsigned int g, unsigned int f,
+                                        unsigned int l)
+{
+  return l == 0 && in_layer(data, k, f, g);
+}
+
+void megaminx_move_table_init(move_table_t *table, puzzle_action_t *action)
+{
+  move_table_init(table, action, &action->decomp, 2, 1,
+                  megaminx_move_table_in_layer, action);
+}
+
 turn_t *megaminx_move_(puzzle_action_t *action, uint8_t *conf,
                        unsigned int f, int c)
 {
@@ -54,33 +168,39 @@ turn_t *megaminx_move_(puzzle_action_t *action, uint8_t *conf,
 turn_t *megaminx_move(puzzle_action_t *action, uint8_t *conf1, uint8_t *conf,
                       unsigned int f, int c)
 {
-  turn_t *turn = malloc(sizeof(turn_t));
-  turn->pieces = malloc(action->decomp.num_pieces * sizeof(unsigned int));
-  turn->num_pieces = 0;
+  turn_t *turn = turn_new(action->decomp.num_pieces);
+  megaminx_apply(action, conf1, conf, f, c, turn);
+  return turn;
+}
 
-  turn->g = puzzle_action_stab(action, 2, f, c);
+void megaminx_apply(puzzle_action_t *action, uint8_t *conf1, uint8_t *conf,
+                    unsigned int f, int c, turn_t *turn)
+{
+  unsigned int g = puzzle_action_stab(action, 2, f, c);
+  if (turn) {
+    turn->g = g;
+    turn->num_pieces = 0;
+  }
 
   for (unsigned int k = 0; k < action->decomp.num_orbits; k++) {
     for (unsigned int i = 0; i < action->decomp.orbit_size[k]; i++) {
       unsigned int i0 = action->decomp.orbit_offset[k] + i;
       if (in_layer(action, k, f, conf[i0])) {
-        conf1[i0] = group_mul(action->group, conf[i0], turn->g);
-        turn->pieces[turn->num_pieces++] = i0;
+        conf1[i0] = group_table_mul(&action->table, conf[i0], g);
+        if (turn) turn->pieces[turn->num_pieces++] = i0;
       }
     }
   }
-
-  return turn;
 }
 
-void megaminx_scramble(puzzle_action_t *action, uint8_t *conf)
+void megaminx_scramble(puzzle_action_t *action, uint8_t *conf, rng_t *rng)
 {
   for (unsigned int k = 0; k < 2; k++) {
     unsigned int orb_size = action->decomp.orbit_size[k];
     unsigned int stab_size = action->group->num / orb_size;
     uint8_t *perm = malloc(orb_size);
     perm_id(perm, orb_size);
-    parity_shuffle(perm, orb_size, 0);
+    parity_shuffle(perm, orb_size, 0, rng);
 
     unsigned int total = 0;
     for (unsigned int i = 0; i < orb_size; i++) {
@@ -89,7 +209,7 @@ void megaminx_scramble(puzzle_action_t *action, uint8_t *conf)
         o = (stab_size - total % stab_size) % stab_size;
       }
       else {
-        o = rand() % stab_size;
+        o = rng_uniform(rng, stab_size);
         total += o;
       }
       conf[decomp_global(&action->decomp, k, i)] =
@@ -113,10 +233,19 @@ turn_t *megaminx_puzzle_move(void *data, uint8_t *conf,
   return megaminx_move_(action, conf, f, c);
 }
 
-void megaminx_puzzle_scramble(void *data, uint8_t *conf)
+int megaminx_puzzle_apply(void *data, uint8_t *conf,
+                          unsigned int f, unsigned int l, int c, turn_t *turn)
+{
+  puzzle_action_t *action = data;
+  if (l != 0) return 0;
+  megaminx_apply(action, conf, conf, f, c, turn);
+  return 1;
+}
+
+void megaminx_puzzle_scramble(void *data, uint8_t *conf, rng_t *rng)
 {
   puzzle_action_t *action = data;
-  megaminx_scramble(action, conf);
+  megaminx_scramble(action, conf, rng);
 }
 
 void megaminx_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action)
@@ -129,6 +258,7 @@ void megaminx_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action)
 
   puzzle->move = megaminx_puzzle_move;
   puzzle->move_data = action;
+  puzzle->apply = megaminx_puzzle_apply;
 
   puzzle->scramble = megaminx_puzzle_scramble;
   puzzle->scramble_data = action;
@@ -12,14 +12,39 @@ typedef struct puzzle_t puzzle_t;
 struct turn_t;
 typedef struct turn_t turn_t;
 
+struct rng_t;
+typedef struct rng_t rng_t;
+
+struct abs_poly_t;
+typedef struct abs_poly_t abs_poly_t;
+
+struct poly_data_t;
+typedef struct poly_data_t poly_data_t;
+
+/* Action of the rotation group of a dodecahedron on its vertices,
+   edges and faces, which are the orbits 0, 1 and 2 respectively. */
+void megaminx_action_init(puzzle_action_t *action, abs_poly_t *dodec,
+                          poly_data_t *data);
+
+struct move_table_t;
+typedef struct move_table_t move_table_t;
+
 uint8_t *megaminx_new(puzzle_action_t *action);
-void megaminx_scramble(puzzle_action_t *puzzle, uint8_t *mm);
+void megaminx_scramble(puzzle_action_t *puzzle, uint8_t *mm, rng_t *rng);
 
 turn_t *megaminx_move_(puzzle_action_t *action, uint8_t *conf,
                        unsigned int f, int c);
 turn_t *megaminx_move(puzzle_action_t *action, uint8_t *conf1, uint8_t *conf,
                       unsigned int f, int c);
 
+/* Non-allocating version of megaminx_move, recording the move in turn
+   unless it is null. */
+void megaminx_apply(puzzle_action_t *action, uint8_t *conf1, uint8_t *conf,
+                    unsigned int f, int c, turn_t *turn);
+
+/* precompiled face turns, on configurations in position form */
+void megaminx_move_table_init(move_table_t *table, puzzle_action_t *action);
+
 void megaminx_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action);
 
 #endif /* MEGAMINX_H */
@@ -0,0 +1,139 @@
+#include "move_table.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "group.h"
+#include "puzzle.h"
+
+void move_table_init(move_table_t *table,
+                     puzzle_action_t *action, decomp_t *decomp,
+                     unsigned int face_orbit, unsigned int num_layers,
+                     move_table_in_layer_t in_layer, void *data)
+{
+  group_table_t *group = &action->table;
+
+  table->num_syms = group->num;
+  table->num_slots = decomp->num_orbits * group->num;
+  table->num_faces = action->decomp.orbit_size[face_orbit];
+  table->num_layers = num_layers;
+  table->num_counts = group->num / table->num_faces;
+
+  unsigned int num_moves = table->num_faces * num_layers;
+  table->sym = malloc(table->num_faces * table->num_counts);
+  table->offset = malloc((num_moves + 1) * sizeof(unsigned int));
+
+  unsigned int num = 0;
+  unsigned int size = 64;
+  table->slots = malloc(size * sizeof(uint32_t));
+
+  uint8_t *visited = malloc(group->num);
+
+  for (unsigned int f = 0; f < table->num_faces; f++) {
+    unsigned int s = puzzle_action_stab(action, face_orbit, f, 1);
+    assert(group_table_order(group, s) == table->num_counts);
+
+    /* the cycles are rotated to obtain the other turns, which is only
+       correct if those are powers of s */
+    unsigned int t = 0;
+    for (unsigned int c = 0; c < table->num_counts; c++) {
+      table->sym[f * table->num_counts + c] =
+        puzzle_action_stab(action, face_orbit, f, c);
+      assert(table->sym[f * table->num_counts + c] == t);
+      t = group_table_mul(group, t, s);
+    }
+
+    for (unsigned int l = 0; l < num_layers; l++) {
+      unsigned int m = f * num_layers + l;
+      table->offset[m] = num;
+
+      for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+        if (decomp->orbit_size[k] == 0) continue;
+
+        memset(visited, 0, group->num);
+        for (unsigned int g = 0; g < group->num; g++) {
+          if (visited[g] || !in_layer(data, k, g, f, l)) continue;
+
+          for (unsigned int h = g; !visited[h];
+               h = group_table_mul(group, h, s)) {
+            assert(in_layer(data, k, h, f, l));
+            visited[h] = 1;
+
+            if (num == size) {
+              size *= 2;
+              table->slots = realloc(table->slots, size * sizeof(uint32_t));
+            }
+            table->slots[num++] = k * group->num + h;
+          }
+        }
+      }
+    }
+  }
+  table->offset[num_moves] = num;
+  table->slots = realloc(table->slots, num * sizeof(uint32_t));
+
+  free(visited);
+}
+
+void move_table_cleanup(move_table_t *table)
+{
+  free(table->sym);
+  free(table->offset);
+  free(table->slots);
+}
+
+void move_table_pos_from_conf(move_table_t *table, decomp_t *decomp,
+                              uint8_t *pos, uint8_t *conf)
+{
+  memset(pos, MOVE_TABLE_EMPTY, table->num_slots);
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    assert(decomp->orbit_size[k] < MOVE_TABLE_EMPTY);
+    uint8_t *orbit = &pos[k * table->num_syms];
+    for (unsigned int i = 0; i < decomp->orbit_size[k]; i++) {
+      unsigned int g = conf[decomp_global(decomp, k, i)];
+      assert(orbit[g] == MOVE_TABLE_EMPTY);
+      orbit[g] = i;
+    }
+  }
+}
+
+void move_table_conf_from_pos(move_table_t *table, decomp_t *decomp,
+                              uint8_t *conf, uint8_t *pos)
+{
+  for (unsigned int k = 0; k < decomp->num_orbits; k++) {
+    uint8_t *orbit = &pos[k * table->num_syms];
+    for (unsigned int g = 0; g < table->num_syms; g++) {
+      if (orbit[g] == MOVE_TABLE_EMPTY) continue;
+      conf[decomp_global(decomp, k, orbit[g])] = g;
+    }
+  }
+}
+
+unsigned int move_table_apply(move_table_t *table, uint8_t *pos,
+                              unsigned int f, unsigned int l, int c)
+{
+  unsigned int m = f * table->num_layers + l;
+  int n = table->num_counts;
+  c = ((c % n) + n) % n;
+  if (c == 0) return 0;
+
+  unsigned int len = n;
+  uint32_t *slots = &table->slots[table->offset[m]];
+  uint32_t *end = &table->slots[table->offset[m + 1]];
+
+  /* the piece in position j of a cycle moves to position j + c */
+  uint8_t tmp[256];
+  for (; slots < end; slots += len) {
+    for (unsigned int j = 0; j < len; j++) {
+      tmp[j] = pos[slots[j]];
+    }
+    unsigned int j1 = c;
+    for (unsigned int j = 0; j < len; j++) {
+      pos[slots[j1]] = tmp[j];
+      if (++j1 == len) j1 = 0;
+    }
+  }
+
+  return table->sym[f * n + c];
+}
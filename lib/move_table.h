@@ -0,0 +1,79 @@
+#ifndef MOVE_TABLE_H
+#define MOVE_TABLE_H
+
+#include <stdint.h>
+
+struct puzzle_action_t;
+typedef struct puzzle_action_t puzzle_action_t;
+
+struct decomp_t;
+typedef struct decomp_t decomp_t;
+
+/* Precompiled moves.
+
+A configuration assigns a symmetry to every piece, and the pieces of
+an orbit have distinct symmetries. A configuration can therefore also
+be given in position form: a map from pairs (k, g) of an orbit and a
+symmetry, which we call slots, to the piece of orbit k having
+symmetry g, if any.
+
+Whether a move affects a piece only depends on its orbit and its
+symmetry, and the move multiplies the symmetry of every affected
+piece by the same element s. In position form, a move is then a
+permutation of slots, mapping (k, g) to (k, g s). Its cycles all have
+the length of the order of s, and the cycles of the move repeated c
+times are obtained by rotating the same cycles by c steps. Therefore
+only the cycles of a single turn of every face and layer are stored. */
+
+/* content of a slot not occupied by any piece */
+#define MOVE_TABLE_EMPTY 0xff
+
+/* whether a piece of orbit k with symmetry g is in layer l of face f */
+typedef int (*move_table_in_layer_t)(void *data, unsigned int k,
+                                     unsigned int g, unsigned int f,
+                                     unsigned int l);
+
+struct move_table_t
+{
+  unsigned int num_syms;
+  unsigned int num_slots;
+
+  unsigned int num_faces;
+  unsigned int num_layers;
+  /* Number of distinct turns of a face, including the trivial one,
+     which is also the length of all cycles. */
+  unsigned int num_counts;
+
+  /* symmetry of c turns of face f, at index f * num_counts + c */
+  uint8_t *sym;
+
+  /* Cycles of each face and layer, from index offset[f * num_layers +
+     l] to the next offset of the slots array. Slot (k, g) has index k
+     * num_syms + g. */
+  unsigned int *offset;
+  uint32_t *slots;
+};
+typedef struct move_table_t move_table_t;
+
+/* Build the moves of a puzzle whose faces form orbit face_orbit of
+   the action, for the orbits of decomp, which might be finer than
+   those of the action. */
+void move_table_init(move_table_t *table,
+                     puzzle_action_t *action, decomp_t *decomp,
+                     unsigned int face_orbit, unsigned int num_layers,
+                     move_table_in_layer_t in_layer, void *data);
+void move_table_cleanup(move_table_t *table);
+
+/* Convert a configuration to and from position form. The position
+   form has num_slots entries, containing local piece indices. */
+void move_table_pos_from_conf(move_table_t *table, decomp_t *decomp,
+                              uint8_t *pos, uint8_t *conf);
+void move_table_conf_from_pos(move_table_t *table, decomp_t *decomp,
+                              uint8_t *conf, uint8_t *pos);
+
+/* Turn layer l of face f c times, on a configuration in position
+   form. Return the symmetry applied to the moved pieces. */
+unsigned int move_table_apply(move_table_t *table, uint8_t *pos,
+                              unsigned int f, unsigned int l, int c);
+
+#endif /* MOVE_TABLE_H */
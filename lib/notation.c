@@ -0,0 +1,339 @@
+#include "notation.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "group.h"
+#include "puzzle.h"
+
+void move_seq_init(move_seq_t *seq)
+{
+  seq->num = 0;
+  seq->size = 16;
+  seq->ops = malloc(seq->size * sizeof(move_op_t));
+}
+
+void move_seq_cleanup(move_seq_t *seq)
+{
+  free(seq->ops);
+}
+
+void move_seq_push(move_seq_t *seq, unsigned int face, unsigned int layer,
+                   int count)
+{
+  if (seq->num == seq->size) {
+    seq->size *= 2;
+    seq->ops = realloc(seq->ops, seq->size * sizeof(move_op_t));
+  }
+  seq->ops[seq->num++] = (move_op_t) {
+    .face = face,
+    .count = count,
+    .layer = layer
+  };
+}
+
+int move_op_apply(puzzle_t *puzzle, uint8_t *conf, move_op_t *op)
+{
+  if (op->face != MOVE_OP_ROTATION) {
+    return puzzle->apply(puzzle->move_data, conf,
+                         op->face, op->layer, op->count, 0);
+  }
+  for (unsigned int x = 0; x < puzzle->decomp->num_pieces; x++) {
+    conf[x] = group_mul(puzzle->group, conf[x], op->layer);
+  }
+  return 1;
+}
+
+unsigned int move_seq_apply(puzzle_t *puzzle, uint8_t *conf,
+                            move_seq_t *seq)
+{
+  for (unsigned int i = 0; i < seq->num; i++) {
+    if (!move_op_apply(puzzle, conf, &seq->ops[i])) return i;
+  }
+  return seq->num;
+}
+
+static void skip_space(const char **str)
+{
+  while (isspace((unsigned char) **str)) (*str)++;
+}
+
+/* Parse an optional number, returning def if there is none, and -1 if
+   it is larger than max. */
+static int parse_number(const char **str, int def, int max)
+{
+  if (!isdigit((unsigned char) **str)) return def;
+
+  int x = 0;
+  while (isdigit((unsigned char) **str)) {
+    x = 10 * x + (*(*str)++ - '0');
+    if (x > max) return -1;
+  }
+  return x;
+}
+
+/* Parse the amount of a turn, i.e. an optional number followed by an
+   optional prime, returning it as a number of clockwise turns, or 0 if
+   it is invalid. */
+static int parse_amount(const char **str)
+{
+  int amount = parse_number(str, 1, 64);
+  if (amount <= 0) return 0;
+  if (**str == '\'') {
+    (*str)++;
+    return -amount;
+  }
+  return amount;
+}
+
+/* cube */
+
+static void cube_push(notation_t *notation, move_seq_t *seq,
+                      unsigned int f, unsigned int l, int c)
+{
+  /* the last layer of a face is the first of the opposite one */
+  if (l == notation->n - 1) {
+    move_seq_push(seq, f ^ 1, 0, -c);
+  }
+  else {
+    move_seq_push(seq, f, l, c);
+  }
+}
+
+static int cube_parse(notation_t *notation, move_seq_t *seq,
+                      const char **str)
+{
+  static const char faces[] = "RLUDFB";
+  static const char slices[] = "MES";
+  static const char rotations[] = "xyz";
+  static const unsigned int slice_faces[] = { 1, 3, 4 };
+  static const unsigned int rotation_faces[] = { 0, 2, 4 };
+
+  unsigned int n = notation->n;
+  const char *s = *str;
+
+  int k = parse_number(&s, 0, n);
+  if (k < 0) return 0;
+
+  char ch = *s++;
+  if (ch == 0) return 0;
+  const char *p;
+  unsigned int f;
+  unsigned int first, last;
+
+  if ((p = strchr(faces, ch))) {
+    f = p - faces;
+    if (*s == 'w') {
+      s++;
+      first = 0;
+      last = (k ? k : 2) - 1;
+    }
+    else {
+      first = last = (k ? k : 1) - 1;
+    }
+  }
+  else if ((p = strchr(faces, toupper((unsigned char) ch)))) {
+    f = p - faces;
+    first = 0;
+    last = (k ? k : 2) - 1;
+  }
+  else if ((p = strchr(slices, ch))) {
+    if (k || n % 2 == 0) return 0;
+    f = slice_faces[p - slices];
+    first = last = (n - 1) / 2;
+  }
+  else if ((p = strchr(rotations, ch))) {
+    if (k) return 0;
+    int c = parse_amount(&s);
+    if (!c) return 0;
+    unsigned int sym = puzzle_action_stab(notation->action, 2,
+                                          rotation_faces[p - rotations], -c);
+    move_seq_push(seq, MOVE_OP_ROTATION, sym, 1);
+    *str = s;
+    return 1;
+  }
+  else {
+    return 0;
+  }
+
+  if (last >= n) return 0;
+  int c = parse_amount(&s);
+  if (!c) return 0;
+
+  /* positive counts are counterclockwise turns */
+  for (unsigned int l = first; l <= last; l++) {
+    cube_push(notation, seq, f, l, -c);
+  }
+
+  *str = s;
+  return 1;
+}
+
+void notation_cube_init(notation_t *notation, puzzle_action_t *action,
+                        unsigned int n)
+{
+  notation->parse = cube_parse;
+  notation->action = action;
+  notation->n = n;
+}
+
+/* megaminx */
+
+enum
+{
+  MEGAMINX_U = 0,
+  MEGAMINX_D = 1,
+  MEGAMINX_R = 2
+};
+
+/* rotate the whole puzzle around face f, keeping the opposite face
+   fixed */
+static void megaminx_push_rotation(notation_t *notation, move_seq_t *seq,
+                                   unsigned int f, int c)
+{
+  puzzle_action_t *action = notation->action;
+  unsigned int sym = puzzle_action_stab(action, 2, f, -c);
+  move_seq_push(seq, MOVE_OP_ROTATION, sym, 1);
+
+  unsigned int inv = group_table_inv(&action->table, sym);
+  for (int c1 = 0; c1 < 5; c1++) {
+    if (puzzle_action_stab(action, 2, f ^ 1, c1) == inv) {
+      move_seq_push(seq, f ^ 1, 0, c1);
+      return;
+    }
+  }
+  assert(0);
+}
+
+static int megaminx_parse(notation_t *notation, move_seq_t *seq,
+                          const char **str)
+{
+  const char *s = *str;
+
+  if (*s == 'R' || *s == 'D') {
+    unsigned int f = *s == 'R' ? MEGAMINX_R : MEGAMINX_D;
+    s++;
+    if ((s[0] != '+' && s[0] != '-') || s[1] != s[0]) return 0;
+    megaminx_push_rotation(notation, seq, f, s[0] == '+' ? 2 : -2);
+    s += 2;
+  }
+  else if (*s == 'U') {
+    s++;
+    int c = parse_amount(&s);
+    if (!c) return 0;
+    move_seq_push(seq, MEGAMINX_U, 0, -c);
+  }
+  else {
+    return 0;
+  }
+
+  *str = s;
+  return 1;
+}
+
+void notation_megaminx_init(notation_t *notation, puzzle_action_t *action)
+{
+  notation->parse = megaminx_parse;
+  notation->action = action;
+  notation->n = 0;
+}
+
+/* pyraminx */
+
+static int pyraminx_parse(notation_t *notation, move_seq_t *seq,
+                          const char **str)
+{
+  /* vertices in the order of the faces below */
+  static const char faces[] = "ULRB";
+  static const unsigned int vertices[] = { 1, 3, 0, 2 };
+
+  const char *s = *str;
+  const char *p = *s ? strchr(faces, toupper((unsigned char) *s)) : 0;
+  if (!p) return 0;
+  unsigned int layer = isupper((unsigned char) *s) ? 1 : 0;
+  s++;
+
+  int c = parse_amount(&s);
+  if (!c) return 0;
+
+  /* positive counts are clockwise turns */
+  move_seq_push(seq, vertices[p - faces], layer, c);
+
+  *str = s;
+  return 1;
+}
+
+void notation_pyraminx_init(notation_t *notation)
+{
+  notation->parse = pyraminx_parse;
+  notation->action = 0;
+  notation->n = 0;
+}
+
+/* square 1 */
+
+static int parse_signed(const char **str, int *x)
+{
+  int sign = 1;
+  if (**str == '-') {
+    sign = -1;
+    (*str)++;
+  }
+  int y = parse_number(str, -1, 12);
+  if (y < 0) return 0;
+  *x = sign * y;
+  return 1;
+}
+
+static int square1_parse(notation_t *notation, move_seq_t *seq,
+                         const char **str)
+{
+  const char *s = *str;
+
+  if (*s == '/') {
+    move_seq_push(seq, 3, 0, 1);
+    s++;
+  }
+  else if (*s == '(') {
+    s++;
+    int top, bottom;
+    skip_space(&s);
+    if (!parse_signed(&s, &top)) return 0;
+    skip_space(&s);
+    if (*s++ != ',') return 0;
+    skip_space(&s);
+    if (!parse_signed(&s, &bottom)) return 0;
+    skip_space(&s);
+    if (*s++ != ')') return 0;
+
+    if (top) move_seq_push(seq, 0, 0, top);
+    if (bottom) move_seq_push(seq, 1, 0, bottom);
+  }
+  else {
+    return 0;
+  }
+
+  *str = s;
+  return 1;
+}
+
+void notation_square1_init(notation_t *notation)
+{
+  notation->parse = square1_parse;
+  notation->action = 0;
+  notation->n = 0;
+}
+
+int notation_parse(notation_t *notation, move_seq_t *seq, const char *str,
+                   const char **end)
+{
+  skip_space(&str);
+  while (*str && notation->parse(notation, seq, &str)) {
+    skip_space(&str);
+  }
+
+  if (end) *end = str;
+  return *str == 0;
+}
@@ -0,0 +1,91 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include <stdint.h>
+
+struct puzzle_t;
+typedef struct puzzle_t puzzle_t;
+
+struct puzzle_action_t;
+typedef struct puzzle_action_t puzzle_action_t;
+
+/* face of a move op rotating the whole puzzle */
+#define MOVE_OP_ROTATION 0xff
+
+/* A compiled move: layer l of face f turned c times, as passed to the
+   move callback of a puzzle, or a rotation of the whole puzzle by the
+   symmetry stored in layer when face is MOVE_OP_ROTATION. */
+struct move_op_t
+{
+  uint8_t face;
+  int8_t count;
+  uint16_t layer;
+};
+typedef struct move_op_t move_op_t;
+
+/* Apply op to conf. Return 0 if it is not possible. */
+int move_op_apply(puzzle_t *puzzle, uint8_t *conf, move_op_t *op);
+
+struct move_seq_t
+{
+  unsigned int num;
+  unsigned int size;
+  move_op_t *ops;
+};
+typedef struct move_seq_t move_seq_t;
+
+void move_seq_init(move_seq_t *seq);
+void move_seq_cleanup(move_seq_t *seq);
+void move_seq_push(move_seq_t *seq, unsigned int face, unsigned int layer,
+                   int count);
+
+/* Apply all moves of seq to conf, without allocating. Return the
+   number of moves applied, which is less than seq->num if one of them
+   was not possible. */
+unsigned int move_seq_apply(puzzle_t *puzzle, uint8_t *conf,
+                            move_seq_t *seq);
+
+/* Notation for the moves of a puzzle.
+
+Clockwise turns are those that appear clockwise when looking at the
+turned face, and a prime denotes the inverse of a move.
+
+ - cube: WCA notation. Faces are U, D, L, R, F and B, a number n
+   before a face turns its n-th layer only, nRw or nr turns the n
+   outermost layers (two by default), M, E and S turn the middle layer
+   like L, D and F, and x, y and z rotate the whole cube.
+ - megaminx: Pochmann notation. R++ and D++ rotate the whole puzzle
+   except the face opposite R and D respectively by two fifths of a
+   turn clockwise, R-- and D-- counterclockwise, and U is a clockwise
+   turn of the top face.
+ - pyraminx: U, L, R and B turn a vertex together with the layer below
+   it, and u, l, r and b only turn the tip.
+ - square 1: (x,y) turns the top and bottom layers by x and y twelfths
+   of a turn, and / turns the right half of the puzzle. */
+struct notation_t
+{
+  /* Parse a single move at *str, appending it to seq. Return 0 if
+     *str does not start with a valid move, and advance *str past the
+     move otherwise. */
+  int (*parse)(struct notation_t *notation, move_seq_t *seq,
+               const char **str);
+
+  puzzle_action_t *action;
+  unsigned int n;
+};
+typedef struct notation_t notation_t;
+
+void notation_cube_init(notation_t *notation, puzzle_action_t *action,
+                        unsigned int n);
+void notation_megaminx_init(notation_t *notation, puzzle_action_t *action);
+void notation_pyraminx_init(notation_t *notation);
+void notation_square1_init(notation_t *notation);
+
+/* Parse a sequence of moves separated by optional whitespace,
+   appending them to seq. Return 1 if the whole string was parsed, and
+   0 otherwise. If end is not null, it is set to the position where
+   parsing stopped. */
+int notation_parse(notation_t *notation, move_seq_t *seq, const char *str,
+                   const char **end);
+
+#endif /* NOTATION_H */
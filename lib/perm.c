@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "perm.h"
+#include "perm_simd.h"
 
 void perm_id(uint8_t *x, size_t len)
 {
@@ -21,6 +22,11 @@ void perm_inverted(uint8_t *y, uint8_t *x, size_t len)
 
 void perm_composed(uint8_t *r, uint8_t *x, uint8_t *y, size_t len)
 {
+  if (perm_simd_len(len)) {
+    perm_simd_composed(r, x, y, len);
+    return;
+  }
+
   for (unsigned int i = 0; i < len; i++) {
     r[i] = x[y[i]];
   }
@@ -33,108 +39,303 @@ void perm_composed_inv(uint8_t *r, uint8_t *x, uint8_t *y, size_t len)
   }
 }
 
+void perm_mul_tmp(uint8_t *x, uint8_t *p, size_t len, uint8_t *tmp)
+{
+  if (perm_simd_len(len)) {
+    perm_simd_composed(x, x, p, len);
+    return;
+  }
+
+  memcpy(tmp, x, len);
+  perm_composed(x, tmp, p, len);
+}
+
 void perm_mul(uint8_t *x, uint8_t *p, size_t len)
 {
-  uint8_t *y = malloc(len);
-  memcpy(y, x, len);
-  perm_composed(x, y, p, len);
-  free(y);
+  assert(len <= PERM_MAX_LEN);
+  uint8_t tmp[PERM_MAX_LEN];
+  perm_mul_tmp(x, p, len, tmp);
+}
+
+void perm_mul_inv_tmp(uint8_t *x, uint8_t *p, size_t len, uint8_t *tmp)
+{
+  memcpy(tmp, x, len);
+  perm_composed_inv(x, tmp, p, len);
 }
 
 void perm_mul_inv(uint8_t *x, uint8_t *p, size_t len)
 {
-  uint8_t *y = malloc(len);
-  memcpy(y, x, len);
-  perm_composed_inv(x, y, p, len);
-  free(y);
+  assert(len <= PERM_MAX_LEN);
+  uint8_t tmp[PERM_MAX_LEN];
+  perm_mul_inv_tmp(x, p, len, tmp);
 }
 
 void perm_lmul(uint8_t *x, uint8_t *p, size_t len)
 {
-  uint8_t *y = malloc(len);
-  memcpy(y, x, len);
-  perm_composed(x, p, y, len);
-  free(y);
+  if (perm_simd_len(len)) {
+    perm_simd_composed(x, p, x, len);
+    return;
+  }
+
+  /* every entry of x only depends on its old value, so this can be
+     done in place */
+  for (size_t i = 0; i < len; i++) {
+    x[i] = p[x[i]];
+  }
+}
+
+void perm_lmul_inv_tmp(uint8_t *x, uint8_t *p, size_t len, uint8_t *tmp)
+{
+  perm_inverted(tmp, p, len);
+  perm_lmul(x, tmp, len);
 }
 
 void perm_lmul_inv(uint8_t *x, uint8_t *p, size_t len)
 {
-  uint8_t *y = malloc(len);
-  perm_inverted(y, p, len);
-  perm_lmul(x, y, len);
-  free(y);
+  assert(len <= PERM_MAX_LEN);
+  uint8_t tmp[PERM_MAX_LEN];
+  perm_lmul_inv_tmp(x, p, len, tmp);
+}
+
+void perm_inv_tmp(uint8_t *x, size_t len, uint8_t *tmp)
+{
+  memcpy(tmp, x, len);
+  perm_inverted(x, tmp, len);
 }
 
 void perm_inv(uint8_t *x, size_t len)
 {
-  uint8_t *y = malloc(len);
-  memcpy(y, x, len);
-  perm_inverted(x, y, len);
+  assert(len <= PERM_MAX_LEN);
+  uint8_t tmp[PERM_MAX_LEN];
+  perm_inv_tmp(x, len, tmp);
+}
+
+/* Position of the l-th set bit of w, in constant time and without
+   relying on a popcount instruction: the number of bits set in each
+   byte is computed in parallel, and accumulated, which gives the byte
+   containing the bit, and the bit is then found within that byte. */
+static inline unsigned int select64(uint64_t w, unsigned int l)
+{
+  const uint64_t ones = UINT64_C(0x0101010101010101);
+  const uint64_t msbs = ones << 7;
+
+  uint64_t s = w - ((w >> 1) & UINT64_C(0x5555555555555555));
+  s = (s & UINT64_C(0x3333333333333333)) +
+    ((s >> 2) & UINT64_C(0x3333333333333333));
+  s = (s + (s >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+  /* byte k is the number of bits set in bytes 0 to k */
+  s *= ones;
+
+  /* the top bit of byte k is set if l is at least byte k of s */
+  uint64_t geq = ((l * ones) | msbs) - s;
+  unsigned int pos = ((((geq & msbs) >> 7) * ones) >> 56) * 8;
+
+  unsigned int byte = (w >> pos) & 0xff;
+  for (l -= ((s << 8) >> pos) & 0xff; l; l--) {
+    byte &= byte - 1;
+  }
+  return pos + __builtin_ctz(byte);
+}
+
+/* lehmer digit of value v, given the set of values already seen */
+static inline unsigned int lehmer_digit(uint64_t *visited, uint8_t v)
+{
+  uint64_t bit = UINT64_C(1) << v;
+  unsigned int d = v - __builtin_popcountll(*visited & (bit - 1));
+  *visited |= bit;
+  return d;
 }
 
 /* generate lehmer code of x */
 void perm_lehmer(uint8_t *lehmer, uint8_t *x, size_t len)
 {
-  uint32_t visited = 0;
+  if (perm_simd_len(len)) {
+    perm_simd_lehmer(lehmer, x, len);
+    return;
+  }
+
+  uint64_t visited = 0;
   for (size_t i = 0; i < len; i++) {
-    unsigned int bit = 1 << x[i];
-    lehmer[i] = x[i] - __builtin_popcount(visited & (bit - 1));
-    visited |= bit;
+    lehmer[i] = lehmer_digit(&visited, x[i]);
+  }
+}
+
+/* Decode a lehmer code whose values are less than n. */
+static inline void from_lehmer(uint8_t *x, uint8_t *lehmer, size_t len,
+                               size_t n)
+{
+  if (perm_simd_bmi2) {
+    perm_simd_from_lehmer(x, lehmer, len);
+    return;
+  }
+
+  if (n <= 16) {
+    /* the values not used yet, in increasing order, one per nibble */
+    uint64_t values = UINT64_C(0xfedcba9876543210);
+    for (size_t i = 0; i < len; i++) {
+      unsigned int shift = 4 * lehmer[i];
+      uint64_t low = (UINT64_C(1) << shift) - 1;
+      x[i] = (values >> shift) & 0xf;
+      values = (values & low) | ((values >> 4) & ~low);
+    }
+    return;
+  }
+
+  uint64_t visited = 0;
+  for (size_t i = 0; i < len; i++) {
+    x[i] = select64(~visited, lehmer[i]);
+    visited |= UINT64_C(1) << x[i];
   }
 }
 
 /* reconstruct permutation from lehmer code */
 void perm_from_lehmer(uint8_t *x, uint8_t *lehmer, size_t len)
 {
-  uint32_t visited = 0;
+  /* value i is at most lehmer[i] + i */
+  size_t n = 0;
   for (size_t i = 0; i < len; i++) {
-    int value = 0;
-    int l = lehmer[i];
+    if (lehmer[i] + i >= n) n = lehmer[i] + i + 1;
+  }
+  from_lehmer(x, lehmer, len, n);
+}
 
-    while (visited & (1 << value)) { value++; }
-    while (l--) {
-       do { value++; } while (visited & (1 << value));
-    }
-    visited |= (1 << value);
-    x[i] = value;
+/* Indices are the lehmer code read as a number in mixed radix, with
+   digit i in base n - i, so they are evaluated in Horner form, and
+   decoded starting from the last digit. */
+
+uint64_t perm_index64(uint8_t *x, size_t len, size_t n)
+{
+  if (perm_simd_len(len)) {
+    uint8_t lehmer[PERM_SIMD_MAX_LEN];
+    perm_simd_lehmer(lehmer, x, len);
+    return lehmer_index64(lehmer, len, n);
+  }
+
+  uint64_t visited = 0;
+  uint64_t index = 0;
+  for (size_t i = 0; i < len; i++) {
+    index = index * (n - i) + lehmer_digit(&visited, x[i]);
   }
+
+  return index;
 }
 
-int perm_index(uint8_t *x, size_t len, size_t n)
+uint64_t lehmer_index64(uint8_t *lehmer, size_t len, size_t n)
 {
-  uint8_t *lehmer = malloc(len);
-  perm_lehmer(lehmer, x, len);
+  uint64_t index = 0;
+  for (size_t i = 0; i < len; i++) {
+    index = index * (n - i) + lehmer[i];
+  }
 
-  int index = lehmer_index(lehmer, len, n);
+  return index;
+}
+
+void perm_from_index64(uint8_t *x, size_t len, uint64_t index, size_t n)
+{
+  assert(len <= PERM_MAX_LEN);
+  uint8_t lehmer[PERM_MAX_LEN];
+  lehmer_from_index64(lehmer, len, index, n);
+  from_lehmer(x, lehmer, len, n);
+}
+
+void lehmer_from_index64(uint8_t *lehmer, size_t len, uint64_t index,
+                         size_t n)
+{
+  /* switch to 32-bit divisions, which are much faster, as soon as the
+     rest of the index fits */
+  size_t i = len;
+  for (; i > 0 && index > UINT32_MAX; i--) {
+    lehmer[i - 1] = index % (n - i + 1);
+    index /= n - i + 1;
+  }
+
+  uint32_t index32 = index;
+  for (; i > 0; i--) {
+    lehmer[i - 1] = index32 % (n - i + 1);
+    index32 /= n - i + 1;
+  }
+}
+
+#ifdef PERM_INDEX128
+
+perm_index128_t perm_index128(uint8_t *x, size_t len, size_t n)
+{
+  if (perm_simd_len(len)) {
+    uint8_t lehmer[PERM_SIMD_MAX_LEN];
+    perm_simd_lehmer(lehmer, x, len);
+    return lehmer_index128(lehmer, len, n);
+  }
 
-  free(lehmer);
+  uint64_t visited = 0;
+  perm_index128_t index = 0;
+  for (size_t i = 0; i < len; i++) {
+    index = index * (n - i) + lehmer_digit(&visited, x[i]);
+  }
 
   return index;
 }
 
-int lehmer_index(uint8_t *lehmer, size_t len, size_t n)
+perm_index128_t lehmer_index128(uint8_t *lehmer, size_t len, size_t n)
 {
-  int index = 0;
-  int b = 1;
-  for (size_t i = n - len + 1; i <= n; i++) {
-    uint8_t l = i == 1 ? 0 : lehmer[n - i];
-    index += l * b;
-    b *= i;
+  perm_index128_t index = 0;
+  for (size_t i = 0; i < len; i++) {
+    index = index * (n - i) + lehmer[i];
   }
 
   return index;
 }
 
-uint8_t perm_sign(uint8_t *x, size_t len)
+void perm_from_index128(uint8_t *x, size_t len, perm_index128_t index,
+                        size_t n)
+{
+  assert(len <= PERM_MAX_LEN);
+  uint8_t lehmer[PERM_MAX_LEN];
+  lehmer_from_index128(lehmer, len, index, n);
+  from_lehmer(x, lehmer, len, n);
+}
+
+void lehmer_from_index128(uint8_t *lehmer, size_t len, perm_index128_t index,
+                          size_t n)
+{
+  /* Divisions of 128-bit numbers are slow, so only the top digits are
+     extracted that way, until the rest of the index fits in 64 bits.
+     Digits are taken from the end, so the remaining quotient is the
+     index of the first i digits. */
+  size_t i = len;
+  for (; i > 0 && index > UINT64_MAX; i--) {
+    lehmer[i - 1] = index % (n - i + 1);
+    index /= n - i + 1;
+  }
+  lehmer_from_index64(lehmer, i, index, n);
+}
+
+#endif
+
+int perm_index(uint8_t *x, size_t len, size_t n)
 {
-  uint8_t *lehmer = malloc(len);
-  perm_lehmer(lehmer, x, len);
+  return perm_index64(x, len, n);
+}
 
-  uint8_t sign = lehmer_sign(lehmer, len);
+int lehmer_index(uint8_t *lehmer, size_t len, size_t n)
+{
+  return lehmer_index64(lehmer, len, n);
+}
 
-  free(lehmer);
+uint8_t perm_sign(uint8_t *x, size_t len)
+{
+  if (perm_simd_len(len)) {
+    uint8_t lehmer[PERM_SIMD_MAX_LEN];
+    perm_simd_lehmer(lehmer, x, len);
+    return lehmer_sign(lehmer, len);
+  }
+
+  uint64_t visited = 0;
+  unsigned int sign = 0;
+  for (size_t i = 0; i < len; i++) {
+    sign += lehmer_digit(&visited, x[i]);
+  }
 
-  return sign;
+  return sign % 2;
 }
 
 uint8_t lehmer_sign(uint8_t *lehmer, size_t len)
@@ -148,32 +349,47 @@ uint8_t lehmer_sign(uint8_t *lehmer, size_t len)
 
 void perm_from_index(uint8_t *x, size_t len, int index, size_t n)
 {
-  uint8_t *lehmer = malloc(len);
-  lehmer_from_index(lehmer, len, index, n);
-  perm_from_lehmer(x, lehmer, len);
-  free(lehmer);
+  perm_from_index64(x, len, index, n);
 }
 
 void lehmer_from_index(uint8_t *lehmer, size_t len, int index, size_t n)
 {
-  memset(lehmer, 0, len);
+  lehmer_from_index64(lehmer, len, index, n);
+}
+
+/* In lexicographic order, permutations come in pairs differing by a
+   swap of their last two entries, so exactly one of them is even. */
+int perm_even_index(uint8_t *x, size_t len)
+{
+  return perm_index(x, len, len) / 2;
+}
 
-  int b = n - len + 1;
-  for (size_t i = n - len + 2; i <= n - 1; i++) {
-    b *= i;
+void perm_from_even_index(uint8_t *x, size_t len, int index)
+{
+  perm_from_index(x, len, 2 * index, len);
+  if (len >= 2 && perm_sign(x, len)) {
+    uint8_t y = x[len - 2];
+    x[len - 2] = x[len - 1];
+    x[len - 1] = y;
   }
+}
 
-  for (size_t i = 0; i < len && i < n - 1; i++) {
-    lehmer[i] = index / b;
-    index = index % b;
-    b /= (n - i - 1);
+void perm_conj_tmp(uint8_t *x, uint8_t *y, size_t len, uint8_t *tmp)
+{
+  if (perm_simd_len(len)) {
+    perm_simd_conj(x, x, y, len);
+    return;
   }
+
+  perm_mul_tmp(x, y, len, tmp);
+  perm_lmul_inv_tmp(x, y, len, tmp);
 }
 
 void perm_conj(uint8_t *x, uint8_t *y, size_t len)
 {
-  perm_mul(x, y, len);
-  perm_lmul_inv(x, y, len);
+  assert(len <= PERM_MAX_LEN);
+  uint8_t tmp[PERM_MAX_LEN];
+  perm_conj_tmp(x, y, len, tmp);
 }
 
 uint16_t u16_conj(uint16_t word, uint8_t *p, size_t len)
@@ -194,16 +410,21 @@ uint16_t u16_conj_inv(uint16_t word, uint8_t *p, size_t len)
   return ret;
 }
 
-void shuffle(uint8_t *x, size_t len)
+void perm_shuffle(uint8_t *x, size_t len, rng_t *rng)
 {
-  for (size_t i = 0; i < len - 1; i++) {
-    int j = rand() % (len - i);
+  for (size_t i = 0; i + 1 < len; i++) {
+    unsigned int j = rng_uniform(rng, len - i);
     uint8_t tmp = x[i];
     x[i] = x[i + j];
     x[i + j] = tmp;
   }
 }
 
+void shuffle(uint8_t *x, size_t len)
+{
+  perm_shuffle(x, len, rng_default());
+}
+
 void debug_perm(uint8_t *x, size_t len)
 {
   for (unsigned int i = 0; i < len; i++) {
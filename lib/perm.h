@@ -4,6 +4,13 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "rng.h"
+
+/* Maximum length of a permutation. Entries are bytes, so this covers
+   every permutation that can be represented, and allows the functions
+   below to keep their temporaries on the stack. */
+#define PERM_MAX_LEN 256
+
 /* set x to the identity permutation */
 void perm_id(uint8_t *x, size_t len);
 
@@ -25,29 +32,65 @@ void perm_mul_inv(uint8_t *x, uint8_t *p, size_t len);
 /* replace x with p x */
 void perm_lmul(uint8_t *x, uint8_t *p, size_t len);
 
-/* replace x with x p' */
+/* replace x with p' x */
 void perm_lmul_inv(uint8_t *x, uint8_t *p, size_t len);
 
 /* replace x with x' */
 void perm_inv(uint8_t *x, size_t len);
 
+/* Variants of the above taking a scratch buffer tmp of at least len
+   bytes. None of the perm functions allocate. */
+void perm_mul_tmp(uint8_t *x, uint8_t *p, size_t len, uint8_t *tmp);
+void perm_mul_inv_tmp(uint8_t *x, uint8_t *p, size_t len, uint8_t *tmp);
+void perm_lmul_inv_tmp(uint8_t *x, uint8_t *p, size_t len, uint8_t *tmp);
+void perm_inv_tmp(uint8_t *x, size_t len, uint8_t *tmp);
+void perm_conj_tmp(uint8_t *x, uint8_t *y, size_t len, uint8_t *tmp);
+
 /* lehmer codes */
 void perm_lehmer(uint8_t *lehmer, uint8_t *x, size_t len);
 void perm_from_lehmer(uint8_t *x, uint8_t *lehmer, size_t len);
 
+/* Index of a sequence of len distinct values below n, among all such
+   sequences, in lexicographic order. Values must be less than 64. The
+   int versions are exact up to 12 elements, the 64-bit ones up to 20,
+   and the 128-bit ones, where supported by the compiler, up to 34. */
 int perm_index(uint8_t *x, size_t len, size_t n);
 int lehmer_index(uint8_t *lehmer, size_t len, size_t n);
 void perm_from_index(uint8_t *x, size_t len, int index, size_t n);
 void lehmer_from_index(uint8_t *lehmer, size_t len, int index, size_t n);
 
+/* Index of an even permutation among the even permutations of the
+   same length, in lexicographic order, and its inverse. */
+int perm_even_index(uint8_t *x, size_t len);
+void perm_from_even_index(uint8_t *x, size_t len, int index);
+
+uint64_t perm_index64(uint8_t *x, size_t len, size_t n);
+uint64_t lehmer_index64(uint8_t *lehmer, size_t len, size_t n);
+void perm_from_index64(uint8_t *x, size_t len, uint64_t index, size_t n);
+void lehmer_from_index64(uint8_t *lehmer, size_t len, uint64_t index,
+                         size_t n);
+
+#ifdef __SIZEOF_INT128__
+#define PERM_INDEX128 1
+typedef unsigned __int128 perm_index128_t;
+
+perm_index128_t perm_index128(uint8_t *x, size_t len, size_t n);
+perm_index128_t lehmer_index128(uint8_t *lehmer, size_t len, size_t n);
+void perm_from_index128(uint8_t *x, size_t len, perm_index128_t index,
+                        size_t n);
+void lehmer_from_index128(uint8_t *lehmer, size_t len, perm_index128_t index,
+                          size_t n);
+#endif
+
 /* apply permutation to a 16 bit word */
 uint16_t u16_conj(uint16_t word, uint8_t *p, size_t len);
 uint16_t u16_conj_inv(uint16_t word, uint8_t *p, size_t len);
 
-/* conjugation */
+/* replace x with y' x y */
 void perm_conj(uint8_t *x, uint8_t *y, size_t len);
 
-/* random permutation */
+/* random permutation, using rng or the default state of the thread */
+void perm_shuffle(uint8_t *x, size_t len, rng_t *rng);
 void shuffle(uint8_t *x, size_t len);
 
 /* sign as integer mod 2 */
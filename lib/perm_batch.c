@@ -0,0 +1,206 @@
+#include <memory.h>
+
+#include "perm_batch.h"
+#include "perm_simd.h"
+
+/* Number of permutations processed together by the vector kernels,
+   which compute signs and indices. Vectors are written with
+   the generic vector extensions, so that the compiler picks the
+   instructions of the target, and wider types are split as needed. */
+#define WIDTH 16
+
+/* Number of permutations processed together by the scalar loops, small
+   enough for their rows to stay in cache. */
+#define BLOCK 256
+
+typedef uint8_t vec_t __attribute__((vector_size(WIDTH)));
+typedef uint64_t vec64_t __attribute__((vector_size(8 * WIDTH)));
+
+static inline vec_t vec_load(const uint8_t *p)
+{
+  vec_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void vec_store(uint8_t *p, vec_t v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+static inline vec_t vec_set(uint8_t x)
+{
+  return (vec_t) {} + x;
+}
+
+/* The kernels below work on WIDTH consecutive permutations of a batch
+   whose rows are stride bytes apart, and have scalar counterparts
+   handling a single permutation, used for the rest of the batch and
+   for long permutations. */
+
+/* Lehmer digit i is x[i] minus the number of earlier entries smaller
+   than x[i]. The sign is the parity of their sum, the index their
+   value in the mixed radix n - i. */
+
+static inline vec_t lehmer_digit_vec(uint8_t *xs, size_t i, size_t stride)
+{
+  vec_t x = vec_load(xs + i * stride);
+  vec_t d = x;
+  for (size_t j = 0; j < i; j++) {
+    /* true lanes are all ones, i.e. -1 */
+    d += (vec_t) (vec_load(xs + j * stride) < x);
+  }
+  return d;
+}
+
+static inline uint8_t lehmer_digit_one(uint8_t *xs, size_t i, size_t stride)
+{
+  uint8_t x = xs[i * stride];
+  uint8_t d = x;
+  for (size_t j = 0; j < i; j++) {
+    d -= xs[j * stride] < x;
+  }
+  return d;
+}
+
+static void sign_vec(uint8_t *signs, uint8_t *xs, size_t len, size_t stride)
+{
+  vec_t s = {};
+  for (size_t i = 0; i < len; i++) {
+    s += lehmer_digit_vec(xs, i, stride);
+  }
+  vec_store(signs, s & vec_set(1));
+}
+
+static void sign_one(uint8_t *signs, uint8_t *xs, size_t len, size_t stride)
+{
+  uint8_t s = 0;
+  for (size_t i = 0; i < len; i++) {
+    s += lehmer_digit_one(xs, i, stride);
+  }
+  *signs = s % 2;
+}
+
+static void index_vec(uint64_t *indices, uint8_t *xs, size_t len, size_t n,
+                      size_t stride)
+{
+  vec64_t index = {};
+  for (size_t i = 0; i < len; i++) {
+    vec64_t d = __builtin_convertvector(lehmer_digit_vec(xs, i, stride),
+                                        vec64_t);
+    index = index * (uint64_t) (n - i) + d;
+  }
+  for (size_t k = 0; k < WIDTH; k++) {
+    indices[k] = index[k];
+  }
+}
+
+static void index_one(uint64_t *indices, uint8_t *xs, size_t len, size_t n,
+                      size_t stride)
+{
+  uint64_t index = 0;
+  for (size_t i = 0; i < len; i++) {
+    index = index * (n - i) + lehmer_digit_one(xs, i, stride);
+  }
+  *indices = index;
+}
+
+/* number of permutations to process with the vector kernels */
+static inline size_t vec_num(size_t len, size_t num)
+{
+  if (len > PERM_BATCH_VEC_MAX_LEN) return 0;
+  return num - num % WIDTH;
+}
+
+void perm_batch_load(uint8_t *xs, uint8_t *x, size_t len, size_t num)
+{
+  for (size_t k = 0; k < num; k++) {
+    for (size_t i = 0; i < len; i++) {
+      xs[i * num + k] = x[k * len + i];
+    }
+  }
+}
+
+void perm_batch_store(uint8_t *x, uint8_t *xs, size_t len, size_t num)
+{
+  for (size_t k = 0; k < num; k++) {
+    for (size_t i = 0; i < len; i++) {
+      x[k * len + i] = xs[i * num + k];
+    }
+  }
+}
+
+void perm_batch_composed(uint8_t *rs, uint8_t *xs, uint8_t *ys,
+                         size_t len, size_t num)
+{
+  /* Composing each permutation with its own table is a gather, which
+     the vector units cannot do on bytes, so the batch is traversed one
+     row at a time, in blocks of columns that stay in cache. */
+  for (size_t k0 = 0; k0 < num; k0 += BLOCK) {
+    size_t k1 = k0 + BLOCK < num ? k0 + BLOCK : num;
+    for (size_t i = 0; i < len; i++) {
+      for (size_t k = k0; k < k1; k++) {
+        rs[i * num + k] = xs[ys[i * num + k] * num + k];
+      }
+    }
+  }
+}
+
+void perm_batch_mul(uint8_t *rs, uint8_t *xs, uint8_t *p,
+                    size_t len, size_t num)
+{
+  /* row i of the result is row p[i] of the batch */
+  for (size_t i = 0; i < len; i++) {
+    memcpy(rs + i * num, xs + p[i] * num, num);
+  }
+}
+
+void perm_batch_lmul(uint8_t *rs, uint8_t *p, uint8_t *xs,
+                     size_t len, size_t num)
+{
+  /* every entry of the batch is replaced by its image under p */
+  if (perm_simd_len(len)) {
+    perm_simd_lookup(rs, p, xs, len, len * num);
+    return;
+  }
+
+  for (size_t i = 0; i < len * num; i++) {
+    rs[i] = p[xs[i]];
+  }
+}
+
+void perm_batch_inverted(uint8_t *rs, uint8_t *xs, size_t len, size_t num)
+{
+  /* a scatter, see perm_batch_composed */
+  for (size_t k0 = 0; k0 < num; k0 += BLOCK) {
+    size_t k1 = k0 + BLOCK < num ? k0 + BLOCK : num;
+    for (size_t i = 0; i < len; i++) {
+      for (size_t k = k0; k < k1; k++) {
+        rs[xs[i * num + k] * num + k] = i;
+      }
+    }
+  }
+}
+
+void perm_batch_sign(uint8_t *signs, uint8_t *xs, size_t len, size_t num)
+{
+  size_t k = 0;
+  for (; k < vec_num(len, num); k += WIDTH) {
+    sign_vec(signs + k, xs + k, len, num);
+  }
+  for (; k < num; k++) {
+    sign_one(signs + k, xs + k, len, num);
+  }
+}
+
+void perm_batch_index(uint64_t *indices, uint8_t *xs, size_t len, size_t n,
+                      size_t num)
+{
+  size_t k = 0;
+  for (; k < vec_num(len, num); k += WIDTH) {
+    index_vec(indices + k, xs + k, len, n, num);
+  }
+  for (; k < num; k++) {
+    index_one(indices + k, xs + k, len, n, num);
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef PERM_BATCH_H
+#define PERM_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Batches of num permutations of the same length, stored as a
+   structure of arrays: entry i of permutation k is xs[i * num + k].
+   With this layout an operation is applied to many permutations at
+   once, one entry at a time, and vectorises across the batch wherever
+   it does not need a different lookup table for each permutation.
+
+   Output arrays must not overlap the inputs. */
+
+/* Signs and indices of permutations up to this length are computed
+   with vector operations, longer ones one at a time. */
+#define PERM_BATCH_VEC_MAX_LEN 32
+
+/* convert num contiguous permutations x to a batch, and back */
+void perm_batch_load(uint8_t *xs, uint8_t *x, size_t len, size_t num);
+void perm_batch_store(uint8_t *x, uint8_t *xs, size_t len, size_t num);
+
+/* set each r to x y */
+void perm_batch_composed(uint8_t *rs, uint8_t *xs, uint8_t *ys,
+                         size_t len, size_t num);
+
+/* set each r to x p, for a single permutation p */
+void perm_batch_mul(uint8_t *rs, uint8_t *xs, uint8_t *p,
+                    size_t len, size_t num);
+
+/* set each r to p x, for a single permutation p */
+void perm_batch_lmul(uint8_t *rs, uint8_t *p, uint8_t *xs,
+                     size_t len, size_t num);
+
+/* set each r to x' */
+void perm_batch_inverted(uint8_t *rs, uint8_t *xs, size_t len, size_t num);
+
+/* perm_sign and perm_index64 of each permutation */
+void perm_batch_sign(uint8_t *signs, uint8_t *xs, size_t len, size_t num);
+void perm_batch_index(uint64_t *indices, uint8_t *xs, size_t len, size_t n,
+                      size_t num);
+
+#endif /* PERM_BATCH_H */
@@ -0,0 +1,312 @@
+#include "perm_simd.h"
+
+int perm_simd_level = PERM_SIMD_NONE;
+int perm_simd_bmi2 = 0;
+
+#if PERM_SIMD
+
+#include <immintrin.h>
+
+#define SSSE3 __attribute__((target("ssse3")))
+#define AVX2 __attribute__((target("avx2")))
+#define BMI2 __attribute__((target("bmi,bmi2")))
+
+__attribute__((constructor))
+static void perm_simd_init(void)
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    perm_simd_level = PERM_SIMD_AVX2;
+  else if (__builtin_cpu_supports("ssse3"))
+    perm_simd_level = PERM_SIMD_SSSE3;
+  perm_simd_bmi2 = __builtin_cpu_supports("bmi2");
+}
+
+/* Shuffle masks for variable byte shifts: the 16 bytes at offset
+   16 + s shift a vector down by s bytes, the ones at offset 16 - s
+   shift it up, filling with zeros in both cases. */
+static const uint8_t shift_table[48] = {
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+static inline SSSE3 __m128i shift_down(__m128i v, size_t s)
+{
+  return _mm_shuffle_epi8
+    (v, _mm_loadu_si128((const __m128i *) (shift_table + 16 + s)));
+}
+
+static inline SSSE3 __m128i shift_up(__m128i v, size_t s)
+{
+  return _mm_shuffle_epi8
+    (v, _mm_loadu_si128((const __m128i *) (shift_table + 16 - s)));
+}
+
+/* Load a permutation into two vectors, padding with zeros, without
+   touching memory past its end. Shorter vectors are assembled from
+   two overlapping loads. */
+static inline SSSE3 void perm_load(__m128i *lo, __m128i *hi,
+                                   const uint8_t *p, size_t len)
+{
+  if (len >= 16) {
+    *lo = _mm_loadu_si128((const __m128i *) p);
+    __m128i w = _mm_loadu_si128((const __m128i *) (p + len - 16));
+    *hi = shift_down(w, 32 - len);
+  }
+  else {
+    __m128i a = _mm_loadl_epi64((const __m128i *) p);
+    __m128i w = _mm_loadl_epi64((const __m128i *) (p + len - 8));
+    *lo = _mm_unpacklo_epi64(a, shift_down(w, 16 - len));
+    *hi = _mm_setzero_si128();
+  }
+}
+
+/* Store the first len bytes of a pair of vectors. */
+static inline SSSE3 void perm_store(uint8_t *p, __m128i lo, __m128i hi,
+                                    size_t len)
+{
+  if (len >= 16) {
+    __m128i w = _mm_or_si128(shift_down(lo, len - 16),
+                             shift_up(hi, 32 - len));
+    _mm_storeu_si128((__m128i *) (p + len - 16), w);
+    _mm_storeu_si128((__m128i *) p, lo);
+  }
+  else {
+    _mm_storel_epi64((__m128i *) (p + len - 8), shift_down(lo, len - 8));
+    _mm_storel_epi64((__m128i *) p, lo);
+  }
+}
+
+/* x[y] for indices below 32: pshufb only looks at the low 4 bits, and
+   zeroes lanes whose index has the top bit set, so each half of x is
+   looked up with the indices belonging to the other half saturated
+   to 0x80 or above. */
+static inline SSSE3 __m128i lookup(__m128i xlo, __m128i xhi, __m128i y,
+                                   size_t len)
+{
+  if (len <= 16) return _mm_shuffle_epi8(xlo, y);
+
+  __m128i a = _mm_shuffle_epi8(xlo, _mm_adds_epu8(y, _mm_set1_epi8(0x70)));
+  __m128i b = _mm_shuffle_epi8(xhi, _mm_sub_epi8(y, _mm_set1_epi8(16)));
+  return _mm_or_si128(a, b);
+}
+
+/* Inversion is a scatter, which has no vector equivalent: it is faster
+   to do it with scalar stores into a buffer and load the result. */
+static inline SSSE3 void inverse(__m128i *ylo, __m128i *yhi,
+                                 const uint8_t *x, size_t len)
+{
+  uint8_t y[PERM_SIMD_MAX_LEN];
+  for (size_t i = 0; i < len; i++) {
+    y[x[i]] = i;
+  }
+  perm_load(ylo, yhi, y, len);
+}
+
+static SSSE3 void perm_composed_ssse3(uint8_t *r, uint8_t *x, uint8_t *y,
+                                      size_t len)
+{
+  __m128i xlo, xhi, ylo, yhi;
+  perm_load(&xlo, &xhi, x, len);
+  perm_load(&ylo, &yhi, y, len);
+  __m128i rlo = lookup(xlo, xhi, ylo, len);
+  __m128i rhi = lookup(xlo, xhi, yhi, len);
+  perm_store(r, rlo, rhi, len);
+}
+
+static SSSE3 void perm_conj_ssse3(uint8_t *r, uint8_t *x, uint8_t *y,
+                                  size_t len)
+{
+  __m128i xlo, xhi, ylo, yhi, zlo, zhi;
+  perm_load(&xlo, &xhi, x, len);
+  perm_load(&ylo, &yhi, y, len);
+  inverse(&zlo, &zhi, y, len);
+
+  /* x y */
+  __m128i tlo = lookup(xlo, xhi, ylo, len);
+  __m128i thi = lookup(xlo, xhi, yhi, len);
+
+  /* y' x y */
+  __m128i rlo = lookup(zlo, zhi, tlo, len);
+  __m128i rhi = lookup(zlo, zhi, thi, len);
+  perm_store(r, rlo, rhi, len);
+}
+
+/* With AVX2, both halves of a permutation longer than 16 fit in a
+   single register. Lookups still happen within 128-bit lanes, so the
+   table is broadcast to both lanes, one half at a time. */
+static inline AVX2 __m256i lookup_avx2(__m256i x, __m256i y)
+{
+  __m256i xlo = _mm256_permute2x128_si256(x, x, 0x00);
+  __m256i xhi = _mm256_permute2x128_si256(x, x, 0x11);
+  __m256i a = _mm256_shuffle_epi8
+    (xlo, _mm256_adds_epu8(y, _mm256_set1_epi8(0x70)));
+  __m256i b = _mm256_shuffle_epi8
+    (xhi, _mm256_sub_epi8(y, _mm256_set1_epi8(16)));
+  return _mm256_or_si256(a, b);
+}
+
+static inline AVX2 __m256i perm_load_avx2(const uint8_t *p, size_t len)
+{
+  __m128i lo, hi;
+  perm_load(&lo, &hi, p, len);
+  return _mm256_set_m128i(hi, lo);
+}
+
+static inline AVX2 void perm_store_avx2(uint8_t *p, __m256i v, size_t len)
+{
+  perm_store(p, _mm256_castsi256_si128(v),
+             _mm256_extracti128_si256(v, 1), len);
+}
+
+static AVX2 void perm_composed_avx2(uint8_t *r, uint8_t *x, uint8_t *y,
+                                    size_t len)
+{
+  __m256i vx = perm_load_avx2(x, len);
+  __m256i vy = perm_load_avx2(y, len);
+  perm_store_avx2(r, lookup_avx2(vx, vy), len);
+}
+
+static inline AVX2 __m256i inverse_avx2(const uint8_t *x, size_t len)
+{
+  __m128i lo, hi;
+  inverse(&lo, &hi, x, len);
+  return _mm256_set_m128i(hi, lo);
+}
+
+static AVX2 void perm_conj_avx2(uint8_t *r, uint8_t *x, uint8_t *y,
+                                size_t len)
+{
+  __m256i vx = perm_load_avx2(x, len);
+  __m256i vy = perm_load_avx2(y, len);
+  __m256i vz = inverse_avx2(y, len);
+
+  perm_store_avx2(r, lookup_avx2(vz, lookup_avx2(vx, vy)), len);
+}
+
+/* Translate an arbitrary array through p, a vector at a time, and the
+   remainder one byte at a time. */
+static SSSE3 void perm_lookup_ssse3(uint8_t *r, uint8_t *p, uint8_t *x,
+                                    size_t len, size_t size)
+{
+  __m128i plo, phi;
+  perm_load(&plo, &phi, p, len);
+
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (x + i));
+    _mm_storeu_si128((__m128i *) (r + i), lookup(plo, phi, v, len));
+  }
+  for (; i < size; i++) {
+    r[i] = p[x[i]];
+  }
+}
+
+static AVX2 void perm_lookup_avx2(uint8_t *r, uint8_t *p, uint8_t *x,
+                                  size_t len, size_t size)
+{
+  __m256i vp = perm_load_avx2(p, len);
+
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+    _mm256_storeu_si256((__m256i *) (r + i), lookup_avx2(vp, v));
+  }
+  for (; i < size; i++) {
+    r[i] = p[x[i]];
+  }
+}
+
+/* Lehmer digit i is x[i] minus the number of j < i with x[j] < x[i].
+   All digits are computed at once, by comparing the whole permutation
+   with each of its entries in turn. Values are less than 64, so signed
+   comparisons are fine. */
+static SSSE3 void perm_lehmer_ssse3(uint8_t *lehmer, uint8_t *x, size_t len)
+{
+  __m128i xlo, xhi;
+  perm_load(&xlo, &xhi, x, len);
+  __m128i ilo = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                              8, 9, 10, 11, 12, 13, 14, 15);
+  __m128i ihi = _mm_add_epi8(ilo, _mm_set1_epi8(16));
+
+  /* true lanes are -1, so adding them decrements the digit */
+  __m128i dlo = xlo, dhi = xhi;
+  for (size_t j = 0; j < len; j++) {
+    __m128i xj = _mm_set1_epi8(x[j]);
+    __m128i vj = _mm_set1_epi8(j);
+    dlo = _mm_add_epi8(dlo, _mm_and_si128(_mm_cmpgt_epi8(xlo, xj),
+                                          _mm_cmpgt_epi8(ilo, vj)));
+    if (len > 16)
+      dhi = _mm_add_epi8(dhi, _mm_and_si128(_mm_cmpgt_epi8(xhi, xj),
+                                            _mm_cmpgt_epi8(ihi, vj)));
+  }
+  perm_store(lehmer, dlo, dhi, len);
+}
+
+static AVX2 void perm_lehmer_avx2(uint8_t *lehmer, uint8_t *x, size_t len)
+{
+  __m256i vx = perm_load_avx2(x, len);
+  __m256i vi = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                8, 9, 10, 11, 12, 13, 14, 15,
+                                16, 17, 18, 19, 20, 21, 22, 23,
+                                24, 25, 26, 27, 28, 29, 30, 31);
+
+  __m256i d = vx;
+  for (size_t j = 0; j < len; j++) {
+    __m256i xj = _mm256_set1_epi8(x[j]);
+    __m256i vj = _mm256_set1_epi8(j);
+    d = _mm256_add_epi8(d, _mm256_and_si256(_mm256_cmpgt_epi8(vx, xj),
+                                            _mm256_cmpgt_epi8(vi, vj)));
+  }
+  perm_store_avx2(lehmer, d, len);
+}
+
+/* The l-th value not used yet is the position of the l-th set bit of
+   the mask of free values, which pdep finds directly. */
+BMI2 void perm_simd_from_lehmer(uint8_t *x, uint8_t *lehmer, size_t len)
+{
+  uint64_t free = ~UINT64_C(0);
+  for (size_t i = 0; i < len; i++) {
+    uint64_t bit = _pdep_u64(UINT64_C(1) << lehmer[i], free);
+    x[i] = _tzcnt_u64(bit);
+    free ^= bit;
+  }
+}
+
+void perm_simd_composed(uint8_t *r, uint8_t *x, uint8_t *y, size_t len)
+{
+  if (len > 16 && perm_simd_level >= PERM_SIMD_AVX2)
+    perm_composed_avx2(r, x, y, len);
+  else
+    perm_composed_ssse3(r, x, y, len);
+}
+
+void perm_simd_conj(uint8_t *r, uint8_t *x, uint8_t *y, size_t len)
+{
+  if (len > 16 && perm_simd_level >= PERM_SIMD_AVX2)
+    perm_conj_avx2(r, x, y, len);
+  else
+    perm_conj_ssse3(r, x, y, len);
+}
+
+void perm_simd_lehmer(uint8_t *lehmer, uint8_t *x, size_t len)
+{
+  if (len > 16 && perm_simd_level >= PERM_SIMD_AVX2)
+    perm_lehmer_avx2(lehmer, x, len);
+  else
+    perm_lehmer_ssse3(lehmer, x, len);
+}
+
+void perm_simd_lookup(uint8_t *r, uint8_t *p, uint8_t *x, size_t len,
+                      size_t size)
+{
+  if (perm_simd_level >= PERM_SIMD_AVX2)
+    perm_lookup_avx2(r, p, x, len, size);
+  else
+    perm_lookup_ssse3(r, p, x, len, size);
+}
+
+#endif
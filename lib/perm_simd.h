@@ -0,0 +1,72 @@
+#ifndef PERM_SIMD_H
+#define PERM_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Vectorised kernels for short permutations, selected at runtime by
+   perm.c according to the features of the CPU. They are only defined
+   on x86, and only handle lengths between PERM_SIMD_MIN_LEN and
+   PERM_SIMD_MAX_LEN. Unlike the scalar versions, they read all their
+   arguments before writing the result, so they can work in place. */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PERM_SIMD 1
+#else
+#define PERM_SIMD 0
+#endif
+
+#define PERM_SIMD_MIN_LEN 8
+#define PERM_SIMD_MAX_LEN 32
+
+enum {
+  PERM_SIMD_NONE,
+  PERM_SIMD_SSSE3,
+  PERM_SIMD_AVX2,
+};
+
+/* best instruction set available, set at startup */
+extern int perm_simd_level;
+
+/* whether the CPU supports BMI2, independently of the level */
+extern int perm_simd_bmi2;
+
+#if PERM_SIMD
+
+static inline int perm_simd_len(size_t len)
+{
+  return perm_simd_level != PERM_SIMD_NONE &&
+    len >= PERM_SIMD_MIN_LEN && len <= PERM_SIMD_MAX_LEN;
+}
+
+void perm_simd_composed(uint8_t *r, uint8_t *x, uint8_t *y, size_t len);
+void perm_simd_conj(uint8_t *r, uint8_t *x, uint8_t *y, size_t len);
+
+/* set r[i] to p[x[i]] for all i < size, where p has length len */
+void perm_simd_lookup(uint8_t *r, uint8_t *p, uint8_t *x, size_t len,
+                      size_t size);
+
+/* lehmer code of a sequence of distinct values less than 64 */
+void perm_simd_lehmer(uint8_t *lehmer, uint8_t *x, size_t len);
+
+/* Decode a lehmer code whose values are less than 64. Only available
+   when perm_simd_bmi2 is set, for any length. */
+void perm_simd_from_lehmer(uint8_t *x, uint8_t *lehmer, size_t len);
+
+#else
+
+static inline int perm_simd_len(size_t len) { return 0; }
+static inline void perm_simd_composed(uint8_t *r, uint8_t *x, uint8_t *y,
+                                      size_t len) {}
+static inline void perm_simd_conj(uint8_t *r, uint8_t *x, uint8_t *y,
+                                  size_t len) {}
+static inline void perm_simd_lookup(uint8_t *r, uint8_t *p, uint8_t *x,
+                                    size_t len, size_t size) {}
+static inline void perm_simd_lehmer(uint8_t *lehmer, uint8_t *x,
+                                    size_t len) {}
+static inline void perm_simd_from_lehmer(uint8_t *x, uint8_t *lehmer,
+                                         size_t len) {}
+
+#endif
+
+#endif /* PERM_SIMD_H */
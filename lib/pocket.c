@@ -0,0 +1,298 @@
+#include "pocket.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "group.h"
+#include "notation.h"
+#include "perm.h"
+#include "utils.h"
+
+#define POCKET_MAGIC 0x544b4350 /* "PCKT" */
+#define POCKET_VERSION 2
+
+/* relabel positions and pieces so that the fixed one is left out */
+static inline unsigned int rel(pocket_t *pocket, unsigned int x)
+{
+  return x < pocket->fixed ? x : x - 1;
+}
+
+static inline unsigned int unrel(pocket_t *pocket, unsigned int x)
+{
+  return x < pocket->fixed ? x : x + 1;
+}
+
+/* The index of conf h, where h is a rotation bringing the fixed corner
+   back to its solved state, or -1 if the corners of conf are not a
+   permutation or their twists do not add up to 0 modulo 3, so that no
+   turns can solve it. */
+static int32_t pocket_encode(pocket_t *pocket, uint8_t *conf,
+                             unsigned int h)
+{
+  puzzle_action_t *action = pocket->action;
+  uint8_t perm[7];
+  uint8_t ori[7];
+  unsigned int mask = 1 << pocket->fixed;
+  unsigned int sum = 0;
+
+  for (unsigned int x = 0; x < 8; x++) {
+    if (x == pocket->fixed) continue;
+    unsigned int j =
+      action->inv_by_stab[0][group_table_mul(&action->table, conf[x], h)];
+    if (mask & (1 << (j % 8))) return -1;
+    mask |= 1 << (j % 8);
+    perm[rel(pocket, x)] = rel(pocket, j % 8);
+    ori[rel(pocket, j % 8)] = j / 8;
+    sum += j / 8;
+  }
+  if (sum % 3 != 0) return -1;
+
+  /* orientations are indexed by position, so that moves act on them
+     independently of the permutation */
+  unsigned int twist = 0;
+  for (unsigned int i = 0; i < 6; i++) {
+    twist = 3 * twist + ori[i];
+  }
+
+  return perm_index(perm, 7, 7) * POCKET_NUM_TWISTS + twist;
+}
+
+static void pocket_decode(pocket_t *pocket, uint8_t *conf, uint32_t i)
+{
+  puzzle_action_t *action = pocket->action;
+  uint8_t perm[7];
+  uint8_t ori[7];
+
+  perm_from_index(perm, 7, i / POCKET_NUM_TWISTS, 7);
+  unsigned int twist = i % POCKET_NUM_TWISTS;
+  unsigned int sum = 0;
+  for (unsigned int k = 6; k-- > 0;) {
+    ori[k] = twist % 3;
+    sum += ori[k];
+    twist /= 3;
+  }
+  ori[6] = (3 - sum % 3) % 3;
+
+  conf[pocket->fixed] = action->by_stab[0][pocket->fixed];
+  for (unsigned int x = 0; x < 8; x++) {
+    if (x == pocket->fixed) continue;
+    unsigned int p = perm[rel(pocket, x)];
+    conf[x] = action->by_stab[0][ori[p] * 8 + unrel(pocket, p)];
+  }
+}
+
+/* rotation bringing the fixed corner of conf back to its solved state */
+static unsigned int pocket_rotation(pocket_t *pocket, uint8_t *conf)
+{
+  unsigned int x0 = pocket->fixed;
+  return group_table_inv_mul(&pocket->action->table, conf[x0],
+                             pocket->action->by_stab[0][x0]);
+}
+
+void pocket_init(pocket_t *pocket, puzzle_action_t *action,
+                 cube_shape_t *shape, int half_turns)
+{
+  assert(shape->n == 2);
+  pocket->action = action;
+  pocket->shape = shape;
+  pocket->half_turns = half_turns;
+
+  static const int counts[] = { 1, -1, 2 };
+  pocket->num_moves = 0;
+  for (unsigned int f = 0; f < 6; f += 2) {
+    for (unsigned int k = 0; k < (half_turns ? 3 : 2); k++) {
+      pocket->faces[pocket->num_moves] = f;
+      pocket->counts[pocket->num_moves] = counts[k];
+      pocket->num_moves++;
+    }
+  }
+
+  uint8_t *conf = cube_new(action, shape);
+  cube_coords_t coords;
+  cube_coords_init(&coords, action, shape, conf);
+
+  /* the fixed corner is in layer 0 of faces 1, 3 and 5 */
+  pocket->fixed = 8;
+  for (unsigned int x = 0; x < 8; x++) {
+    if (coords.coords[0][x] == 0 && coords.coords[1][x] == 0 &&
+        coords.coords[2][x] == 0) {
+      assert(pocket->fixed == 8);
+      pocket->fixed = x;
+    }
+  }
+  assert(pocket->fixed < 8);
+
+  unsigned int num_moves = pocket->num_moves;
+  pocket->perm_move = malloc(POCKET_NUM_PERMS * num_moves * sizeof(uint16_t));
+  pocket->twist_move =
+    malloc(POCKET_NUM_TWISTS * num_moves * sizeof(uint16_t));
+
+  for (unsigned int p = 0; p < POCKET_NUM_PERMS; p++) {
+    for (unsigned int m = 0; m < num_moves; m++) {
+      pocket_decode(pocket, conf, p * POCKET_NUM_TWISTS);
+      cube_coords_set(&coords, conf);
+      cube_coords_apply(&coords, conf, pocket->faces[m], 0,
+                        pocket->counts[m], 0);
+      pocket->perm_move[p * num_moves + m] =
+        pocket_encode(pocket, conf, 0) / POCKET_NUM_TWISTS;
+    }
+  }
+
+  for (unsigned int t = 0; t < POCKET_NUM_TWISTS; t++) {
+    for (unsigned int m = 0; m < num_moves; m++) {
+      pocket_decode(pocket, conf, t);
+      cube_coords_set(&coords, conf);
+      cube_coords_apply(&coords, conf, pocket->faces[m], 0,
+                        pocket->counts[m], 0);
+      pocket->twist_move[t * num_moves + m] =
+        pocket_encode(pocket, conf, 0) % POCKET_NUM_TWISTS;
+    }
+  }
+
+  uint8_t *solved = cube_new(action, shape);
+  pocket->solved = pocket_encode(pocket, solved, 0);
+  free(solved);
+
+  dist_table_init(&pocket->table, POCKET_NUM_STATES, 2);
+
+  cube_coords_cleanup(&coords);
+  free(conf);
+}
+
+void pocket_cleanup(pocket_t *pocket)
+{
+  free(pocket->perm_move);
+  free(pocket->twist_move);
+  dist_table_cleanup(&pocket->table);
+}
+
+static inline uint32_t pocket_move(pocket_t *pocket, uint32_t i,
+                                   unsigned int m)
+{
+  unsigned int num_moves = pocket->num_moves;
+  unsigned int p = i / POCKET_NUM_TWISTS;
+  unsigned int t = i % POCKET_NUM_TWISTS;
+  return pocket->perm_move[p * num_moves + m] * POCKET_NUM_TWISTS +
+    pocket->twist_move[t * num_moves + m];
+}
+
+static void pocket_expand(void *data, uint64_t i, uint64_t *next)
+{
+  pocket_t *pocket = data;
+  for (unsigned int m = 0; m < pocket->num_moves; m++) {
+    next[m] = pocket_move(pocket, i, m);
+  }
+}
+
+void pocket_build(pocket_t *pocket, unsigned int num_threads)
+{
+  dist_table_build(&pocket->table, pocket->solved, pocket->num_moves,
+                   pocket_expand, 0, pocket, num_threads);
+}
+
+/* The file starts with little endian 32-bit words: magic, version and
+   metric, followed by the table as saved by dist_table_save. */
+#define POCKET_PREFIX_SIZE 12
+
+static void pocket_prefix(pocket_t *pocket, uint8_t *prefix)
+{
+  put_u32(&prefix[0], POCKET_MAGIC);
+  put_u32(&prefix[4], POCKET_VERSION);
+  put_u32(&prefix[8], pocket->half_turns != 0);
+}
+
+int pocket_save(pocket_t *pocket, const char *path)
+{
+  dist_table_t *table = &pocket->table;
+  uint8_t prefix[POCKET_PREFIX_SIZE];
+  pocket_prefix(pocket, prefix);
+  return dist_table_save(&table, 1, path, prefix, POCKET_PREFIX_SIZE);
+}
+
+int pocket_load(pocket_t *pocket, const char *path)
+{
+  dist_table_t *table = &pocket->table;
+  uint8_t prefix[POCKET_PREFIX_SIZE];
+  pocket_prefix(pocket, prefix);
+  return dist_table_load(&table, 1, path, prefix, POCKET_PREFIX_SIZE);
+}
+
+int32_t pocket_index(pocket_t *pocket, uint8_t *conf)
+{
+  return pocket_encode(pocket, conf, pocket_rotation(pocket, conf));
+}
+
+void pocket_conf(pocket_t *pocket, uint8_t *conf, uint32_t i)
+{
+  pocket_decode(pocket, conf, i);
+}
+
+/* Follow the table from i to the solved configuration, calling
+   visit for every move if it is not null. Return the number of
+   moves. */
+static unsigned int pocket_walk(pocket_t *pocket, uint32_t i,
+                                void (*visit)(void *data, unsigned int m),
+                                void *data)
+{
+  unsigned int n = 0;
+  while (i != pocket->solved) {
+    unsigned int v = dist_table_get(&pocket->table, i);
+    assert(v != 3);
+
+    unsigned int m;
+    uint32_t j = 0;
+    for (m = 0; m < pocket->num_moves; m++) {
+      j = pocket_move(pocket, i, m);
+      if (dist_table_get(&pocket->table, j) == (v + 2) % 3) break;
+    }
+    assert(m < pocket->num_moves);
+
+    if (visit) visit(data, m);
+    i = j;
+    n++;
+  }
+  return n;
+}
+
+int pocket_distance(pocket_t *pocket, uint8_t *conf)
+{
+  int32_t i = pocket_index(pocket, conf);
+  if (i < 0) return -1;
+  return pocket_walk(pocket, i, 0, 0);
+}
+
+struct pocket_solve_data_t
+{
+  pocket_t *pocket;
+  move_seq_t *seq;
+  unsigned int h1;
+};
+
+static void pocket_solve_visit(void *data_, unsigned int m)
+{
+  struct pocket_solve_data_t *data = data_;
+  pocket_t *pocket = data->pocket;
+
+  /* a move of the rotated configuration is the same move of the
+     rotated back face in the original one */
+  unsigned int f = puzzle_action_local_act(pocket->action, 2,
+                                           pocket->faces[m], data->h1);
+  move_seq_push(data->seq, f, 0, pocket->counts[m]);
+}
+
+int pocket_solve(pocket_t *pocket, move_seq_t *seq, uint8_t *conf)
+{
+  unsigned int h = pocket_rotation(pocket, conf);
+  int32_t i = pocket_encode(pocket, conf, h);
+  if (i < 0) return -1;
+
+  struct pocket_solve_data_t data = {
+    .pocket = pocket,
+    .seq = seq,
+    .h1 = group_table_inv(&pocket->action->table, h),
+  };
+
+  unsigned int n = pocket_walk(pocket, i, pocket_solve_visit, &data);
+  if (h != 0) move_seq_push(seq, MOVE_OP_ROTATION, h, 1);
+  return n;
+}
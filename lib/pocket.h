@@ -0,0 +1,90 @@
+#ifndef POCKET_H
+#define POCKET_H
+
+#include <stdint.h>
+
+#include "cube.h"
+#include "dist_table.h"
+
+struct move_seq_t;
+typedef struct move_seq_t move_seq_t;
+
+/* God's algorithm for the 2x2x2 cube.
+
+Turns of faces 0, 2 and 4 never move the corner in layer 0 of faces 1,
+3 and 5, so every configuration of a 2x2x2 cube is, up to a rotation
+of the whole cube, a unique configuration of the 7 other corners
+reachable with those turns. It is determined by the permutation of the
+7 corners, and by the orientations of the corners at 6 of their
+positions, since their sum is 0 modulo 3. Configurations are indexed
+by permutation, then orientations.
+
+The distance table stores the distance of every configuration from the
+solved one modulo 3, in 2 bits. This is enough to find, at every step
+of an optimal solution, a move to a configuration one move closer. */
+
+#define POCKET_NUM_PERMS 5040
+#define POCKET_NUM_TWISTS 729
+#define POCKET_NUM_STATES (POCKET_NUM_PERMS * POCKET_NUM_TWISTS)
+
+struct pocket_t
+{
+  puzzle_action_t *action;
+  cube_shape_t *shape;
+
+  /* count the half turns as single moves, instead of two quarter
+     turns */
+  int half_turns;
+
+  /* the corner that never moves */
+  unsigned int fixed;
+
+  /* face and count of every move */
+  unsigned int num_moves;
+  uint8_t faces[9];
+  int8_t counts[9];
+
+  /* permutation and orientation indices after move m, at index i *
+     num_moves + m */
+  uint16_t *perm_move;
+  uint16_t *twist_move;
+
+  /* distances modulo 3 of every configuration, 2 bits each */
+  dist_table_t table;
+  uint32_t solved;
+};
+typedef struct pocket_t pocket_t;
+
+/* Compute the move tables for the 2x2x2 cube of shape. The distance
+   table is empty until pocket_build or pocket_load is called. */
+void pocket_init(pocket_t *pocket, puzzle_action_t *action,
+                 cube_shape_t *shape, int half_turns);
+void pocket_cleanup(pocket_t *pocket);
+
+/* Fill the distance table by a breadth-first search from the solved
+   configuration, using num_threads threads, or one per processor if it
+   is 0. */
+void pocket_build(pocket_t *pocket, unsigned int num_threads);
+
+/* Save the distance table, or load one saved with the same metric.
+   Return 0 on error. */
+int pocket_save(pocket_t *pocket, const char *path);
+int pocket_load(pocket_t *pocket, const char *path);
+
+/* Index of conf up to rotations, or -1 if its corners are not a
+   permutation or their twists do not add up to 0 modulo 3, and a
+   configuration with index i. */
+int32_t pocket_index(pocket_t *pocket, uint8_t *conf);
+void pocket_conf(pocket_t *pocket, uint8_t *conf, uint32_t i);
+
+/* distance of conf from the solved configuration, or -1 if conf cannot
+   be solved */
+int pocket_distance(pocket_t *pocket, uint8_t *conf);
+
+/* Append an optimal solution of conf to seq, followed by a rotation of
+   the whole cube when needed to get back to the solved configuration.
+   Return the number of moves of the solution, or -1 if conf cannot be
+   solved. */
+int pocket_solve(pocket_t *pocket, move_seq_t *seq, uint8_t *conf);
+
+#endif /* POCKET_H */
@@ -1,4 +1,5 @@
 #include "puzzle.h"
+#include "abs_poly.h"
 #include "group.h"
 
 #include <assert.h>
@@ -57,81 +58,268 @@ unsigned int symmetries_cell_act(symmetries_t* syms,
 /* act on a piece
    dim: dimension
    i: index of the piece
-   stab: index of the stabiliser
-   s: symmetry */
+   stab: orientation of the piece, as an element of the stabiliser of
+   cell 0, so that the piece is mapped from cell 0 by stab
+   by_cell(i)
+   s: symmetry
+
+   Return the orientation of the image, which is at cell i s. */
 unsigned int symmetries_act(symmetries_t *syms,
                             unsigned int dim,
                             unsigned int i,
                             unsigned int stab,
                             unsigned int s)
 {
-  return 0;
+  unsigned int num = syms->num;
+  unsigned int j = symmetries_cell_act(syms, dim, i, s);
+  unsigned int g = syms->mul[stab + symmetries_by_cell(syms, dim, i) * num];
+  g = syms->mul[g + s * num];
+  /* g by_cell(j)' */
+  unsigned int h = symmetries_by_cell(syms, dim, j);
+  return syms->mul[g + syms->inv_mul[h] * num];
 }
 
-void decomp_init_trivial(decomp_t *decomp, unsigned int n)
+/* Extend the map sending face 0 to face f, with vertex 0 of face 0
+   sent to vertex i of f, in the same or opposite direction depending
+   on dir. Return 0 if it is not a symmetry. */
+static int symmetries_extend(abs_poly_t *poly, poly_data_t *data,
+                             unsigned int f, unsigned int i, int dir,
+                             int *vmap, int *fmap, unsigned int *offset,
+                             unsigned int *queue)
 {
-  decomp->num_pieces = n;
-  decomp->num_orbits = n;
-  decomp->orbit_size = malloc(n * sizeof(unsigned int));
-  decomp->orbit_offset = malloc(n * sizeof(unsigned int));
-  for (unsigned int i = 0; i < n; i++) {
-    decomp->orbit_size[i] = 1;
-    decomp->orbit_offset[i] = i;
+  unsigned int nv = poly->num_vertices;
+  for (unsigned int v = 0; v < nv; v++) vmap[v] = -1;
+  for (unsigned int a = 0; a < poly->num_faces; a++) fmap[a] = -1;
+
+  unsigned int head = 0, tail = 0;
+  fmap[0] = f;
+  offset[0] = i;
+  queue[tail++] = 0;
+
+  while (head < tail) {
+    unsigned int a = queue[head++];
+    unsigned int b = fmap[a];
+    unsigned int n = poly->faces[a].num_vertices;
+    if (poly->faces[b].num_vertices != n) return 0;
+
+    /* vertex j of a is sent to vertex offset + dir j of b */
+    for (unsigned int j = 0; j < n; j++) {
+      unsigned int v = poly->faces[a].vertices[j];
+      unsigned int w = poly->faces[b].vertices
+        [(offset[a] + n + dir * (int) j) % n];
+      if (vmap[v] == -1) vmap[v] = w;
+      else if (vmap[v] != (int) w) return 0;
+    }
+
+    for (unsigned int j = 0; j < n; j++) {
+      int a1 = abs_poly_get_adj_face(poly, a, j, data->edges);
+      unsigned int v1 = poly->faces[a].vertices[(j + 1) % n];
+      unsigned int u0 = vmap[poly->faces[a].vertices[j]];
+      unsigned int u1 = vmap[v1];
+      int b1 = dir > 0 ? data->edges[u1 * nv + u0] : data->edges[u0 * nv + u1];
+      if (a1 < 0 || b1 < 0) return 0;
+
+      if (fmap[a1] != -1) {
+        if (fmap[a1] != b1) return 0;
+        continue;
+      }
+
+      unsigned int n1 = poly->faces[a1].num_vertices;
+      if (poly->faces[b1].num_vertices != n1) return 0;
+      int p = data->adj[a1 * nv + v1];
+      int q = data->adj[b1 * nv + u1];
+      assert(p >= 0);
+      if (q < 0) return 0;
+
+      fmap[a1] = b1;
+      offset[a1] = (q + n1 * n1 - dir * p) % n1;
+      queue[tail++] = a1;
+    }
+  }
+
+  /* the maps must be bijective */
+  if (tail != poly->num_faces) return 0;
+  uint8_t *seen = calloc(nv + poly->num_faces, 1);
+  int ok = 1;
+  for (unsigned int v = 0; v < nv && ok; v++) {
+    if (vmap[v] < 0 || seen[vmap[v]]++) ok = 0;
+  }
+  for (unsigned int a = 0; a < poly->num_faces && ok; a++) {
+    if (seen[nv + fmap[a]]++) ok = 0;
   }
+  free(seen);
+  return ok;
 }
 
-unsigned int decomp_orbit_of(decomp_t *decomp, unsigned int x)
+/* rotations come first, so they are preferred */
+static void symmetries_by_cell_init(unsigned int *by_cell, uint8_t *action,
+                                    unsigned int num_cells,
+                                    unsigned int num)
 {
-  assert(x < decomp->num_pieces);
+  for (unsigned int i = 0; i < num_cells; i++) by_cell[i] = num;
+  for (unsigned int s = 0; s < num; s++) {
+    unsigned int i = action[s * num_cells];
+    if (by_cell[i] == num) by_cell[i] = s;
+  }
+}
 
-  unsigned int lo = 0;
-  unsigned int hi = decomp->num_orbits;
+void symmetries_init(symmetries_t *syms, abs_poly_t *poly, poly_data_t *data)
+{
+  unsigned int nv = poly->num_vertices;
+  unsigned int nf = poly->num_faces;
+  unsigned int ne = abs_poly_num_edges(poly);
+  unsigned int n0 = poly->faces[0].num_vertices;
+
+  syms->num_vertices = nv;
+  syms->num_edges = ne;
+  syms->num_faces = nf;
+
+  /* edges by face, and by pair of vertices */
+  syms->edges_by_face = malloc(poly->len * sizeof(unsigned int));
+  unsigned int *edge_of = malloc(nv * nv * sizeof(unsigned int));
+  for (unsigned int f = 0; f < nf; f++) {
+    unsigned int n = poly->faces[f].num_vertices;
+    unsigned int *vertices = poly->faces[f].vertices;
+    for (unsigned int i = 0; i < n; i++) {
+      unsigned int e = data->edges_by_face[f][i];
+      unsigned int v0 = vertices[i];
+      unsigned int v1 = vertices[(i + 1) % n];
+      syms->edges_by_face[vertices - poly->vertices + i] = e;
+      edge_of[v0 * nv + v1] = edge_of[v1 * nv + v0] = e;
+    }
+  }
 
-  while (lo + 1 < hi) {
-    unsigned int i = (hi + lo) / 2;
-    if (decomp->orbit_offset[i] > x)
-      hi = i;
-    else
-      lo = i;
+  /* candidate symmetries, rotations first */
+  unsigned int max_num = 2 * nf * n0;
+  uint8_t *vertex_action = malloc(max_num * nv);
+  uint8_t *face_action = malloc(max_num * nf);
+  int *vmap = malloc(nv * sizeof(int));
+  int *fmap = malloc(nf * sizeof(int));
+  unsigned int *offset = malloc(nf * sizeof(unsigned int));
+  unsigned int *queue = malloc(nf * sizeof(unsigned int));
+
+  /* symmetry by image of face 0, of its first vertex, and direction */
+  int *by_flag = malloc(2 * nf * nv * sizeof(int));
+  for (unsigned int i = 0; i < 2 * nf * nv; i++) by_flag[i] = -1;
+
+  unsigned int num = 0;
+  syms->num_rotations = 0;
+  for (int dir = 1; dir >= -1; dir -= 2) {
+    for (unsigned int f = 0; f < nf; f++) {
+      for (unsigned int i = 0; i < poly->faces[f].num_vertices; i++) {
+        if (!symmetries_extend(poly, data, f, i, dir,
+                               vmap, fmap, offset, queue)) continue;
+        assert(num < 256);
+        for (unsigned int v = 0; v < nv; v++) {
+          vertex_action[num * nv + v] = vmap[v];
+        }
+        for (unsigned int a = 0; a < nf; a++) {
+          face_action[num * nf + a] = fmap[a];
+        }
+        unsigned int w = poly->faces[f].vertices[i];
+        by_flag[((dir < 0) * nf + f) * nv + w] = num;
+        num++;
+      }
+    }
+    if (dir > 0) syms->num_rotations = num;
+  }
+  syms->num = num;
+
+  syms->vertex_action = realloc(vertex_action, num * nv);
+  syms->face_action = realloc(face_action, num * nf);
+  syms->edge_action = malloc(num * ne);
+  for (unsigned int s = 0; s < num; s++) {
+    uint8_t *vact = &syms->vertex_action[s * nv];
+    for (unsigned int f = 0; f < nf; f++) {
+      unsigned int n = poly->faces[f].num_vertices;
+      for (unsigned int i = 0; i < n; i++) {
+        unsigned int v0 = poly->faces[f].vertices[i];
+        unsigned int v1 = poly->faces[f].vertices[(i + 1) % n];
+        syms->edge_action[s * ne + data->edges_by_face[f][i]] =
+          edge_of[vact[v0] * nv + vact[v1]];
+      }
+    }
   }
 
-  return lo;
+  /* x y is determined by the image of the first flag under x, then y */
+  unsigned int v0 = poly->faces[0].vertices[0];
+  syms->mul = malloc(num * num);
+  for (unsigned int x = 0; x < num; x++) {
+    for (unsigned int y = 0; y < num; y++) {
+      unsigned int f = syms->face_action[y * nf + syms->face_action[x * nf]];
+      unsigned int w = syms->vertex_action
+        [y * nv + syms->vertex_action[x * nv + v0]];
+      unsigned int reflection = (x >= syms->num_rotations) ^
+        (y >= syms->num_rotations);
+      int xy = by_flag[(reflection * nf + f) * nv + w];
+      assert(xy >= 0);
+      syms->mul[x + y * num] = xy;
+    }
+  }
+  syms->inv_mul = malloc(num * num);
+  group_inv_table(syms->inv_mul, syms->mul, num);
+
+  syms->by_vertex = malloc(nv * sizeof(unsigned int));
+  symmetries_by_cell_init(syms->by_vertex, syms->vertex_action,
+                          nv, num);
+  syms->by_edge = malloc(ne * sizeof(unsigned int));
+  symmetries_by_cell_init(syms->by_edge, syms->edge_action,
+                          ne, num);
+  syms->by_face = malloc(nf * sizeof(unsigned int));
+  symmetries_by_cell_init(syms->by_face, syms->face_action,
+                          nf, num);
+
+  free(edge_of);
+  free(vmap);
+  free(fmap);
+  free(offset);
+  free(queue);
+  free(by_flag);
 }
 
-/* global piece index from orbit and local index */
-unsigned int decomp_global(decomp_t *decomp, unsigned int i, unsigned int j)
+void symmetries_cleanup(symmetries_t *syms)
 {
-  return decomp->orbit_offset[i] + j;
+  free(syms->by_vertex);
+  free(syms->by_edge);
+  free(syms->by_face);
+  free(syms->face_action);
+  free(syms->vertex_action);
+  free(syms->edge_action);
+  free(syms->edges_by_face);
+  free(syms->mul);
+  free(syms->inv_mul);
 }
 
-/* local piece index */
-unsigned int decomp_local(decomp_t *decomp, unsigned int j)
+static void decomp_init_index(decomp_t *decomp)
 {
-  unsigned int i = decomp_orbit_of(decomp, j);
-  return j - decomp->orbit_offset[i];
+  decomp->orbit_of = malloc(decomp->num_pieces * sizeof(unsigned int));
+  decomp->local_index = malloc(decomp->num_pieces * sizeof(unsigned int));
+  for (unsigned int i = 0; i < decomp->num_orbits; i++) {
+    for (unsigned int j = 0; j < decomp->orbit_size[i]; j++) {
+      decomp->orbit_of[decomp->orbit_offset[i] + j] = i;
+      decomp->local_index[decomp->orbit_offset[i] + j] = j;
+    }
+  }
 }
 
-/* representative (i.e. first element) of an orbit */
-unsigned int decomp_repr(decomp_t *decomp, unsigned int i)
+void decomp_init_trivial(decomp_t *decomp, unsigned int n)
 {
-  return decomp->orbit_offset[decomp_orbit_of(decomp, i)];
+  decomp->num_pieces = n;
+  decomp->num_orbits = n;
+  decomp->orbit_size = malloc(n * sizeof(unsigned int));
+  decomp->orbit_offset = malloc((n + 1) * sizeof(unsigned int));
+  for (unsigned int i = 0; i < n; i++) {
+    decomp->orbit_size[i] = 1;
+    decomp->orbit_offset[i] = i;
+  }
+  decomp->orbit_offset[n] = n;
+  decomp_init_index(decomp);
 }
 
 unsigned int puzzle_action_act(puzzle_action_t *puzzle, unsigned int x, unsigned int g)
 {
-  unsigned int i = decomp_orbit_of(&puzzle->decomp, x);
-  x -= puzzle->decomp.orbit_offset[i];
-  unsigned int j = puzzle_action_local_act(puzzle, i, x, g);
-  return puzzle->decomp.orbit_offset[i] + j;
-}
-
-unsigned int puzzle_action_local_act(puzzle_action_t *puzzle,
-                                     unsigned int k, unsigned int x,
-                                     unsigned int g)
-{
-  unsigned int g0 = puzzle->by_stab[k][x];
-  unsigned int g1 = group_mul(puzzle->group, g0, g);
-  return puzzle->inv_by_stab[k][g1] % puzzle->decomp.orbit_size[k];
+  unsigned int j = puzzle->act[x * puzzle->table.num + g];
+  return decomp_repr(&puzzle->decomp, x) + j;
 }
 
 unsigned int puzzle_action_stab(puzzle_action_t *action,
@@ -140,7 +328,7 @@ unsigned int puzzle_action_stab(puzzle_action_t *action,
   int stab_size = action->group->num / action->decomp.orbit_size[k];
   c = ((c % stab_size) + stab_size) % stab_size;
   unsigned int s = action->by_stab[k][action->decomp.orbit_size[k] * c];
-  return group_conj(action->group, s, action->by_stab[k][i]);
+  return group_table_conj(&action->table, s, action->by_stab[k][i]);
 }
 
 void decomp_init(decomp_t *decomp,
@@ -160,12 +348,15 @@ void decomp_init(decomp_t *decomp,
       decomp->orbit_offset[i - 1] + decomp->orbit_size[i - 1];
   }
   decomp->num_pieces = decomp->orbit_offset[num_orbits];
+  decomp_init_index(decomp);
 }
 
 void decomp_cleanup(decomp_t *decomp)
 {
   free(decomp->orbit_size);
   free(decomp->orbit_offset);
+  free(decomp->orbit_of);
+  free(decomp->local_index);
 }
 
 void puzzle_action_init(puzzle_action_t *puzzle,
@@ -174,6 +365,8 @@ void puzzle_action_init(puzzle_action_t *puzzle,
 {
   decomp_init(&puzzle->decomp, num_orbits, orbit_size);
   puzzle->group = group;
+  assert(group->table);
+  puzzle->table = *group->table;
 
   puzzle->by_stab = malloc(num_orbits * sizeof(uint8_t *));
   puzzle->inv_by_stab = malloc(num_orbits * sizeof(uint8_t *));
@@ -182,13 +375,27 @@ void puzzle_action_init(puzzle_action_t *puzzle,
     puzzle->inv_by_stab[i] = malloc(group->num);
     for (unsigned int j = 0; j < group->num; j++) {
       unsigned int g =
-        group_mul(puzzle->group,
-                  stab[i][j / puzzle->decomp.orbit_size[i]],
-                  orbit[i][j % puzzle->decomp.orbit_size[i]]);
+        group_table_mul(&puzzle->table,
+                        stab[i][j / puzzle->decomp.orbit_size[i]],
+                        orbit[i][j % puzzle->decomp.orbit_size[i]]);
       puzzle->by_stab[i][j] = g;
       puzzle->inv_by_stab[i][g] = j;
     }
   }
+
+  puzzle->act = malloc(puzzle->decomp.num_pieces * group->num);
+  for (unsigned int i = 0; i < num_orbits; i++) {
+    unsigned int size = puzzle->decomp.orbit_size[i];
+    for (unsigned int x = 0; x < size; x++) {
+      uint8_t *act = &puzzle->act[decomp_global(&puzzle->decomp, i, x) *
+                                  group->num];
+      for (unsigned int g = 0; g < group->num; g++) {
+        unsigned int g1 = group_table_mul(&puzzle->table,
+                                          puzzle->by_stab[i][x], g);
+        act[g] = puzzle->inv_by_stab[i][g1] % size;
+      }
+    }
+  }
 }
 
 void puzzle_action_cleanup(puzzle_action_t *puzzle)
@@ -197,13 +404,37 @@ void puzzle_action_cleanup(puzzle_action_t *puzzle)
   group_cleanup(puzzle->group);
 
   free(puzzle->group);
+  for (unsigned int i = 0; i < puzzle->decomp.num_orbits; i++) {
+    free(puzzle->by_stab[i]);
+    free(puzzle->inv_by_stab[i]);
+  }
   free(puzzle->by_stab);
   free(puzzle->inv_by_stab);
+  free(puzzle->act);
 }
 
-void turn_del(turn_t *turn)
+turn_t *turn_new(unsigned int num_pieces)
+{
+  turn_t *turn = malloc(sizeof(turn_t));
+  turn_init(turn, num_pieces);
+  return turn;
+}
+
+void turn_init(turn_t *turn, unsigned int num_pieces)
+{
+  turn->g = 0;
+  turn->num_pieces = 0;
+  turn->pieces = malloc(num_pieces * sizeof(unsigned int));
+}
+
+void turn_cleanup(turn_t *turn)
 {
   free(turn->pieces);
+}
+
+void turn_del(turn_t *turn)
+{
+  turn_cleanup(turn);
   free(turn);
 }
 
@@ -224,7 +455,7 @@ void decomp_split_turn(decomp_t *decomp, turn_t *turn,
 
   for (unsigned int i = 0; i < turn->num_pieces; i++) {
     unsigned int k = decomp_orbit_of(decomp, turn->pieces[i]);
-    splits[k][num_pieces[k]++] = turn->pieces[i] - decomp->orbit_offset[k];
+    splits[k][num_pieces[k]++] = decomp_local(decomp, turn->pieces[i]);
   }
 }
 
@@ -245,23 +476,30 @@ unsigned int puzzle_facelet_default(void *data, unsigned int k,
 
 turn_t *puzzle_move(puzzle_t *puzzle, uint8_t *conf, move_t *move)
 {
-  turn_t *turn = malloc(sizeof(turn_t));
-  turn->pieces = malloc(puzzle->decomp->num_pieces * sizeof(unsigned int));
-  turn->num_pieces = 0;
+  turn_t *turn = turn_new(puzzle->decomp->num_pieces);
+  puzzle_apply_move(puzzle, conf, move, turn);
+  return turn;
+}
 
-  turn->g = move->sym;
+void puzzle_apply_move(puzzle_t *puzzle, uint8_t *conf, move_t *move,
+                       turn_t *turn)
+{
+  group_table_t *table = puzzle->group->table;
+
+  if (turn) {
+    turn->g = move->sym;
+    turn->num_pieces = 0;
+  }
 
   for (unsigned int k = 0; k < puzzle->decomp->num_orbits; k++) {
     for (unsigned int i = 0; i < puzzle->decomp->orbit_size[k]; i++) {
       unsigned int x = puzzle->decomp->orbit_offset[k] + i;
       if (move->in_layer(move->in_layer_data, conf, k, x)) {
-        conf[x] = group_mul(puzzle->group, conf[x], turn->g);
-        turn->pieces[turn->num_pieces++] = x;
+        conf[x] = group_table_mul(table, conf[x], move->sym);
+        if (turn) turn->pieces[turn->num_pieces++] = x;
       }
     }
   }
-
-  return turn;
 }
 
 uint8_t *conf_new(puzzle_action_t *action)
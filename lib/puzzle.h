@@ -3,39 +3,74 @@
 
 #include <stdint.h>
 
-struct group_t;
-typedef struct group_t group_t;
+#include "group.h"
+#include "rng.h"
 
-struct action_t;
-typedef struct action_t action_t;
+struct abs_poly_t;
+typedef struct abs_poly_t abs_poly_t;
 
+struct poly_data_t;
+typedef struct poly_data_t poly_data_t;
+
+/* Symmetries of an abstract polyhedron.
+
+A symmetry is determined by the image of the first vertex of face 0,
+the image of face 0, and whether it preserves the orientation of the
+faces. Symmetries act on cells on the right, and the rotations come
+first, so that symmetry s is a reflection if and only if s >=
+num_rotations. The identity is symmetry 0. */
 struct symmetries_t {
   unsigned int num;
+  unsigned int num_rotations;
 
   unsigned int num_vertices;
   unsigned int num_edges;
   unsigned int num_faces;
 
+  /* for every cell, a symmetry mapping cell 0 to it, rotations being
+     preferred */
   unsigned int *by_vertex;
   unsigned int *by_edge;
   unsigned int *by_face;
 
+  /* image of cell i by symmetry s, at index s * num_cells + i */
   uint8_t *face_action;
   uint8_t *vertex_action;
   uint8_t *edge_action;
 
+  /* for every face and every vertex of that face, the index of the
+     edge from that vertex to the next one, laid out like
+     abs_poly_t::vertices */
   unsigned int *edges_by_face;
 
-  /* multiplication table */
+  /* multiplication table: x y is at index x + y * num (see
+     group_table_t) */
   uint8_t *mul;
-  /* inverse multiplication table */
+  /* inverse multiplication table: x' y is at index x + y * num */
   uint8_t *inv_mul;
 };
 typedef struct symmetries_t symmetries_t;
 
+/* Compute all the symmetries of poly, which must have at most 255 of
+   them. */
+void symmetries_init(symmetries_t *syms, abs_poly_t *poly, poly_data_t *data);
+void symmetries_cleanup(symmetries_t *syms);
+
+/* Cells are vertices, edges and faces, for dim = 0, 1 and 2. */
+unsigned int symmetries_num_cells(symmetries_t *syms,
+                                  unsigned int dim);
 unsigned int symmetries_by_cell(symmetries_t *syms,
                                 unsigned int dim,
                                 unsigned int i);
+unsigned int symmetries_cell_act(symmetries_t *syms,
+                                 unsigned int dim,
+                                 unsigned int i,
+                                 unsigned int s);
+unsigned int symmetries_act(symmetries_t *syms,
+                            unsigned int dim,
+                            unsigned int i,
+                            unsigned int stab,
+                            unsigned int s);
 
 /* Orbit decomposition */
 struct decomp_t
@@ -52,6 +87,11 @@ struct decomp_t
   unsigned int num_orbits;
   unsigned int *orbit_size;
   unsigned int *orbit_offset;
+
+  /* For every piece x, the orbit i containing x, and the index of x
+     in X_i. */
+  unsigned int *orbit_of;
+  unsigned int *local_index;
 };
 typedef struct decomp_t decomp_t;
 
@@ -60,6 +100,9 @@ struct puzzle_action_t
   /* Symmetry group G of the puzzle. */
   group_t *group;
 
+  /* Multiplication tables of G, copied from the group. */
+  group_table_t table;
+
   /* Symmetries by stabiliser coset.
 
      This is a 3-dimensional matrix corresponding to the choice of a
@@ -78,15 +121,39 @@ struct puzzle_action_t
   /* The inverse of the above isomorphism family. */
   uint8_t **inv_by_stab;
 
+  /* Action table: the local index of x g, for x the k-th piece of
+     the decomposition in global order, is at index k * |G| + g. */
+  uint8_t *act;
+
   decomp_t decomp;
 };
 typedef struct puzzle_action_t puzzle_action_t;
 
 void decomp_init_trivial(decomp_t *decomp, unsigned int n);
-unsigned int decomp_orbit_of(decomp_t *puzzle, unsigned int x);
-unsigned int decomp_global(decomp_t *puzzle, unsigned int i, unsigned int j);
-unsigned int decomp_local(decomp_t *puzzle, unsigned int j);
-unsigned int decomp_repr(decomp_t *puzzle, unsigned int i);
+
+static inline unsigned int decomp_orbit_of(decomp_t *decomp, unsigned int x)
+{
+  return decomp->orbit_of[x];
+}
+
+/* global piece index from orbit and local index */
+static inline unsigned int decomp_global(decomp_t *decomp,
+                                         unsigned int i, unsigned int j)
+{
+  return decomp->orbit_offset[i] + j;
+}
+
+/* local piece index */
+static inline unsigned int decomp_local(decomp_t *decomp, unsigned int j)
+{
+  return decomp->local_index[j];
+}
+
+/* representative (i.e. first element) of the orbit of a piece */
+static inline unsigned int decomp_repr(decomp_t *decomp, unsigned int i)
+{
+  return i - decomp->local_index[i];
+}
 
 void decomp_cleanup(decomp_t *decomp);
 void decomp_init(decomp_t *decomp,
@@ -99,9 +166,17 @@ void puzzle_action_init(puzzle_action_t *puzzle,
                                group_t *group, uint8_t **orbit, uint8_t **stab);
 void puzzle_action_cleanup(puzzle_action_t *puzzle);
 unsigned int puzzle_action_act(puzzle_action_t *puzzle, unsigned int x, unsigned int g);
-unsigned int puzzle_action_local_act(puzzle_action_t *puzzle,
-                                     unsigned int k, unsigned int x,
-                                     unsigned int g);
+
+/* action of g on the element x of orbit k, in local coordinates */
+static inline unsigned int puzzle_action_local_act(puzzle_action_t *puzzle,
+                                                   unsigned int k,
+                                                   unsigned int x,
+                                                   unsigned int g)
+{
+  unsigned int i = decomp_global(&puzzle->decomp, k, x);
+  return puzzle->act[i * puzzle->table.num + g];
+}
+
 unsigned int puzzle_action_stab(puzzle_action_t *action,
                                 unsigned int k, unsigned int i, int c);
 
@@ -113,6 +188,12 @@ struct turn_t
 };
 typedef struct turn_t turn_t;
 
+/* A turn created with turn_new, or initialised with turn_init, has
+   room for num_pieces pieces, and can be reused for any number of
+   moves. */
+turn_t *turn_new(unsigned int num_pieces);
+void turn_init(turn_t *turn, unsigned int num_pieces);
+void turn_cleanup(turn_t *turn);
 void turn_del(turn_t *turn);
 
 void decomp_split_turn(decomp_t *decomp, turn_t *turn,
@@ -130,7 +211,13 @@ struct puzzle_t
   turn_t *(*move)(void *data, uint8_t *conf, unsigned int f, unsigned int l, int c);
   void *move_data;
 
-  void (*scramble)(void *data, uint8_t *conf);
+  /* Version of move that does not allocate, and records the move in
+     turn unless it is null. Return 0 if the move is not possible. It
+     takes the same data as move. */
+  int (*apply)(void *data, uint8_t *conf, unsigned int f, unsigned int l,
+               int c, turn_t *turn);
+
+  void (*scramble)(void *data, uint8_t *conf, rng_t *rng);
   void *scramble_data;
 };
 typedef struct puzzle_t puzzle_t;
@@ -154,6 +241,8 @@ struct move_t
 typedef struct move_t move_t;
 
 turn_t *puzzle_move(puzzle_t *puzzle, uint8_t *conf, move_t *move);
+void puzzle_apply_move(puzzle_t *puzzle, uint8_t *conf, move_t *move,
+                       turn_t *turn);
 uint8_t *conf_new(puzzle_action_t *action);
 
 #endif /* PUZZLE_H */
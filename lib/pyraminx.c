@@ -1,6 +1,7 @@
 #include "pyraminx.h"
 
 #include "group.h"
+#include "move_table.h"
 #include "perm.h"
 #include "puzzle.h"
 #include "utils.h"
@@ -42,7 +43,6 @@ void pyraminx_action_init(puzzle_action_t *action)
   unsigned int index = 0;
   for (unsigned int x = 0; x < 3; x++) {
     for (unsigned int y = x + 1; y < 4; y++) {
-      printf("x: %u, y: %u\n", x, y);
       uint8_t lehmer[4];
       lehmer[0] = x;
       lehmer[1] = y - 1;
@@ -50,15 +50,6 @@ void pyraminx_action_init(puzzle_action_t *action)
       lehmer[2] = lehmer_sign(lehmer, 4);
 
       orbit[1][index++] = lehmer_index(lehmer, 4, 4) / 2;
-      printf("lehmer: ");
-      debug_perm(lehmer, 4);
-
-      uint8_t perm[4];
-      perm_from_lehmer(perm, lehmer, 4);
-      printf("perm: ");
-      debug_perm(perm, 4);
-
-      printf(" orbit[1][%u]: %u\n", index - 1, orbit[1][index - 1]);
     }
   }
 
@@ -90,13 +81,13 @@ static int in_layer(puzzle_action_t *action,
                     unsigned int l, unsigned int g)
 {
   v = puzzle_action_local_act(action, 0, v,
-                              group_inv(action->group, g)) % 4;
+                              group_table_inv(&action->table, g)) % 4;
 
   if (l == 0) {
     return k == 0 && v == 0;
   }
 
-  int ret;
+  int ret = 0;
   switch (k) {
   case 0:
   case 2:
@@ -110,27 +101,47 @@ static int in_layer(puzzle_action_t *action,
   return l == 1 ? ret : !ret;
 }
 
+static int pyraminx_move_table_in_layer(void *data, unsigned int k,
+                                        unsigned int g, unsigned int v,
+                                        unsigned int l)
+{
+  return in_layer(data, k, v, l, g);
+}
+
+void pyraminx_move_table_init(move_table_t *table, puzzle_action_t *action)
+{
+  move_table_init(table, action, &action->decomp, 0, 3,
+                  pyraminx_move_table_in_layer, action);
+}
+
 turn_t *pyraminx_move(puzzle_action_t *action,
                       uint8_t *conf1, uint8_t *conf,
                       unsigned int v, unsigned int l, int c)
 {
-  turn_t *turn = malloc(sizeof(turn_t));
-  turn->pieces = malloc(action->decomp.num_pieces * sizeof(unsigned int));
-  turn->num_pieces = 0;
+  turn_t *turn = turn_new(action->decomp.num_pieces);
+  pyraminx_apply(action, conf1, conf, v, l, c, turn);
+  return turn;
+}
 
-  turn->g = puzzle_action_stab(action, 0, v, c);
+void pyraminx_apply(puzzle_action_t *action,
+                    uint8_t *conf1, uint8_t *conf,
+                    unsigned int v, unsigned int l, int c, turn_t *turn)
+{
+  unsigned int g = puzzle_action_stab(action, 0, v, c);
+  if (turn) {
+    turn->g = g;
+    turn->num_pieces = 0;
+  }
 
   for (unsigned int k = 0; k < action->decomp.num_orbits; k++) {
     for (unsigned int i = 0; i < action->decomp.orbit_size[k]; i++) {
       unsigned int i0 = action->decomp.orbit_offset[k] + i;
       if (in_layer(action, k, v, l, conf[i0])) {
-        conf1[i0] = group_mul(action->group, conf[i0], turn->g);
-        turn->pieces[turn->num_pieces++] = i0;
+        conf1[i0] = group_table_mul(&action->table, conf[i0], g);
+        if (turn) turn->pieces[turn->num_pieces++] = i0;
       }
     }
   }
-
-  return turn;
 }
 
 turn_t *pyraminx_move_(puzzle_action_t *action, uint8_t *conf,
@@ -146,17 +157,25 @@ turn_t *pyraminx_puzzle_move(void *data, uint8_t *conf,
   return pyraminx_move_(action, conf, v, l, c);
 }
 
-void pyraminx_puzzle_scramble(void *data, uint8_t *conf)
+int pyraminx_puzzle_apply(void *data, uint8_t *conf,
+                          unsigned int v, unsigned int l, int c, turn_t *turn)
+{
+  puzzle_action_t *action = data;
+  pyraminx_apply(action, conf, conf, v, l, c, turn);
+  return 1;
+}
+
+void pyraminx_puzzle_scramble(void *data, uint8_t *conf, rng_t *rng)
 {
-  unsigned int vo = rand() % 81;
+  unsigned int vo = rng_uniform(rng, 81);
 
-  unsigned int co = rand() % 81;
+  unsigned int co = rng_uniform(rng, 81);
 
   uint8_t edges[6];
   perm_id(edges, 6);
-  parity_shuffle(edges, 6, 0);
+  parity_shuffle(edges, 6, 0, rng);
 
-  unsigned int eo = rand() & 0x1f;
+  unsigned int eo = rng_uniform(rng, 32);
   eo |= ((__builtin_popcount(eo) & 1) << 5);
 
 
@@ -177,7 +196,7 @@ void pyraminx_puzzle_scramble(void *data, uint8_t *conf)
   }
   for (unsigned int g = 0; g < 12; g++) {
     unsigned int v = puzzle_action_local_act(action, 0, 0, g);
-    unsigned int g1 = group_mul(action->group, g, cos[v]);
+    unsigned int g1 = group_table_mul(&action->table, g, cos[v]);
     conf[decomp_global(&action->decomp, 2, g)] = g1;
   }
 
@@ -198,8 +217,72 @@ void pyraminx_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action)
   puzzle->cleanup_data = 0;
 
   puzzle->move = pyraminx_puzzle_move;
+  puzzle->apply = pyraminx_puzzle_apply;
   puzzle->move_data = action;
 
   puzzle->scramble = pyraminx_puzzle_scramble;
   puzzle->scramble_data = action;
 }
+
+/* Configurations without tips are indexed by the permutation of the
+   edges, then their orientations at the first 5 positions, the sum of
+   all of them being even, then the turns of the centres around every
+   vertex. Centre g is next to vertex 0 g, and after c turns of that
+   vertex, its symmetry is g times the symmetry of c turns. */
+uint32_t pyraminx_index(puzzle_action_t *action, uint8_t *conf)
+{
+  uint8_t *edges = &conf[action->decomp.orbit_offset[1]];
+  uint8_t *centres = &conf[action->decomp.orbit_offset[2]];
+  uint8_t perm[6];
+  uint8_t ori[6];
+
+  for (unsigned int e = 0; e < 6; e++) {
+    unsigned int j = action->inv_by_stab[1][edges[e]];
+    perm[e] = j % 6;
+    ori[j % 6] = j / 6;
+  }
+  unsigned int flip = 0;
+  for (unsigned int p = 0; p < 5; p++) flip = 2 * flip + ori[p];
+
+  unsigned int twist = 0;
+  for (unsigned int v = 0; v < 4; v++) {
+    unsigned int g = action->by_stab[0][v];
+    unsigned int s = group_table_inv_mul(&action->table, g, centres[g]);
+    unsigned int c = 0;
+    while (c < 2 && puzzle_action_stab(action, 0, v, c) != s) c++;
+    twist = 3 * twist + c;
+  }
+
+  return (perm_even_index(perm, 6) * 32 + flip) * 81 + twist;
+}
+
+void pyraminx_conf(puzzle_action_t *action, uint8_t *conf, uint32_t i)
+{
+  uint8_t *edges = &conf[action->decomp.orbit_offset[1]];
+  uint8_t *centres = &conf[action->decomp.orbit_offset[2]];
+  uint8_t perm[6];
+  unsigned int turns[4];
+
+  unsigned int twist = i % 81;
+  for (unsigned int v = 4; v-- > 0;) {
+    turns[v] = puzzle_action_stab(action, 0, v, twist % 3);
+    twist /= 3;
+  }
+  i /= 81;
+  unsigned int flip = i % 32;
+  perm_from_even_index(perm, 6, i / 32);
+
+  for (unsigned int v = 0; v < 4; v++) {
+    conf[v] = action->by_stab[0][v];
+  }
+  for (unsigned int g = 0; g < 12; g++) {
+    unsigned int v = puzzle_action_local_act(action, 0, 0, g) % 4;
+    centres[g] = group_table_mul(&action->table, g, turns[v]);
+  }
+  unsigned int parity = __builtin_popcount(flip) & 1;
+  for (unsigned int e = 0; e < 6; e++) {
+    unsigned int p = perm[e];
+    unsigned int o = p < 5 ? (flip >> (4 - p)) & 1 : parity;
+    edges[e] = action->by_stab[1][p + o * 6];
+  }
+}
@@ -9,9 +9,39 @@ typedef struct puzzle_t puzzle_t;
 struct puzzle_action_t;
 typedef struct puzzle_action_t puzzle_action_t;
 
+struct move_table_t;
+typedef struct move_table_t move_table_t;
+
+struct turn_t;
+typedef struct turn_t turn_t;
+
 uint8_t *pyraminx_new(puzzle_action_t *action);
 
 void pyraminx_action_init(puzzle_action_t *action);
+turn_t *pyraminx_move(puzzle_action_t *action,
+                      uint8_t *conf1, uint8_t *conf,
+                      unsigned int v, unsigned int l, int c);
+
+/* Non-allocating version of pyraminx_move, recording the move in turn
+   unless it is null. */
+void pyraminx_apply(puzzle_action_t *action,
+                    uint8_t *conf1, uint8_t *conf,
+                    unsigned int v, unsigned int l, int c, turn_t *turn);
+
+/* Precompiled moves of every vertex, on configurations in position
+   form. Layer 0 is the tip, layer 1 the tip with the layer below it,
+   and layer 2 the rest of the puzzle. */
+void pyraminx_move_table_init(move_table_t *table, puzzle_action_t *action);
+
 void pyraminx_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action);
 
+/* Number of configurations of the pyraminx without its tips, which
+   are left out of the index below. */
+#define PYRAMINX_NUM_STATES 933120
+
+/* Index of conf below PYRAMINX_NUM_STATES, and a configuration with
+   index i and solved tips. */
+uint32_t pyraminx_index(puzzle_action_t *action, uint8_t *conf);
+void pyraminx_conf(puzzle_action_t *action, uint8_t *conf, uint32_t i);
+
 #endif /* PYRAMINX_H */
@@ -0,0 +1,76 @@
+#include "rng.h"
+
+#define RNG_DEFAULT_SEED 0x5eed
+
+/* splitmix64, used to expand a seed into a full state */
+static uint64_t splitmix64(uint64_t *x)
+{
+  uint64_t z = (*x += UINT64_C(0x9e3779b97f4a7c15));
+  z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+  return z ^ (z >> 31);
+}
+
+void rng_init(rng_t *rng, uint64_t seed)
+{
+  for (unsigned int i = 0; i < 4; i++) {
+    rng->s[i] = splitmix64(&seed);
+  }
+}
+
+/* Jumps are computed by running the generator and accumulating the
+   states corresponding to the bits of a polynomial. */
+static void rng_jump_(rng_t *rng, const uint64_t *poly)
+{
+  uint64_t s[4] = { 0, 0, 0, 0 };
+  for (unsigned int i = 0; i < 4; i++) {
+    for (unsigned int b = 0; b < 64; b++) {
+      if (poly[i] & (UINT64_C(1) << b)) {
+        for (unsigned int j = 0; j < 4; j++) {
+          s[j] ^= rng->s[j];
+        }
+      }
+      rng_next(rng);
+    }
+  }
+
+  for (unsigned int j = 0; j < 4; j++) {
+    rng->s[j] = s[j];
+  }
+}
+
+void rng_jump(rng_t *rng)
+{
+  static const uint64_t poly[] = {
+    UINT64_C(0x180ec6d33cfd0aba), UINT64_C(0xd5a61266f0c9392c),
+    UINT64_C(0xa9582618e03fc9aa), UINT64_C(0x39abdc4529b1661c),
+  };
+  rng_jump_(rng, poly);
+}
+
+void rng_long_jump(rng_t *rng)
+{
+  static const uint64_t poly[] = {
+    UINT64_C(0x76e15d3efefdcbbf), UINT64_C(0xc5004e441c522fb3),
+    UINT64_C(0x77710069854ee241), UINT64_C(0x39109bb02acbe635),
+  };
+  rng_jump_(rng, poly);
+}
+
+rng_t *rng_default(void)
+{
+  static unsigned int num_threads = 0;
+  static __thread int initialised = 0;
+  static __thread rng_t rng;
+
+  if (!initialised) {
+    unsigned int index = __atomic_fetch_add(&num_threads, 1, __ATOMIC_RELAXED);
+    rng_init(&rng, RNG_DEFAULT_SEED);
+    for (unsigned int i = 0; i < index; i++) {
+      rng_long_jump(&rng);
+    }
+    initialised = 1;
+  }
+
+  return &rng;
+}
@@ -0,0 +1,66 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/* xoshiro256** pseudo-random number generator. States are independent
+   of each other, so every thread, or every job that needs to be
+   reproducible, can use its own. */
+struct rng_t
+{
+  uint64_t s[4];
+};
+typedef struct rng_t rng_t;
+
+/* initialise a state from a 64-bit seed */
+void rng_init(rng_t *rng, uint64_t seed);
+
+/* Advance the state by 2^128 and 2^192 steps respectively, which is
+   equivalent to that many calls to rng_next. Jumping repeatedly from
+   the same seed gives non-overlapping streams for parallel use. */
+void rng_jump(rng_t *rng);
+void rng_long_jump(rng_t *rng);
+
+/* State used by the functions that do not take one explicitly. Each
+   thread gets its own, seeded with a fixed seed and moved to a
+   separate stream with rng_long_jump. */
+rng_t *rng_default(void);
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(rng_t *rng)
+{
+  uint64_t *s = rng->s;
+  uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+
+  return result;
+}
+
+/* Uniformly distributed integer in [0, n), for n > 0, without modulo
+   bias. The top 32 bits of a random number are scaled by n, and the
+   results falling in the uneven part of the range, which are rare,
+   are rejected. */
+static inline uint32_t rng_uniform(rng_t *rng, uint32_t n)
+{
+  uint64_t m = (rng_next(rng) >> 32) * n;
+  if ((uint32_t) m < n) {
+    uint32_t threshold = -n % n;
+    while ((uint32_t) m < threshold) {
+      m = (rng_next(rng) >> 32) * n;
+    }
+  }
+  return m >> 32;
+}
+
+#endif /* RNG_H */
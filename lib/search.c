@@ -0,0 +1,408 @@
+#include "search.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "notation.h"
+#include "puzzle.h"
+
+/* A worker of the pool, with its deque of tasks [lo, hi). The owner
+   takes tasks from the end, and thieves take the first half. */
+struct search_worker_t
+{
+  search_pool_t *pool;
+  unsigned int index;
+
+  pthread_mutex_t lock;
+  unsigned int lo;
+  unsigned int hi;
+
+  /* states along the current path, and its moves */
+  uint8_t *states;
+  uint8_t moves[SEARCH_MAX_DEPTH];
+  uint64_t num_nodes;
+
+  /* keep workers written by different threads on different cache
+     lines */
+  char pad[64];
+};
+
+struct search_pool_t
+{
+  search_t *search;
+  struct search_worker_t *workers;
+  pthread_t *threads;
+
+  /* Helper threads wait for the generation to change, and count
+     themselves in num_done once they have no task left. */
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  unsigned int generation;
+  unsigned int num_done;
+  int quit;
+
+  /* current iteration: solutions of depth moves, and tasks of split
+     moves each */
+  unsigned int depth;
+  unsigned int split;
+  int generating;
+  unsigned int num_tasks;
+  unsigned int tasks_size;
+  uint8_t *tasks;
+
+  int all;
+  int stop;
+  pthread_mutex_t result_lock;
+  search_result_t *result;
+};
+
+void search_result_init(search_result_t *result)
+{
+  result->length = 0;
+  result->num_solutions = 0;
+  result->size = 0;
+  result->moves = 0;
+  result->num_nodes = 0;
+}
+
+void search_result_cleanup(search_result_t *result)
+{
+  free(result->moves);
+}
+
+static void search_record(search_pool_t *pool, const uint8_t *moves)
+{
+  search_result_t *result = pool->result;
+
+  pthread_mutex_lock(&pool->result_lock);
+  if (pool->all || !pool->stop) {
+    unsigned int size = (result->num_solutions + 1) * pool->depth;
+    if (size > result->size) {
+      result->size = 2 * size;
+      result->moves = realloc(result->moves, result->size);
+    }
+    memcpy(&result->moves[result->num_solutions * pool->depth], moves,
+           pool->depth);
+    result->num_solutions++;
+    if (!pool->all) __atomic_store_n(&pool->stop, 1, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&pool->result_lock);
+}
+
+static void search_add_task(search_pool_t *pool, const uint8_t *moves)
+{
+  if (pool->num_tasks == pool->tasks_size) {
+    pool->tasks_size = pool->tasks_size ? 2 * pool->tasks_size : 1024;
+    pool->tasks = realloc(pool->tasks, pool->tasks_size * pool->split);
+  }
+  memcpy(&pool->tasks[pool->num_tasks * pool->split], moves, pool->split);
+  pool->num_tasks++;
+}
+
+/* Depth-first search below node n of the path of worker, for solutions
+   of pool->depth moves. While generating the tasks, nodes at the split
+   depth are made into tasks instead. */
+static void search_node(struct search_worker_t *worker, unsigned int n)
+{
+  search_pool_t *pool = worker->pool;
+  search_t *search = pool->search;
+  size_t size = search->state_size;
+  const uint8_t *state = &worker->states[n * size];
+
+  if (__atomic_load_n(&pool->stop, __ATOMIC_RELAXED)) return;
+  if (pool->generating && n == pool->split && n < pool->depth) {
+    search_add_task(pool, worker->moves);
+    return;
+  }
+
+  worker->num_nodes++;
+  unsigned int bound = pool->depth - n;
+  if (search->heuristic(search->data, state, bound) > bound) return;
+  if (n == pool->depth) {
+    if (search->goal(search->data, state)) {
+      search_record(pool, worker->moves);
+    }
+    return;
+  }
+
+  uint8_t *next = &worker->states[(n + 1) * size];
+  for (unsigned int m = 0; m < search->num_moves; m++) {
+    if (n > 0 && search->allowed &&
+        !search->allowed(search->data, worker->moves[n - 1], m)) continue;
+    if (!search->move(search->move_data, state, m, next)) continue;
+    worker->moves[n] = m;
+    search_node(worker, n + 1);
+  }
+}
+
+/* Take a task from the deque of worker, or steal half of the deque of
+   another one. Return 0 if there is none left. */
+static int search_take(struct search_worker_t *worker, unsigned int *task)
+{
+  search_pool_t *pool = worker->pool;
+  unsigned int num_threads = pool->search->num_threads;
+
+  pthread_mutex_lock(&worker->lock);
+  int found = worker->lo < worker->hi;
+  if (found) *task = --worker->hi;
+  pthread_mutex_unlock(&worker->lock);
+  if (found) return 1;
+
+  for (unsigned int k = 1; k < num_threads; k++) {
+    struct search_worker_t *victim =
+      &pool->workers[(worker->index + k) % num_threads];
+    unsigned int lo = 0, mid = 0;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->lo < victim->hi) {
+      lo = victim->lo;
+      mid = lo + (victim->hi - lo + 1) / 2;
+      victim->lo = mid;
+    }
+    pthread_mutex_unlock(&victim->lock);
+
+    if (mid > lo) {
+      pthread_mutex_lock(&worker->lock);
+      worker->lo = lo;
+      worker->hi = mid - 1;
+      pthread_mutex_unlock(&worker->lock);
+      *task = mid - 1;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static void search_work(struct search_worker_t *worker)
+{
+  search_pool_t *pool = worker->pool;
+  search_t *search = pool->search;
+  size_t size = search->state_size;
+  unsigned int task;
+
+  while (!__atomic_load_n(&pool->stop, __ATOMIC_RELAXED) &&
+         search_take(worker, &task)) {
+    /* replay the moves of the task from the root */
+    const uint8_t *moves = &pool->tasks[task * pool->split];
+    for (unsigned int i = 0; i < pool->split; i++) {
+      int ok = search->move(search->move_data, &worker->states[i * size],
+                            moves[i], &worker->states[(i + 1) * size]);
+      assert(ok);
+      (void) ok;
+      worker->moves[i] = moves[i];
+    }
+    search_node(worker, pool->split);
+  }
+}
+
+static void *search_thread(void *data)
+{
+  struct search_worker_t *worker = data;
+  search_pool_t *pool = worker->pool;
+  unsigned int generation = 0;
+
+  while (1) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->generation == generation && !pool->quit) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    int quit = pool->quit;
+    generation = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    if (quit) break;
+
+    search_work(worker);
+
+    pthread_mutex_lock(&pool->lock);
+    if (++pool->num_done + 1 == pool->search->num_threads) {
+      pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  return 0;
+}
+
+void search_init(search_t *search, size_t state_size, unsigned int num_moves,
+                 search_move_t move, void *move_data,
+                 search_heuristic_t heuristic,
+                 search_goal_t goal, search_allowed_t allowed, void *data,
+                 unsigned int num_threads, unsigned int split_depth)
+{
+  assert(num_moves <= 256);
+  if (num_threads == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = n > 0 ? n : 1;
+  }
+
+  search->state_size = state_size;
+  search->num_moves = num_moves;
+  search->move = move;
+  search->move_data = move_data;
+  search->heuristic = heuristic;
+  search->goal = goal;
+  search->allowed = allowed;
+  search->data = data;
+  search->split_depth = split_depth;
+  search->num_threads = num_threads;
+  search->puzzle = 0;
+  search->moves = 0;
+
+  search_pool_t *pool = malloc(sizeof(search_pool_t));
+  search->pool = pool;
+  pool->search = search;
+  pthread_mutex_init(&pool->lock, 0);
+  pthread_cond_init(&pool->start, 0);
+  pthread_cond_init(&pool->done, 0);
+  pthread_mutex_init(&pool->result_lock, 0);
+  pool->generation = 0;
+  pool->quit = 0;
+  pool->num_tasks = 0;
+  pool->tasks_size = 0;
+  pool->tasks = 0;
+  pool->stop = 0;
+
+  pool->workers = malloc(num_threads * sizeof(struct search_worker_t));
+  for (unsigned int k = 0; k < num_threads; k++) {
+    struct search_worker_t *worker = &pool->workers[k];
+    worker->pool = pool;
+    worker->index = k;
+    pthread_mutex_init(&worker->lock, 0);
+    worker->lo = worker->hi = 0;
+    worker->states = malloc((SEARCH_MAX_DEPTH + 1) * state_size);
+  }
+
+  /* the calling thread is worker 0 */
+  pool->threads = malloc(num_threads * sizeof(pthread_t));
+  for (unsigned int k = 1; k < num_threads; k++) {
+    pthread_create(&pool->threads[k], 0, search_thread, &pool->workers[k]);
+  }
+}
+
+void search_cleanup(search_t *search)
+{
+  search_pool_t *pool = search->pool;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->quit = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (unsigned int k = 1; k < search->num_threads; k++) {
+    pthread_join(pool->threads[k], 0);
+  }
+
+  for (unsigned int k = 0; k < search->num_threads; k++) {
+    pthread_mutex_destroy(&pool->workers[k].lock);
+    free(pool->workers[k].states);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  pthread_mutex_destroy(&pool->result_lock);
+  free(pool->workers);
+  free(pool->threads);
+  free(pool->tasks);
+  free(pool);
+}
+
+/* One iteration, for solutions of depth moves. */
+static void search_iteration(search_t *search, unsigned int depth)
+{
+  search_pool_t *pool = search->pool;
+  unsigned int num_threads = search->num_threads;
+
+  pool->depth = depth;
+  pool->split = search->split_depth < depth ? search->split_depth : depth;
+  pool->num_tasks = 0;
+  pool->generating = 1;
+  search_node(&pool->workers[0], 0);
+  pool->generating = 0;
+  if (pool->num_tasks == 0 || pool->stop) return;
+
+  for (unsigned int k = 0; k < num_threads; k++) {
+    struct search_worker_t *worker = &pool->workers[k];
+    worker->lo = (uint64_t) pool->num_tasks * k / num_threads;
+    worker->hi = (uint64_t) pool->num_tasks * (k + 1) / num_threads;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->num_done = 0;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  search_work(&pool->workers[0]);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->num_done + 1 < num_threads) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+int search_run(search_t *search, const void *state, unsigned int max_depth,
+               int all, search_result_t *result)
+{
+  search_pool_t *pool = search->pool;
+  if (max_depth > SEARCH_MAX_DEPTH) max_depth = SEARCH_MAX_DEPTH;
+
+  result->length = 0;
+  result->num_solutions = 0;
+  result->num_nodes = 0;
+  pool->result = result;
+  pool->all = all;
+  pool->stop = 0;
+
+  for (unsigned int k = 0; k < search->num_threads; k++) {
+    struct search_worker_t *worker = &pool->workers[k];
+    memcpy(worker->states, state, search->state_size);
+    worker->num_nodes = 0;
+  }
+
+  unsigned int depth = search->heuristic(search->data, state, max_depth);
+  for (; depth <= max_depth && result->num_solutions == 0; depth++) {
+    search_iteration(search, depth);
+  }
+
+  for (unsigned int k = 0; k < search->num_threads; k++) {
+    result->num_nodes += pool->workers[k].num_nodes;
+  }
+
+  if (result->num_solutions == 0) return -1;
+  result->length = depth - 1;
+  return result->length;
+}
+
+static int search_puzzle_move(void *data, const void *state, unsigned int m,
+                              void *next)
+{
+  search_t *search = data;
+  memcpy(next, state, search->state_size);
+  return move_op_apply(search->puzzle, next, &search->moves->ops[m]);
+}
+
+void search_puzzle_init(search_t *search, puzzle_t *puzzle, move_seq_t *moves,
+                        search_heuristic_t heuristic, search_goal_t goal,
+                        void *data, unsigned int num_threads,
+                        unsigned int split_depth)
+{
+  search_init(search, puzzle->decomp->num_pieces, moves->num,
+              search_puzzle_move, search, heuristic, goal, 0, data,
+              num_threads, split_depth);
+  search->puzzle = puzzle;
+  search->moves = moves;
+}
+
+void search_puzzle_solution(search_t *search, search_result_t *result,
+                            unsigned int i, move_seq_t *seq)
+{
+  for (unsigned int k = 0; k < result->length; k++) {
+    move_op_t *op =
+      &search->moves->ops[result->moves[i * result->length + k]];
+    move_seq_push(seq, op->face, op->layer, op->count);
+  }
+}
@@ -0,0 +1,114 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct puzzle_t;
+typedef struct puzzle_t puzzle_t;
+
+struct move_seq_t;
+typedef struct move_seq_t move_seq_t;
+
+struct search_pool_t;
+typedef struct search_pool_t search_pool_t;
+
+/* Parallel iterative deepening A* search.
+
+States are opaque blocks of state_size bytes, and the search is given
+by callbacks on them: the state after move m, which takes its own
+data and fails if the move is not possible, a lower bound on the
+number of moves to a goal, which must be 0 on goals, and the goal
+test. The heuristic is only needed up to a bound, and may return any
+larger value as soon as it exceeds it. An optional callback tells
+whether move m may follow move last, to skip redundant sequences.
+
+Every iteration searches for solutions of a given length. The tree is
+expanded up to split_depth moves, and its nodes become tasks, which
+are split among the deques of the threads of a pool. Threads take
+tasks from their own deque, and once it is empty steal half of the
+tasks left in the deque of another thread.
+
+The search stops at the first solution found, which is then not
+necessarily the first one in move order, or finds all the solutions
+of the smallest length that are not skipped by the callback. */
+
+#define SEARCH_MAX_DEPTH 64
+
+typedef int (*search_move_t)(void *data, const void *state, unsigned int m,
+                             void *next);
+typedef unsigned int (*search_heuristic_t)(void *data, const void *state,
+                                           unsigned int bound);
+typedef int (*search_goal_t)(void *data, const void *state);
+typedef int (*search_allowed_t)(void *data, unsigned int last,
+                                unsigned int m);
+
+struct search_t
+{
+  size_t state_size;
+  unsigned int num_moves;
+
+  search_move_t move;
+  void *move_data;
+  search_heuristic_t heuristic;
+  search_goal_t goal;
+  search_allowed_t allowed;
+  void *data;
+
+  unsigned int split_depth;
+  unsigned int num_threads;
+  search_pool_t *pool;
+
+  /* used by search_puzzle_init */
+  puzzle_t *puzzle;
+  move_seq_t *moves;
+};
+typedef struct search_t search_t;
+
+/* Solutions of a search, as move indices, solution i starting at index
+   i * length. */
+struct search_result_t
+{
+  unsigned int length;
+  unsigned int num_solutions;
+  unsigned int size;
+  uint8_t *moves;
+
+  uint64_t num_nodes;
+};
+typedef struct search_result_t search_result_t;
+
+void search_result_init(search_result_t *result);
+void search_result_cleanup(search_result_t *result);
+
+/* Start a pool of num_threads threads, or one per processor if it is
+   0, the calling thread being one of them. Tasks are the nodes at
+   split_depth moves from the root, or fewer if the solution is
+   shorter. At most 256 moves are supported. */
+void search_init(search_t *search, size_t state_size, unsigned int num_moves,
+                 search_move_t move, void *move_data,
+                 search_heuristic_t heuristic,
+                 search_goal_t goal, search_allowed_t allowed, void *data,
+                 unsigned int num_threads, unsigned int split_depth);
+void search_cleanup(search_t *search);
+
+/* Search solutions from state of at most max_depth moves, stopping at
+   the first one unless all is set, and set result. Return the length
+   of the solutions, or -1 if there is none. */
+int search_run(search_t *search, const void *state, unsigned int max_depth,
+               int all, search_result_t *result);
+
+/* Search on configurations of puzzle, with the moves of seq, which is
+   not copied, applied by the apply callback of the puzzle. The
+   callbacks take configurations as states. */
+void search_puzzle_init(search_t *search, puzzle_t *puzzle, move_seq_t *moves,
+                        search_heuristic_t heuristic, search_goal_t goal,
+                        void *data, unsigned int num_threads,
+                        unsigned int split_depth);
+
+/* Append solution i of result to seq, as moves of a search initialised
+   by search_puzzle_init. */
+void search_puzzle_solution(search_t *search, search_result_t *result,
+                            unsigned int i, move_seq_t *seq);
+
+#endif /* SEARCH_H */
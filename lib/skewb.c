@@ -1,11 +1,13 @@
 #include "skewb.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "group.h"
+#include "perm.h"
 #include "puzzle.h"
 
-void skweb_action_init(puzzle_action_t *action)
+void skewb_action_init(puzzle_action_t *action)
 {
   group_t *group = malloc(sizeof(group_t));
   group_a4_init(group);
@@ -35,16 +37,12 @@ void skweb_action_init(puzzle_action_t *action)
     orbit[1][i] = i * 3;
   }
 
-  /* centre orbit */
-  uint8_t found = 0;
-  unsigned int face = 0;
-  for (unsigned int i = 0; i < 4; i++) {
-    for (unsigned int j = i + 1; j < 4; j++) {
-      /* symmetry mapping 0 to i and 1 to j */
-      unsigned int sym = i * 3 + j - 1;
-      orbit[2][face++] = sym;
-    }
-  }
+  /* Centre 0 is on the face of corners 0 and 3 of orbit 0, which are
+     swapped by its stabiliser. Every other centre is the image of
+     centre 0 by a symmetry mapping corners 0 and 3 to the two corners
+     of orbit 0 on its face. */
+  static const uint8_t centres[6] = { 0, 1, 2, 3, 4, 6 };
+  memcpy(orbit[2], centres, 6);
 
   puzzle_action_init(action, num_orbits, orbit_size,
                      group, orbit, stab);
@@ -54,3 +52,173 @@ void skweb_action_init(puzzle_action_t *action)
     free(stab[k]);
   }
 }
+
+uint8_t *skewb_new(puzzle_action_t *action)
+{
+  return conf_new(action);
+}
+
+/* whether a piece of orbit k with symmetry g moves with corner v */
+static int in_layer(puzzle_action_t *action,
+                    unsigned int k, unsigned int v, unsigned int g)
+{
+  v = puzzle_action_local_act(action, 0, v,
+                              group_table_inv(&action->table, g)) % 4;
+
+  switch (k) {
+  case 0:
+    return v == 0;
+  case 1:
+    return v != 0;
+  default:
+    return v == 0 || v == 3;
+  }
+}
+
+void skewb_apply(puzzle_action_t *action, uint8_t *conf1, uint8_t *conf,
+                 unsigned int v, int c, turn_t *turn)
+{
+  unsigned int g = puzzle_action_stab(action, 0, v, c);
+  if (turn) {
+    turn->g = g;
+    turn->num_pieces = 0;
+  }
+
+  for (unsigned int k = 0; k < action->decomp.num_orbits; k++) {
+    for (unsigned int i = 0; i < action->decomp.orbit_size[k]; i++) {
+      unsigned int i0 = action->decomp.orbit_offset[k] + i;
+      if (in_layer(action, k, v, conf[i0])) {
+        conf1[i0] = group_table_mul(&action->table, conf[i0], g);
+        if (turn) turn->pieces[turn->num_pieces++] = i0;
+      }
+    }
+  }
+}
+
+static void skewb_puzzle_cleanup(void *data, struct puzzle_t *puzzle)
+{
+}
+
+static turn_t *skewb_puzzle_move(void *data, uint8_t *conf,
+                                 unsigned int v, unsigned int l, int c)
+{
+  puzzle_action_t *action = data;
+  turn_t *turn = turn_new(action->decomp.num_pieces);
+  skewb_apply(action, conf, conf, v, c, turn);
+  return turn;
+}
+
+static int skewb_puzzle_apply(void *data, uint8_t *conf,
+                              unsigned int v, unsigned int l, int c,
+                              turn_t *turn)
+{
+  puzzle_action_t *action = data;
+  skewb_apply(action, conf, conf, v, c, turn);
+  return 1;
+}
+
+static void skewb_puzzle_scramble(void *data, uint8_t *conf, rng_t *rng)
+{
+  puzzle_action_t *action = data;
+  skewb_conf(action, conf, rng_uniform(rng, SKEWB_NUM_STATES));
+}
+
+void skewb_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action)
+{
+  puzzle->group = action->group;
+  puzzle->decomp = &action->decomp;
+
+  puzzle->cleanup = skewb_puzzle_cleanup;
+  puzzle->cleanup_data = 0;
+
+  puzzle->move = skewb_puzzle_move;
+  puzzle->apply = skewb_puzzle_apply;
+  puzzle->move_data = action;
+
+  puzzle->scramble = skewb_puzzle_scramble;
+  puzzle->scramble_data = action;
+}
+
+/* Sum of the orientations of the corners of orbit 0 modulo 3, by index
+   of the permutation of the corners of orbit 1 among even
+   permutations. */
+static const uint8_t skewb_twist_by_perm[12] = {
+  0, 1, 2, 0, 2, 1, 1, 2, 0, 2, 1, 0
+};
+
+/* Configurations are indexed by the permutations of the centres and
+   of the corners of orbit 1, then by the orientations of the first 3
+   corners of orbit 0 and of the corners of orbit 1 at the first 3
+   positions. The sum of the orientations of the corners of orbit 1 is
+   0, and that of the corners of orbit 0 is determined by the
+   permutation of those of orbit 1. */
+uint32_t skewb_index(puzzle_action_t *action, uint8_t *conf)
+{
+  uint8_t *conf1 = &conf[action->decomp.orbit_offset[1]];
+  uint8_t *conf2 = &conf[action->decomp.orbit_offset[2]];
+  uint8_t centres[6];
+  uint8_t corners[4];
+  uint8_t ori[4];
+
+  for (unsigned int x = 0; x < 6; x++) {
+    centres[x] = action->inv_by_stab[2][conf2[x]] % 6;
+  }
+  unsigned int twist0 = 0;
+  for (unsigned int x = 0; x < 4; x++) {
+    unsigned int j = action->inv_by_stab[1][conf1[x]];
+    corners[x] = j % 4;
+    ori[j % 4] = j / 4;
+    if (x < 3) {
+      twist0 = 3 * twist0 + action->inv_by_stab[0][conf[x]] / 4;
+    }
+  }
+  unsigned int twist1 = 0;
+  for (unsigned int p = 0; p < 3; p++) twist1 = 3 * twist1 + ori[p];
+
+  uint32_t i = perm_even_index(centres, 6);
+  i = i * 12 + perm_even_index(corners, 4);
+  return (i * 27 + twist0) * 27 + twist1;
+}
+
+void skewb_conf(puzzle_action_t *action, uint8_t *conf, uint32_t i)
+{
+  uint8_t *conf1 = &conf[action->decomp.orbit_offset[1]];
+  uint8_t *conf2 = &conf[action->decomp.orbit_offset[2]];
+  uint8_t centres[6];
+  uint8_t corners[4];
+  uint8_t ori[4];
+
+  unsigned int twist1 = i % 27;
+  i /= 27;
+  unsigned int twist0 = i % 27;
+  i /= 27;
+  unsigned int perm = i % 12;
+  perm_from_even_index(corners, 4, perm);
+  perm_from_even_index(centres, 6, i / 12);
+
+  unsigned int sum = 0;
+  for (unsigned int p = 3; p-- > 0;) {
+    ori[p] = twist1 % 3;
+    sum += ori[p];
+    twist1 /= 3;
+  }
+  ori[3] = (3 - sum % 3) % 3;
+  for (unsigned int x = 0; x < 4; x++) {
+    unsigned int p = corners[x];
+    conf1[x] = action->by_stab[1][ori[p] * 4 + p];
+  }
+
+  sum = 0;
+  for (unsigned int x = 3; x-- > 0;) {
+    unsigned int o = twist0 % 3;
+    conf[x] = action->by_stab[0][o * 4 + x];
+    sum += o;
+    twist0 /= 3;
+  }
+  unsigned int o = (skewb_twist_by_perm[perm] + 3 - sum % 3) % 3;
+  conf[3] = action->by_stab[0][o * 4 + 3];
+
+  for (unsigned int x = 0; x < 6; x++) {
+    conf2[x] = action->by_stab[2][centres[x]];
+  }
+}
@@ -1,5 +1,44 @@
 #ifndef SKEWB_H
 #define SKEWB_H
 
+#include <stdint.h>
+
+struct puzzle_t;
+typedef struct puzzle_t puzzle_t;
+
+struct puzzle_action_t;
+typedef struct puzzle_action_t puzzle_action_t;
+
+struct turn_t;
+typedef struct turn_t turn_t;
+
+/* The symmetry group of the skewb is taken to be A_4, the rotations of
+one of the two tetrahedra formed by the corners of the cube. Orbits 0
+and 1 are the corners of that tetrahedron and of the other one, corner
+i of orbit 1 being opposite to corner i of orbit 0, and orbit 2 is the
+centres.
+
+Turns are around the corners of orbit 0, and move half of the puzzle:
+the corner itself, the 3 corners of orbit 1 next to it and the 3
+adjacent centres. The corners of orbit 0 therefore never leave their
+positions. */
+
+#define SKEWB_NUM_STATES 3149280
+
+void skewb_action_init(puzzle_action_t *action);
+uint8_t *skewb_new(puzzle_action_t *action);
+
+/* Turn the puzzle around corner v of orbit 0 c times, recording the
+   move in turn unless it is null. */
+void skewb_apply(puzzle_action_t *action, uint8_t *conf1, uint8_t *conf,
+                 unsigned int v, int c, turn_t *turn);
+
+void skewb_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action);
+
+/* Index of conf below SKEWB_NUM_STATES, and a configuration with
+   index i. The orientations of the centres are not visible, and are
+   not part of the index. */
+uint32_t skewb_index(puzzle_action_t *action, uint8_t *conf);
+void skewb_conf(puzzle_action_t *action, uint8_t *conf, uint32_t i);
 
 #endif /* SKEWB_H */
@@ -50,14 +50,17 @@ static int in_layer(puzzle_t *puzzle,
   return 0;
 }
 
-turn_t *square1_move(puzzle_t *puzzle, uint8_t *conf1, uint8_t *conf,
-                     unsigned int f, int c)
+/* Apply a move, recording it in turn unless it is null. Return 0 if
+   the move is not possible. */
+static int square1_apply(puzzle_t *puzzle, uint8_t *conf1, uint8_t *conf,
+                         unsigned int f, int c, turn_t *turn)
 {
+  group_table_t *table = puzzle->group->table;
   unsigned int sym;
 
   /* find rotation of the middle piece */
   unsigned int g0 = conf[decomp_global(puzzle->decomp, 2, 0)];
-  if (g0 & 1) g0 = group_mul(puzzle->group, g0, 21);
+  if (g0 & 1) g0 = group_table_mul(table, g0, 21);
 
   if (f == 3) {
     /* position of the middle piece */
@@ -70,7 +73,7 @@ turn_t *square1_move(puzzle_t *puzzle, uint8_t *conf1, uint8_t *conf,
       if (d == 1) return 0;
     }
 
-    sym = group_conj(puzzle->group, 21, 0);
+    sym = group_table_conj(table, 21, 0);
   }
   else if (f < 2) {
     if (f == 1) c = -c;
@@ -81,27 +84,34 @@ turn_t *square1_move(puzzle_t *puzzle, uint8_t *conf1, uint8_t *conf,
     return 0;
   }
 
-  turn_t *turn = malloc(sizeof(turn_t));
-  turn->num_pieces = 0;
-  turn->pieces = malloc(18 * sizeof(unsigned int));
-  turn->g = sym;
+  if (turn) {
+    turn->num_pieces = 0;
+    turn->g = sym;
+  }
 
   for (unsigned int k = 0; k < puzzle->decomp->num_orbits; k++) {
     for (unsigned int i = 0; i < puzzle->decomp->orbit_size[k]; i++) {
       unsigned int x = decomp_global(puzzle->decomp, k, i);
-      unsigned int g = group_mul(puzzle->group, conf[x],
-                                 group_inv(puzzle->group, g0 & ~1));
+      unsigned int g = group_table_mul(table, conf[x],
+                                       group_table_inv(table, g0 & ~1));
       if (in_layer(puzzle, f, k, c, g)) {
-        turn->pieces[turn->num_pieces++] = x;
-        conf1[x] = group_mul(puzzle->group, conf[x], turn->g);
+        if (turn) turn->pieces[turn->num_pieces++] = x;
+        conf1[x] = group_table_mul(table, conf[x], sym);
       }
     }
   }
 
-  printf("conf: ");
-  debug_perm(conf, 18);
-  printf("\n");
+  return 1;
+}
 
+turn_t *square1_move(puzzle_t *puzzle, uint8_t *conf1, uint8_t *conf,
+                     unsigned int f, int c)
+{
+  turn_t *turn = turn_new(puzzle->decomp->num_pieces);
+  if (!square1_apply(puzzle, conf1, conf, f, c, turn)) {
+    turn_del(turn);
+    return 0;
+  }
   return turn;
 }
 
@@ -124,7 +134,7 @@ across a horizontal axis. There are two orbits: top/bottom and centre.
 unsigned int dihedral_group_mul(void *data_, unsigned int x, unsigned int y)
 {
   unsigned int *data = data_;
-  unsigned int n = *data;
+  int n = *data;
 
   int i = x >> 1;
   unsigned int s = x & 1;
@@ -154,10 +164,12 @@ void square1_action_init(puzzle_action_t *action)
     dihedral.data = data;
     dihedral.mul = dihedral_group_mul;
     dihedral.inv_mul = 0;
+    dihedral.table = 0;
   }
 
   group_t *group = malloc(sizeof(group_t));
   group_memo(group, &dihedral);
+  group_cleanup(&dihedral);
 
   unsigned int num_orbits = 2;
   unsigned int orbit_size[] = { 24, 12 };
@@ -193,10 +205,10 @@ void square1_action_init(puzzle_action_t *action)
   }
 }
 
-void square1_perm(uint8_t *perm_inv)
+void square1_perm(uint8_t *perm_inv, rng_t *rng)
 {
   perm_id(perm_inv, 16);
-  shuffle(perm_inv, 16);
+  perm_shuffle(perm_inv, 16, rng);
 
   /* make sure that the two layers are complete and divisible in half */
   unsigned int count = 0;
@@ -225,13 +237,13 @@ void square1_perm(uint8_t *perm_inv)
   }
 }
 
-void square1_scramble(puzzle_t *puzzle, uint8_t *conf)
+void square1_scramble(puzzle_t *puzzle, uint8_t *conf, rng_t *rng)
 {
   uint8_t perm_inv[16];
-  square1_perm(perm_inv);
+  square1_perm(perm_inv, rng);
 
   unsigned int count = 0;
-  unsigned int offset = rand() % 2;
+  unsigned int offset = rng_uniform(rng, 2);
   unsigned int l = 0;
   for (unsigned int i = 0; i < 16; i++) {
     unsigned int j = perm_inv[i];
@@ -246,13 +258,13 @@ void square1_scramble(puzzle_t *puzzle, uint8_t *conf)
     count += k ? 1 : 2;
 
     if (count >= 12) {
-      offset = rand() % 2;
+      offset = rng_uniform(rng, 2);
       count = 0;
       l++;
     }
   }
 
-  unsigned int x = rand() % 8;
+  unsigned int x = rng_uniform(rng, 8);
   unsigned int flip0 = x & 1;
   unsigned int flip1 = (x >> 1) & 1;
   unsigned int pos0 = flip0 ? 21 : 0;
@@ -260,14 +272,11 @@ void square1_scramble(puzzle_t *puzzle, uint8_t *conf)
 
   conf[decomp_global(puzzle->decomp, 2, 0)] = (x >> 2) ? pos0 : pos1;
   conf[decomp_global(puzzle->decomp, 2, 1)] = (x >> 2) ? pos1 : pos0;
-
-  printf("scramble conf: ");
-  debug_perm(conf, 18);
-  printf("\n");
 }
 
 void square1_puzzle_cleanup(void *data, puzzle_t *puzzle)
 {
+  decomp_cleanup(puzzle->decomp);
   free(puzzle->decomp);
 }
 
@@ -278,11 +287,17 @@ turn_t *square1_puzzle_move(void *data, uint8_t *conf,
   return square1_move_(puzzle, conf, i, c);
 }
 
-void square1_puzzle_scramble(void *data, uint8_t *conf)
+int square1_puzzle_apply(void *data, uint8_t *conf,
+                         unsigned int i, unsigned int l, int c, turn_t *turn)
+{
+  puzzle_t *puzzle = data;
+  return square1_apply(puzzle, conf, conf, i, c, turn);
+}
+
+void square1_puzzle_scramble(void *data, uint8_t *conf, rng_t *rng)
 {
-  printf("scrambling\n");
   puzzle_t *puzzle = data;
-  square1_scramble(puzzle, conf);
+  square1_scramble(puzzle, conf, rng);
 }
 
 void square1_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action)
@@ -297,6 +312,7 @@ void square1_puzzle_init(puzzle_t *puzzle, puzzle_action_t *action)
 
   puzzle->move = square1_puzzle_move;
   puzzle->move_data = puzzle;
+  puzzle->apply = square1_puzzle_apply;
 
   puzzle->scramble = square1_puzzle_scramble;
   puzzle->scramble_data = puzzle;
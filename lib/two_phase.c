@@ -0,0 +1,666 @@
+#include "two_phase.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "abs_poly.h"
+#include "conf.h"
+#include "conf_sym.h"
+#include "cubies.h"
+#include "group.h"
+#include "notation.h"
+#include "perm.h"
+#include "puzzle.h"
+#include "utils.h"
+
+#define TWO_PHASE_MAGIC 0x53485032 /* "2PHS" */
+#define TWO_PHASE_VERSION 3
+
+static unsigned int binomial(unsigned int n, unsigned int k)
+{
+  if (k > n) return 0;
+  unsigned int r = 1;
+  for (unsigned int i = 0; i < k; i++) {
+    r = r * (n - i) / (i + 1);
+  }
+  return r;
+}
+
+/* colexicographic rank of a set of positions among those of the same
+   size */
+static unsigned int subset_rank(unsigned int mask, unsigned int n)
+{
+  unsigned int rank = 0;
+  unsigned int k = 0;
+  for (unsigned int p = 0; p < n; p++) {
+    if ((mask >> p) & 1) rank += binomial(p, ++k);
+  }
+  return rank;
+}
+
+static unsigned int subset_unrank(unsigned int rank, unsigned int n,
+                                  unsigned int k)
+{
+  unsigned int mask = 0;
+  unsigned int p = n;
+  for (; k > 0; k--) {
+    do p--; while (binomial(p, k) > rank);
+    rank -= binomial(p, k);
+    mask |= 1 << p;
+  }
+  return mask;
+}
+
+/* rank of the set of positions of the middle layer edges */
+static unsigned int slice_get(cubies_t *cubies, uint8_t *c)
+{
+  unsigned int mask = 0;
+  for (unsigned int x = 0; x < 12; x++) {
+    if ((cubies->slice_edges >> x) & 1) {
+      mask |= 1 << cubies->edge_pos[c[8 + x]];
+    }
+  }
+  return subset_rank(mask, 12);
+}
+
+static void slice_set(cubies_t *cubies, uint8_t *c, unsigned int slice)
+{
+  unsigned int mask = subset_unrank(slice, 12, 4);
+
+  /* middle layer edges go to the positions in mask, the others to the
+     remaining positions, in order */
+  cubies_solved(cubies, c);
+  unsigned int next[2] = { 0, 0 };
+  for (unsigned int x = 0; x < 12; x++) {
+    unsigned int s = (cubies->slice_edges >> x) & 1;
+    while (((mask >> next[s]) & 1) != s) next[s]++;
+    c[8 + x] = cubies->edge_sym[(x * 12 + next[s]) * 2];
+    next[s]++;
+  }
+}
+
+/* Permutation of the edges of one kind, i.e. the middle layer ones if
+   slice is 1, and the others otherwise, which must be in positions of
+   the same kind. */
+static unsigned int edge_perm_get(cubies_t *cubies, uint8_t *c,
+                                  unsigned int slice)
+{
+  uint8_t perm[8];
+  unsigned int n = 0;
+  for (unsigned int x = 0; x < 12; x++) {
+    if (((cubies->slice_edges >> x) & 1) != slice) continue;
+    unsigned int p = cubies->edge_pos[c[8 + x]];
+    perm[n++] = cubies->edge_rank[p];
+  }
+  return perm_index(perm, n, n);
+}
+
+static void edge_perm_set(cubies_t *cubies, uint8_t *c,
+                          unsigned int slice, unsigned int index)
+{
+  uint8_t perm[8];
+  uint8_t pos[8];
+  unsigned int n = 0;
+  for (unsigned int p = 0; p < 12; p++) {
+    if (((cubies->slice_edges >> p) & 1) == slice) pos[n++] = p;
+  }
+
+  cubies_solved(cubies, c);
+  perm_from_index(perm, n, index, n);
+  for (unsigned int x = 0; x < 12; x++) {
+    if (((cubies->slice_edges >> x) & 1) != slice) continue;
+    unsigned int p = pos[perm[cubies->edge_rank[x]]];
+    c[8 + x] = cubies->edge_sym[(x * 12 + p) * 2];
+  }
+}
+
+static unsigned int eperm_get(cubies_t *cubies, uint8_t *c)
+{
+  return edge_perm_get(cubies, c, 0);
+}
+
+static void eperm_set(cubies_t *cubies, uint8_t *c, unsigned int eperm)
+{
+  edge_perm_set(cubies, c, 0, eperm);
+}
+
+static unsigned int sperm_get(cubies_t *cubies, uint8_t *c)
+{
+  return edge_perm_get(cubies, c, 1);
+}
+
+static void sperm_set(cubies_t *cubies, uint8_t *c, unsigned int sperm)
+{
+  edge_perm_set(cubies, c, 1, sperm);
+}
+
+static unsigned int flipslice_get(cubies_t *cubies, uint8_t *c)
+{
+  return slice_get(cubies, c) * TWO_PHASE_NUM_FLIPS + cubies_flip(cubies, c);
+}
+
+/* The orientation of the edge at position p is bit 10 - p of flip, and
+   the last one gives an even sum. */
+static void flipslice_set(cubies_t *cubies, uint8_t *c,
+                          unsigned int flipslice)
+{
+  unsigned int flip = flipslice % TWO_PHASE_NUM_FLIPS;
+  slice_set(cubies, c, flipslice / TWO_PHASE_NUM_FLIPS);
+  for (unsigned int x = 0; x < 12; x++) {
+    unsigned int p = cubies->edge_pos[c[8 + x]];
+    unsigned int o = p < 11 ? (flip >> (10 - p)) & 1 :
+      __builtin_popcount(flip) & 1;
+    c[8 + x] = cubies->edge_sym[(x * 12 + p) * 2 + o];
+  }
+}
+
+/* Table of a coordinate of size values conjugated by every symmetry,
+   at index value * TWO_PHASE_NUM_SYMS + s. */
+static uint16_t *conj_table_new(two_phase_t *solver, conf_syms_t *syms,
+                                unsigned int size, cubies_get_t get,
+                                cubies_set_t set)
+{
+  cubies_t *cubies = &solver->cubies;
+  uint16_t *table = malloc(size * TWO_PHASE_NUM_SYMS * sizeof(uint16_t));
+  uint8_t c[CUBIES_NUM], c1[CUBIES_NUM];
+  for (unsigned int i = 0; i < size; i++) {
+    set(cubies, c, i);
+    for (unsigned int s = 0; s < TWO_PHASE_NUM_SYMS; s++) {
+      cubies_conj(cubies, syms, c1, c, solver->syms[s]);
+      table[i * TWO_PHASE_NUM_SYMS + s] = get(cubies, c1);
+    }
+  }
+  return table;
+}
+
+/* Split the size values of a coordinate into classes of conjugate
+   values, the representative of a class being its smallest value. Set
+   class, rep and stab as described in two_phase_t, and return the
+   number of classes. Symmetry inv[s] undoes symmetry s. */
+static unsigned int classes_new(two_phase_t *solver, conf_syms_t *syms,
+                                const uint8_t *inv, unsigned int size,
+                                cubies_get_t get, cubies_set_t set,
+                                uint32_t **class, uint32_t **rep,
+                                uint16_t **stab)
+{
+  cubies_t *cubies = &solver->cubies;
+
+  *class = malloc(size * sizeof(uint32_t));
+  *rep = malloc(size * sizeof(uint32_t));
+  *stab = malloc(size * sizeof(uint16_t));
+  memset(*class, 0xff, size * sizeof(uint32_t));
+  unsigned int n = 0;
+  uint8_t c[CUBIES_NUM], c1[CUBIES_NUM];
+  for (unsigned int i = 0; i < size; i++) {
+    if ((*class)[i] != UINT32_MAX) continue;
+    set(cubies, c, i);
+    (*stab)[n] = 0;
+    for (unsigned int s = 0; s < TWO_PHASE_NUM_SYMS; s++) {
+      cubies_conj(cubies, syms, c1, c, solver->syms[s]);
+      unsigned int j = get(cubies, c1);
+      if (j == i) (*stab)[n] |= 1 << s;
+      if ((*class)[j] == UINT32_MAX) {
+        (*class)[j] = n * TWO_PHASE_NUM_SYMS + inv[s];
+      }
+    }
+    (*rep)[n++] = i;
+  }
+
+  *rep = realloc(*rep, n * sizeof(uint32_t));
+  *stab = realloc(*stab, n * sizeof(uint16_t));
+  return n;
+}
+
+/* Distances from the solved configuration in the product of two
+   coordinates, the first one being the most significant, by a
+   breadth-first search. */
+static uint8_t *prune_table_new(unsigned int size1, uint16_t *move1,
+                                unsigned int size2, uint16_t *move2,
+                                unsigned int num_moves, unsigned int goal)
+{
+  unsigned int size = size1 * size2;
+  uint8_t *table = malloc(size);
+  uint32_t *queue = malloc(size * sizeof(uint32_t));
+  memset(table, 0xff, size);
+
+  unsigned int head = 0, tail = 0;
+  table[goal] = 0;
+  queue[tail++] = goal;
+  while (head < tail) {
+    uint32_t i = queue[head++];
+    unsigned int a = i / size2;
+    unsigned int b = i % size2;
+    for (unsigned int m = 0; m < num_moves; m++) {
+      uint32_t j = move1[a * num_moves + m] * size2 +
+        move2[b * num_moves + m];
+      if (table[j] != 0xff) continue;
+      table[j] = table[i] + 1;
+      queue[tail++] = j;
+    }
+  }
+  assert(tail == size);
+
+  free(queue);
+  return table;
+}
+
+/* distance of a neighbour of a configuration at distance d, from its
+   distance modulo 3 */
+static inline unsigned int next_distance(unsigned int d, unsigned int v)
+{
+  return v == (d + 1) % 3 ? d + 1 : v == d % 3 ? d : d - 1;
+}
+
+static inline uint64_t phase1_index(two_phase_t *solver, unsigned int twist,
+                                    unsigned int flip, unsigned int slice)
+{
+  uint32_t c = solver->flipslice_class[slice * TWO_PHASE_NUM_FLIPS + flip];
+  return (uint64_t) (c / TWO_PHASE_NUM_SYMS) * TWO_PHASE_NUM_TWISTS +
+    solver->twist_conj[twist * TWO_PHASE_NUM_SYMS + c % TWO_PHASE_NUM_SYMS];
+}
+
+static inline uint64_t phase2_index(two_phase_t *solver, unsigned int cperm,
+                                    unsigned int eperm)
+{
+  uint32_t c = solver->cperm_class[cperm];
+  return (uint64_t) (c / TWO_PHASE_NUM_SYMS) * TWO_PHASE_NUM_EPERMS +
+    solver->eperm_conj[eperm * TWO_PHASE_NUM_SYMS + c % TWO_PHASE_NUM_SYMS];
+}
+
+/* Set next to the indices of the neighbours of the configuration of
+   index i in a pruning table, which is that of the representative of
+   its class. */
+static void phase1_expand(void *data, uint64_t i, uint64_t *next)
+{
+  two_phase_t *solver = data;
+  unsigned int flipslice = solver->flipslice_rep[i / TWO_PHASE_NUM_TWISTS];
+  uint16_t *twist = &solver->twist_move
+    [(i % TWO_PHASE_NUM_TWISTS) * TWO_PHASE_NUM_MOVES];
+  uint16_t *flip = &solver->flip_move
+    [(flipslice % TWO_PHASE_NUM_FLIPS) * TWO_PHASE_NUM_MOVES];
+  uint16_t *slice = &solver->slice_move
+    [(flipslice / TWO_PHASE_NUM_FLIPS) * TWO_PHASE_NUM_MOVES];
+  for (unsigned int m = 0; m < TWO_PHASE_NUM_MOVES; m++) {
+    next[m] = phase1_index(solver, twist[m], flip[m], slice[m]);
+  }
+}
+
+static void phase2_expand(void *data, uint64_t i, uint64_t *next)
+{
+  two_phase_t *solver = data;
+  uint16_t *cperm = &solver->cperm_move
+    [solver->cperm_rep[i / TWO_PHASE_NUM_EPERMS] * TWO_PHASE_NUM_MOVES2];
+  uint16_t *eperm = &solver->eperm_move
+    [(i % TWO_PHASE_NUM_EPERMS) * TWO_PHASE_NUM_MOVES2];
+  for (unsigned int k = 0; k < TWO_PHASE_NUM_MOVES2; k++) {
+    next[k] = phase2_index(solver, cperm[k], eperm[k]);
+  }
+}
+
+void two_phase_init(two_phase_t *solver, puzzle_action_t *action,
+                    cube_shape_t *shape)
+{
+  cubies_t *cubies = &solver->cubies;
+  cubies_init(cubies, action, shape);
+
+  uint8_t moves[TWO_PHASE_NUM_MOVES];
+  for (unsigned int m = 0; m < TWO_PHASE_NUM_MOVES; m++) moves[m] = m;
+
+  /* all turns of faces 2 and 3, and half turns of the others */
+  unsigned int num_moves2 = 0;
+  for (unsigned int m = 0; m < TWO_PHASE_NUM_MOVES; m++) {
+    unsigned int f = m / 3;
+    if (f / 2 == 1 || m % 3 == 1) solver->moves2[num_moves2++] = m;
+  }
+  assert(num_moves2 == TWO_PHASE_NUM_MOVES2);
+
+  /* symmetries of the cube, reflections included, taking face 2 to
+     face 2 or 3, and their inverses */
+  abs_poly_t poly;
+  abs_cube(&poly);
+  poly_data_t poly_data;
+  poly_data_init(&poly_data, &poly);
+  symmetries_t poly_syms;
+  symmetries_init(&poly_syms, &poly, &poly_data);
+  conf_space_t space;
+  cube_conf_space_init(&space, action, shape);
+  conf_syms_t syms;
+  int ok = conf_syms_init(&syms, &space, &poly_syms, 2, 0);
+  assert(ok);
+  (void) ok;
+
+  unsigned int num_syms = 0;
+  for (unsigned int s = 0; s < syms.num; s++) {
+    if (poly_syms.face_action[s * poly_syms.num_faces + 2] / 2 == 1) {
+      solver->syms[num_syms++] = s;
+    }
+  }
+  assert(num_syms == TWO_PHASE_NUM_SYMS);
+  uint8_t inv[TWO_PHASE_NUM_SYMS];
+  for (unsigned int s = 0; s < TWO_PHASE_NUM_SYMS; s++) {
+    unsigned int t = poly_syms.inv_mul[solver->syms[s]];
+    for (inv[s] = 0; solver->syms[inv[s]] != t; inv[s]++);
+  }
+
+  solver->twist_move =
+    cubies_move_table_new(cubies, TWO_PHASE_NUM_TWISTS, moves,
+                          TWO_PHASE_NUM_MOVES, cubies_twist,
+                          cubies_set_twist);
+  solver->flip_move =
+    cubies_move_table_new(cubies, TWO_PHASE_NUM_FLIPS, moves,
+                          TWO_PHASE_NUM_MOVES, cubies_flip, cubies_set_flip);
+  solver->slice_move =
+    cubies_move_table_new(cubies, TWO_PHASE_NUM_SLICES, moves,
+                          TWO_PHASE_NUM_MOVES, slice_get, slice_set);
+  solver->cperm_move =
+    cubies_move_table_new(cubies, TWO_PHASE_NUM_CPERMS, solver->moves2,
+                          TWO_PHASE_NUM_MOVES2, cubies_cperm,
+                          cubies_set_cperm);
+  solver->eperm_move =
+    cubies_move_table_new(cubies, TWO_PHASE_NUM_EPERMS, solver->moves2,
+                          TWO_PHASE_NUM_MOVES2, eperm_get, eperm_set);
+  solver->sperm_move =
+    cubies_move_table_new(cubies, TWO_PHASE_NUM_SPERMS, solver->moves2,
+                          TWO_PHASE_NUM_MOVES2, sperm_get, sperm_set);
+
+  solver->twist_conj =
+    conj_table_new(solver, &syms, TWO_PHASE_NUM_TWISTS, cubies_twist,
+                   cubies_set_twist);
+  solver->eperm_conj =
+    conj_table_new(solver, &syms, TWO_PHASE_NUM_EPERMS, eperm_get,
+                   eperm_set);
+  solver->num_flipslice_classes =
+    classes_new(solver, &syms, inv, TWO_PHASE_NUM_FLIPSLICES,
+                flipslice_get, flipslice_set, &solver->flipslice_class,
+                &solver->flipslice_rep, &solver->flipslice_stab);
+  solver->num_cperm_classes =
+    classes_new(solver, &syms, inv, TWO_PHASE_NUM_CPERMS, cubies_cperm,
+                cubies_set_cperm, &solver->cperm_class, &solver->cperm_rep,
+                &solver->cperm_stab);
+
+  conf_syms_cleanup(&syms);
+  conf_space_cleanup(&space);
+  symmetries_cleanup(&poly_syms);
+  poly_data_cleanup(&poly_data);
+  abs_poly_cleanup(&poly);
+
+  uint8_t c[CUBIES_NUM];
+  cubies_solved(cubies, c);
+  solver->solved_slice = slice_get(cubies, c);
+
+  dist_table_init(&solver->phase1_prune, (uint64_t)
+                  solver->num_flipslice_classes * TWO_PHASE_NUM_TWISTS, 2);
+  dist_table_init(&solver->phase2_prune, (uint64_t)
+                  solver->num_cperm_classes * TWO_PHASE_NUM_EPERMS, 2);
+  solver->sperm_cperm_prune =
+    prune_table_new(TWO_PHASE_NUM_SPERMS, solver->sperm_move,
+                    TWO_PHASE_NUM_CPERMS, solver->cperm_move,
+                    TWO_PHASE_NUM_MOVES2, 0);
+}
+
+void two_phase_cleanup(two_phase_t *solver)
+{
+  free(solver->twist_move);
+  free(solver->flip_move);
+  free(solver->slice_move);
+  free(solver->cperm_move);
+  free(solver->eperm_move);
+  free(solver->sperm_move);
+  free(solver->twist_conj);
+  free(solver->eperm_conj);
+  free(solver->flipslice_class);
+  free(solver->flipslice_rep);
+  free(solver->flipslice_stab);
+  free(solver->cperm_class);
+  free(solver->cperm_rep);
+  free(solver->cperm_stab);
+  dist_table_cleanup(&solver->phase1_prune);
+  dist_table_cleanup(&solver->phase2_prune);
+  free(solver->sperm_cperm_prune);
+}
+
+/* The entries of a class whose representative is fixed by some
+   symmetries include configurations conjugate by them, which are not
+   necessarily reached at the same level from the neighbours of the
+   representatives, so they are claimed together when building the
+   pruning tables. They are given by stab and by the conjugation table
+   conj of the other coordinate, of size values. */
+static unsigned int conj_equiv(uint16_t *stab, uint16_t *conj,
+                               unsigned int size, uint64_t i,
+                               uint64_t *equiv)
+{
+  uint64_t c = i / size;
+  unsigned int x = i % size;
+  unsigned int n = 0;
+  for (unsigned int s = 1; s < TWO_PHASE_NUM_SYMS; s++) {
+    if (!((stab[c] >> s) & 1)) continue;
+    equiv[n++] = c * size + conj[x * TWO_PHASE_NUM_SYMS + s];
+  }
+  return n;
+}
+
+static unsigned int phase1_equiv(void *data, uint64_t i, uint64_t *equiv)
+{
+  two_phase_t *solver = data;
+  return conj_equiv(solver->flipslice_stab, solver->twist_conj,
+                    TWO_PHASE_NUM_TWISTS, i, equiv);
+}
+
+static unsigned int phase2_equiv(void *data, uint64_t i, uint64_t *equiv)
+{
+  two_phase_t *solver = data;
+  return conj_equiv(solver->cperm_stab, solver->eperm_conj,
+                    TWO_PHASE_NUM_EPERMS, i, equiv);
+}
+
+void two_phase_build(two_phase_t *solver, unsigned int num_threads)
+{
+  dist_table_build(&solver->phase1_prune,
+                   phase1_index(solver, 0, 0, solver->solved_slice),
+                   TWO_PHASE_NUM_MOVES, phase1_expand, phase1_equiv, solver,
+                   num_threads);
+  dist_table_build(&solver->phase2_prune, phase2_index(solver, 0, 0),
+                   TWO_PHASE_NUM_MOVES2, phase2_expand, phase2_equiv, solver,
+                   num_threads);
+}
+
+/* The file starts with little endian 32-bit words: magic, version,
+   number of flipslice classes and of cperm classes, followed by the
+   pruning tables as saved by dist_table_save. */
+#define TWO_PHASE_PREFIX_SIZE 16
+
+static void two_phase_prefix(two_phase_t *solver, uint8_t *prefix)
+{
+  put_u32(&prefix[0], TWO_PHASE_MAGIC);
+  put_u32(&prefix[4], TWO_PHASE_VERSION);
+  put_u32(&prefix[8], solver->num_flipslice_classes);
+  put_u32(&prefix[12], solver->num_cperm_classes);
+}
+
+int two_phase_save(two_phase_t *solver, const char *path)
+{
+  dist_table_t *tables[2] = {
+    &solver->phase1_prune, &solver->phase2_prune
+  };
+  uint8_t prefix[TWO_PHASE_PREFIX_SIZE];
+  two_phase_prefix(solver, prefix);
+  return dist_table_save(tables, 2, path, prefix, TWO_PHASE_PREFIX_SIZE);
+}
+
+int two_phase_load(two_phase_t *solver, const char *path)
+{
+  dist_table_t *tables[2] = {
+    &solver->phase1_prune, &solver->phase2_prune
+  };
+  uint8_t prefix[TWO_PHASE_PREFIX_SIZE];
+  two_phase_prefix(solver, prefix);
+  return dist_table_load(tables, 2, path, prefix, TWO_PHASE_PREFIX_SIZE);
+}
+
+/* Distance of the configuration of index i in a pruning table, found
+   by following the table to the solved configuration. */
+static unsigned int table_distance(two_phase_t *solver, dist_table_t *table,
+                                   dist_table_expand_t expand,
+                                   unsigned int num_moves,
+                                   uint64_t i, uint64_t solved)
+{
+  uint64_t next[TWO_PHASE_NUM_MOVES];
+  unsigned int n = 0;
+  while (i != solved) {
+    unsigned int v = dist_table_get(table, i);
+    assert(v != 3);
+
+    unsigned int m;
+    expand(solver, i, next);
+    for (m = 0; m < num_moves; m++) {
+      if (dist_table_get(table, next[m]) == (v + 2) % 3) break;
+    }
+    assert(m < num_moves);
+
+    i = next[m];
+    n++;
+  }
+  return n;
+}
+
+struct two_phase_search_t
+{
+  two_phase_t *solver;
+  uint8_t c[CUBIES_NUM];
+  unsigned int max_length;
+
+  unsigned int length;
+  uint8_t moves[TWO_PHASE_MAX_DEPTH1 + TWO_PHASE_MAX_DEPTH2];
+};
+
+static int move_allowed(struct two_phase_search_t *search, unsigned int n,
+                        unsigned int m)
+{
+  return n == 0 || cubies_move_allowed(search->moves[n - 1], m);
+}
+
+/* dist is the distance of cperm and eperm in phase2_prune */
+static int phase2(struct two_phase_search_t *search,
+                  unsigned int cperm, unsigned int eperm, unsigned int sperm,
+                  unsigned int dist, unsigned int depth, unsigned int n)
+{
+  two_phase_t *solver = search->solver;
+  if (dist > depth ||
+      solver->sperm_cperm_prune[sperm * TWO_PHASE_NUM_CPERMS + cperm] > depth)
+    return 0;
+  if (depth == 0) {
+    search->length = n;
+    return 1;
+  }
+
+  for (unsigned int k = 0; k < TWO_PHASE_NUM_MOVES2; k++) {
+    unsigned int m = solver->moves2[k];
+    if (!move_allowed(search, n, m)) continue;
+    unsigned int cperm1 = solver->cperm_move[cperm * TWO_PHASE_NUM_MOVES2 + k];
+    unsigned int eperm1 = solver->eperm_move[eperm * TWO_PHASE_NUM_MOVES2 + k];
+    unsigned int dist1 =
+      next_distance(dist, dist_table_get(&solver->phase2_prune,
+                                    phase2_index(solver, cperm1, eperm1)));
+    search->moves[n] = m;
+    if (phase2(search, cperm1, eperm1,
+               solver->sperm_move[sperm * TWO_PHASE_NUM_MOVES2 + k],
+               dist1, depth - 1, n + 1)) return 1;
+  }
+
+  return 0;
+}
+
+static int phase2_start(struct two_phase_search_t *search, unsigned int n)
+{
+  two_phase_t *solver = search->solver;
+  cubies_t *cubies = &solver->cubies;
+  uint8_t c[CUBIES_NUM];
+  memcpy(c, search->c, CUBIES_NUM);
+  for (unsigned int i = 0; i < n; i++) {
+    cubies_move(cubies, c, search->moves[i]);
+  }
+
+  unsigned int cperm = cubies_cperm(cubies, c);
+  unsigned int eperm = eperm_get(cubies, c);
+  unsigned int sperm = sperm_get(cubies, c);
+  unsigned int dist =
+    table_distance(solver, &solver->phase2_prune, phase2_expand,
+                   TWO_PHASE_NUM_MOVES2, phase2_index(solver, cperm, eperm),
+                   phase2_index(solver, 0, 0));
+
+  unsigned int max_depth = search->max_length - n;
+  if (max_depth > TWO_PHASE_MAX_DEPTH2) max_depth = TWO_PHASE_MAX_DEPTH2;
+  for (unsigned int depth = dist; depth <= max_depth; depth++) {
+    if (phase2(search, cperm, eperm, sperm, dist, depth, n)) return 1;
+  }
+
+  return 0;
+}
+
+/* dist is the distance of twist, flip and slice in phase1_prune */
+static int phase1(struct two_phase_search_t *search,
+                  unsigned int twist, unsigned int flip, unsigned int slice,
+                  unsigned int dist, unsigned int depth, unsigned int n)
+{
+  two_phase_t *solver = search->solver;
+  if (dist > depth) return 0;
+
+  if (depth == 0) {
+    /* a solution ending with a move of the second phase would have
+       been found at a smaller depth */
+    if (n > 0) {
+      unsigned int last = search->moves[n - 1];
+      if (last / 6 == 1 || last % 3 == 1) return 0;
+    }
+    return phase2_start(search, n);
+  }
+
+  for (unsigned int m = 0; m < TWO_PHASE_NUM_MOVES; m++) {
+    if (!move_allowed(search, n, m)) continue;
+    unsigned int twist1 = solver->twist_move[twist * TWO_PHASE_NUM_MOVES + m];
+    unsigned int flip1 = solver->flip_move[flip * TWO_PHASE_NUM_MOVES + m];
+    unsigned int slice1 = solver->slice_move[slice * TWO_PHASE_NUM_MOVES + m];
+    unsigned int dist1 =
+      next_distance(dist, dist_table_get(&solver->phase1_prune,
+                                    phase1_index(solver, twist1, flip1,
+                                                 slice1)));
+    search->moves[n] = m;
+    if (phase1(search, twist1, flip1, slice1, dist1, depth - 1, n + 1))
+      return 1;
+  }
+
+  return 0;
+}
+
+int two_phase_solve(two_phase_t *solver, move_seq_t *seq, uint8_t *conf,
+                    unsigned int max_length)
+{
+  cubies_t *cubies = &solver->cubies;
+  struct two_phase_search_t search;
+  search.solver = solver;
+  search.max_length = max_length;
+
+  int h = cubies_from_conf(cubies, search.c, conf);
+  if (h < 0) return -1;
+
+  unsigned int twist = cubies_twist(cubies, search.c);
+  unsigned int flip = cubies_flip(cubies, search.c);
+  unsigned int slice = slice_get(cubies, search.c);
+  uint64_t i = phase1_index(solver, twist, flip, slice);
+  unsigned int dist =
+    table_distance(solver, &solver->phase1_prune, phase1_expand,
+                   TWO_PHASE_NUM_MOVES, i,
+                   phase1_index(solver, 0, 0, solver->solved_slice));
+
+  int found = 0;
+  for (unsigned int depth = dist;
+       depth <= TWO_PHASE_MAX_DEPTH1 && depth <= max_length && !found;
+       depth++) {
+    found = phase1(&search, twist, flip, slice, dist, depth, 0);
+  }
+  if (!found) return -1;
+
+  cubies_push_moves(cubies, seq, search.moves, search.length, h);
+  return search.length;
+}
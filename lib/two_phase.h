@@ -0,0 +1,135 @@
+#ifndef TWO_PHASE_H
+#define TWO_PHASE_H
+
+#include <stdint.h>
+
+#include "cubies.h"
+#include "dist_table.h"
+
+struct move_seq_t;
+typedef struct move_seq_t move_seq_t;
+
+/* Two-phase solver for the 3x3x3 cube.
+
+The first phase brings the cube into the subgroup H generated by the
+turns of faces 2 and 3, and half turns of the other faces, which is
+the case when all corners and edges are oriented with respect to the
+axis of faces 2 and 3, and the 4 edges of the middle layer orthogonal
+to that axis are in that layer. The second phase solves the cube
+within H.
+
+Each phase is an iterative deepening search on coordinates of the
+configuration:
+
+ - phase 1: orientation of the corners (twist), orientation of the
+   edges (flip), and positions of the middle layer edges (slice);
+ - phase 2: permutations of the corners (cperm), of the 8 other edges
+   (eperm) and of the middle layer edges (sperm).
+
+The coordinates are updated by move tables. Both phases and the
+subgroup H are preserved by the 16 symmetries of the cube, 8 rotations
+and 8 reflections, which preserve the axis of faces 2 and 3, so
+conjugating a configuration by one of them does not change its
+distances. The pairs of flip and slice, called flipslice, and the
+corner permutations are split into classes of conjugate values, and
+the distances are stored in pruning tables on the product of the
+classes with the twist in phase 1, and
+with the eperm in phase 2, conjugated by the symmetry bringing the
+other coordinate to the representative of its class. Phase 2 is also
+pruned by a table on the product of sperm and cperm.
+
+The symmetry-reduced tables store distances modulo 3 in 2 bits, the
+distance of a neighbour differing by at most 1. They are empty until
+two_phase_build or two_phase_load is called. Moves and orientations
+are those of cubies.h. */
+
+#define TWO_PHASE_NUM_MOVES 18
+#define TWO_PHASE_NUM_MOVES2 10
+
+#define TWO_PHASE_NUM_TWISTS 2187
+#define TWO_PHASE_NUM_FLIPS 2048
+#define TWO_PHASE_NUM_SLICES 495
+#define TWO_PHASE_NUM_CPERMS 40320
+#define TWO_PHASE_NUM_EPERMS 40320
+#define TWO_PHASE_NUM_SPERMS 24
+#define TWO_PHASE_NUM_FLIPSLICES (TWO_PHASE_NUM_SLICES * TWO_PHASE_NUM_FLIPS)
+#define TWO_PHASE_NUM_SYMS 16
+
+/* maximum length of the solution of a phase */
+#define TWO_PHASE_MAX_DEPTH1 12
+#define TWO_PHASE_MAX_DEPTH2 18
+
+struct two_phase_t
+{
+  cubies_t cubies;
+
+  /* moves of the second phase */
+  uint8_t moves2[TWO_PHASE_NUM_MOVES2];
+
+  /* symmetries preserving the axis of faces 2 and 3, as indices of the
+     symmetries of the cube of conf_syms_t, reflections included */
+  uint8_t syms[TWO_PHASE_NUM_SYMS];
+
+  /* move tables, at index coordinate * number of moves + move */
+  uint16_t *twist_move;
+  uint16_t *flip_move;
+  uint16_t *slice_move;
+  uint16_t *cperm_move;
+  uint16_t *eperm_move;
+  uint16_t *sperm_move;
+
+  /* coordinates conjugated by symmetry s, at index coordinate *
+     TWO_PHASE_NUM_SYMS + s */
+  uint16_t *twist_conj;
+  uint16_t *eperm_conj;
+
+  /* For flipslice, which is slice * TWO_PHASE_NUM_FLIPS + flip, and
+     cperm: class * TWO_PHASE_NUM_SYMS + s, where conjugating by
+     symmetry s gives the representative of the class, the
+     representatives of the classes, and the bitsets of the symmetries
+     fixing them. */
+  unsigned int num_flipslice_classes;
+  uint32_t *flipslice_class;
+  uint32_t *flipslice_rep;
+  uint16_t *flipslice_stab;
+  unsigned int num_cperm_classes;
+  uint32_t *cperm_class;
+  uint32_t *cperm_rep;
+  uint16_t *cperm_stab;
+
+  /* slice of the solved configuration */
+  unsigned int solved_slice;
+
+  /* pruning tables, indexed by class, then twist or eperm */
+  dist_table_t phase1_prune;
+  dist_table_t phase2_prune;
+
+  /* distances in phase 2, indexed by sperm, then cperm */
+  uint8_t *sperm_cperm_prune;
+};
+typedef struct two_phase_t two_phase_t;
+
+/* Compute the move and symmetry tables for the 3x3x3 cube of shape.
+   The symmetry-reduced pruning tables are empty until two_phase_build
+   or two_phase_load is called. */
+void two_phase_init(two_phase_t *solver, puzzle_action_t *action,
+                    cube_shape_t *shape);
+void two_phase_cleanup(two_phase_t *solver);
+
+/* Fill the pruning tables using num_threads threads, or one per
+   processor if it is 0. */
+void two_phase_build(two_phase_t *solver, unsigned int num_threads);
+
+/* Save the pruning tables, or load saved ones. Return 0 on error. */
+int two_phase_save(two_phase_t *solver, const char *path);
+int two_phase_load(two_phase_t *solver, const char *path);
+
+/* Append to seq a solution of conf of at most max_length moves,
+   followed by a rotation of the whole cube if its centres are not in
+   place. Return the number of moves, or -1 if conf cannot be solved
+   or there is no such solution. Tables are only read, so several
+   threads can solve at the same time. */
+int two_phase_solve(two_phase_t *solver, move_seq_t *seq, uint8_t *conf,
+                    unsigned int max_length);
+
+#endif /* TWO_PHASE_H */
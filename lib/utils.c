@@ -8,11 +8,35 @@ void perm_flip_parity(uint8_t *x)
   x[1] = tmp;
 }
 
-void parity_shuffle(uint8_t *x, size_t len, uint8_t parity)
+void parity_shuffle(uint8_t *x, size_t len, uint8_t parity, rng_t *rng)
 {
-  shuffle(x, len);
+  perm_shuffle(x, len, rng);
   uint8_t s = perm_sign(x, len);
   if (s ^ parity) {
     perm_flip_parity(x);
   }
 }
+
+void put_u32(uint8_t *buf, uint32_t x)
+{
+  for (unsigned int i = 0; i < 4; i++) buf[i] = x >> (8 * i);
+}
+
+uint32_t get_u32(const uint8_t *buf)
+{
+  uint32_t x = 0;
+  for (unsigned int i = 0; i < 4; i++) x |= (uint32_t) buf[i] << (8 * i);
+  return x;
+}
+
+void put_u64(uint8_t *buf, uint64_t x)
+{
+  for (unsigned int i = 0; i < 8; i++) buf[i] = x >> (8 * i);
+}
+
+uint64_t get_u64(const uint8_t *buf)
+{
+  uint64_t x = 0;
+  for (unsigned int i = 0; i < 8; i++) x |= (uint64_t) buf[i] << (8 * i);
+  return x;
+}
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "rng.h"
+
 static inline uint8_t rotr3(uint8_t x, unsigned int n)
 {
   return ((x >> n) | (x << (3 - n))) & 0x7;
@@ -15,6 +17,13 @@ static inline uint8_t rotl3(uint8_t x, unsigned int n)
 }
 
 void perm_flip_parity(uint8_t *x);
-void parity_shuffle(uint8_t *x, size_t len, uint8_t parity);
+void parity_shuffle(uint8_t *x, size_t len, uint8_t parity, rng_t *rng);
+
+/* little endian encoding of 32-bit and 64-bit words, as used by saved
+   tables */
+void put_u32(uint8_t *buf, uint32_t x);
+uint32_t get_u32(const uint8_t *buf);
+void put_u64(uint8_t *buf, uint64_t x);
+uint64_t get_u64(const uint8_t *buf);
 
 #endif /* UTILS_H */
@@ -0,0 +1,70 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/cube.h"
+#include "lib/puzzle.h"
+#include "lib/rng.h"
+
+/* cube_coords_apply agrees with cube_puzzle_apply on every layer l <
+   n - 1, and turns the opposite face on layer n - 1, where
+   cube_puzzle_apply does nothing. */
+static void test_coords_apply(unsigned int n)
+{
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, n);
+  puzzle_t puzzle;
+  cube_puzzle_init(&puzzle, action, shape);
+
+  unsigned int num_pieces = shape->decomp.num_pieces;
+  rng_t rng;
+  rng_init(&rng, n);
+  uint8_t *conf = cube_new(action, shape);
+  uint8_t *expected = malloc(num_pieces);
+  cube_coords_t coords;
+  cube_coords_init(&coords, action, shape, conf);
+
+  for (unsigned int i = 0; i < 20; i++) {
+    cube_scramble(action, shape, conf, &rng);
+    cube_coords_set(&coords, conf);
+
+    for (unsigned int f = 0; f < 6; f++) {
+      for (unsigned int l = 0; l < n; l++) {
+        for (int c = -1; c <= 1; c += 2) {
+          memcpy(expected, conf, num_pieces);
+          if (l < n - 1) {
+            puzzle.apply(puzzle.move_data, expected, f, l, c, 0);
+          }
+          else {
+            puzzle.apply(puzzle.move_data, expected, f, l, c, 0);
+            CHECK(!memcmp(expected, conf, num_pieces));
+            puzzle.apply(puzzle.move_data, expected, f ^ 1, 0, -c, 0);
+          }
+
+          cube_coords_apply(&coords, conf, f, l, c, 0);
+          CHECK(!memcmp(expected, conf, num_pieces));
+
+          /* the coordinates follow the configuration */
+          cube_coords_apply(&coords, conf, f, l, -c, 0);
+          cube_coords_apply(&coords, conf, f, l, c, 0);
+          CHECK(!memcmp(expected, conf, num_pieces));
+        }
+      }
+    }
+  }
+
+  cube_coords_cleanup(&coords);
+  free(expected);
+  free(conf);
+  puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+}
+
+void test_cube(void)
+{
+  for (unsigned int n = 2; n <= 5; n++) {
+    test_coords_apply(n);
+  }
+}
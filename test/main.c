@@ -0,0 +1,70 @@
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+struct suite_t
+{
+  const char *name;
+  void (*run)(void);
+};
+
+static const struct suite_t suites[] = {
+  { "cube", test_cube },
+  { "pocket", test_pocket },
+};
+
+static const unsigned int num_suites = sizeof(suites) / sizeof(suites[0]);
+
+static unsigned long num_checks;
+static unsigned long num_failures;
+
+void test_check(int ok, const char *expr, const char *file, int line)
+{
+  num_checks++;
+  if (ok) return;
+  num_failures++;
+  fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [SUITE]...\nsuites:", name);
+  for (unsigned int i = 0; i < num_suites; i++) {
+    fprintf(stderr, " %s", suites[i].name);
+  }
+  fprintf(stderr, "\n");
+}
+
+/* Usage: test [SUITE]...
+
+   Run the given suites, or all of them, and exit with a non-zero status
+   if any check fails. */
+int main(int argc, char **argv)
+{
+  for (int j = 1; j < argc; j++) {
+    unsigned int i = 0;
+    while (i < num_suites && strcmp(argv[j], suites[i].name)) i++;
+    if (i == num_suites) {
+      fprintf(stderr, "%s: unknown suite '%s'\n", argv[0], argv[j]);
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  for (unsigned int i = 0; i < num_suites; i++) {
+    int run = argc == 1;
+    for (int j = 1; j < argc; j++) {
+      if (!strcmp(argv[j], suites[i].name)) run = 1;
+    }
+    if (!run) continue;
+
+    unsigned long failures = num_failures;
+    suites[i].run();
+    printf("%-16s %s\n", suites[i].name,
+           num_failures == failures ? "ok" : "FAILED");
+  }
+
+  printf("%lu checks, %lu failures\n", num_checks, num_failures);
+  return num_failures != 0;
+}
@@ -0,0 +1,78 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/cube.h"
+#include "lib/notation.h"
+#include "lib/pocket.h"
+#include "lib/puzzle.h"
+#include "lib/rng.h"
+
+static void test_pocket_metric(int half_turns)
+{
+  puzzle_action_t *action = malloc(sizeof(puzzle_action_t));
+  cube_action_init(action);
+  cube_shape_t *shape = malloc(sizeof(cube_shape_t));
+  cube_shape_init(shape, 2);
+  puzzle_t puzzle;
+  cube_puzzle_init(&puzzle, action, shape);
+
+  pocket_t pocket;
+  pocket_init(&pocket, action, shape, half_turns);
+  pocket_build(&pocket, 0);
+
+  uint8_t *solved = cube_new(action, shape);
+  uint8_t conf[8];
+  move_seq_t seq;
+  move_seq_init(&seq);
+  rng_t rng;
+  rng_init(&rng, half_turns);
+
+  CHECK(pocket_distance(&pocket, solved) == 0);
+
+  /* scrambles are solved optimally */
+  for (unsigned int i = 0; i < 100; i++) {
+    memcpy(conf, solved, 8);
+    puzzle.scramble(puzzle.scramble_data, conf, &rng);
+
+    int d = pocket_distance(&pocket, conf);
+    seq.num = 0;
+    int n = pocket_solve(&pocket, &seq, conf);
+    CHECK(n >= 0 && n == d && n <= (half_turns ? 11 : 14));
+    CHECK(move_seq_apply(&puzzle, conf, &seq) == seq.num);
+    CHECK(!memcmp(conf, solved, 8));
+  }
+
+  /* a single twisted corner, at every position */
+  for (unsigned int x = 0; x < 8; x++) {
+    memcpy(conf, solved, 8);
+    conf[x] = action->by_stab[0][8 + x];
+    seq.num = 0;
+    CHECK(pocket_index(&pocket, conf) == -1);
+    CHECK(pocket_distance(&pocket, conf) == -1);
+    CHECK(pocket_solve(&pocket, &seq, conf) == -1);
+    CHECK(seq.num == 0);
+  }
+
+  /* two corners at the same position */
+  memcpy(conf, solved, 8);
+  conf[(pocket.fixed + 1) % 8] = conf[(pocket.fixed + 2) % 8];
+  CHECK(pocket_index(&pocket, conf) == -1);
+  CHECK(pocket_solve(&pocket, &seq, conf) == -1);
+  memcpy(conf, solved, 8);
+  conf[(pocket.fixed + 1) % 8] = conf[pocket.fixed];
+  CHECK(pocket_index(&pocket, conf) == -1);
+  CHECK(pocket_solve(&pocket, &seq, conf) == -1);
+
+  move_seq_cleanup(&seq);
+  free(solved);
+  pocket_cleanup(&pocket);
+  puzzle.cleanup(puzzle.cleanup_data, &puzzle);
+}
+
+void test_pocket(void)
+{
+  test_pocket_metric(0);
+  test_pocket_metric(1);
+}
@@ -0,0 +1,13 @@
+#ifndef TEST_H
+#define TEST_H
+
+/* Record a failure of the condition cond, with its location, and carry
+   on with the test. */
+#define CHECK(cond) test_check((cond) != 0, #cond, __FILE__, __LINE__)
+
+void test_check(int ok, const char *expr, const char *file, int line);
+
+void test_cube(void);
+void test_pocket(void);
+
+#endif /* TEST_H */